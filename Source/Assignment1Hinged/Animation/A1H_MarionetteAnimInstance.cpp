@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_MarionetteAnimInstance.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Animation/A1H_MarionetteStringComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Anim Snapshot (Game Thread)"), STAT_A1H_AnimSnapshot, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Anim Update (Worker)"), STAT_A1H_AnimThreadSafeUpdate, STATGROUP_A1H);
+
+void UA1H_MarionetteAnimInstance::NativeInitializeAnimation()
+{
+    LLM_SCOPE_BYTAG(A1H_Animation);
+
+    Super::NativeInitializeAnimation();
+
+    Marionette = Cast<AA1H_MarionetteCharacter>(TryGetPawnOwner());
+    bHasPreviousYaw = false;
+}
+
+void UA1H_MarionetteAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+    Super::NativeUpdateAnimation(DeltaSeconds);
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_AnimSnapshot);
+
+    // Game thread: copy, don't compute. The worker update does the rest.
+    if (!Marionette)
+    {
+        return;
+    }
+
+    Snapshot.Velocity = Marionette->GetVelocity();
+    Snapshot.ActorRotation = Marionette->GetActorRotation();
+
+    // Control rotation locally, replicated view pitch on simulated proxies
+    Snapshot.AimRotation = Marionette->GetBaseAimRotation();
+
+    const UCharacterMovementComponent* Movement = Marionette->GetCharacterMovement();
+    Snapshot.bIsFalling = Movement && Movement->IsFalling();
+
+    // String results are already final (the solver ran last frame), so they go straight into the properties
+    const UA1H_MarionetteStringComponent* Strings = Marionette->GetStringComponent();
+    if (Strings && Strings->HasSolvedResults())
+    {
+        StringEffectors = Strings->GetEffectorLocations();
+        StringJointTargets = Strings->GetJointTargetLocations();
+        StringAlpha = 1.0f;
+    }
+    else
+    {
+        StringAlpha = 0.0f;
+    }
+}
+
+void UA1H_MarionetteAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+    Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_AnimThreadSafeUpdate);
+
+    // Locomotion
+    GroundSpeed = Snapshot.Velocity.Size2D();
+    bShouldMove = GroundSpeed > MoveSpeedThreshold;
+    bIsInAir = Snapshot.bIsFalling;
+
+    const float ActorYaw = Snapshot.ActorRotation.Yaw;
+    FacingDelta = bShouldMove ? FRotator::NormalizeAxis(Snapshot.Velocity.Rotation().Yaw - ActorYaw) : 0.0f;
+
+    // Turn rate from how far the facing moved since last update
+    TurnRate = (bHasPreviousYaw && DeltaSeconds > UE_KINDA_SMALL_NUMBER) ? FRotator::NormalizeAxis(ActorYaw - PreviousYaw) / DeltaSeconds : 0.0f;
+    PreviousYaw = ActorYaw;
+    bHasPreviousYaw = true;
+
+    // Aim relative to the body, so a graph can drive an aim offset straight from these
+    const FRotator AimDelta = (Snapshot.AimRotation - Snapshot.ActorRotation).GetNormalized();
+    AimPitch = AimDelta.Pitch;
+    AimYaw = AimDelta.Yaw;
+}
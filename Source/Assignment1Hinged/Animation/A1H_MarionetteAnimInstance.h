@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "A1H_MarionetteAnimInstance.generated.h"
+
+class AA1H_MarionetteCharacter;
+
+/**
+ * Native base for the marionette Anim Blueprint.
+ * The game thread part only copies a handful of values off the character. Everything derived from them
+ * is worked out in NativeThreadSafeUpdateAnimation, which runs on a worker thread alongside the graph.
+ * Reparent the Anim Blueprint to this class, delete its Event Graph and read the Locomotion/Aim values
+ * through property access (thread safe) so the whole anim update stays off the game thread.
+ */
+UCLASS()
+class ASSIGNMENT1HINGED_API UA1H_MarionetteAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void NativeInitializeAnimation() override;
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+#pragma region Locomotion
+	// Horizontal speed, cm/s
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float GroundSpeed = 0.0f;
+
+	// Moving fast enough to leave idle
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	bool bShouldMove = false;
+
+	// Jumping or falling
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	bool bIsInAir = false;
+
+	// Signed angle (degrees) between where the marionette faces and where it's moving. 0 when standing still.
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float FacingDelta = 0.0f;
+
+	// How fast the marionette is turning, degrees per second (positive = turning right). Good for leaning.
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float TurnRate = 0.0f;
+
+	// Below this ground speed the marionette counts as idle
+	UPROPERTY(EditDefaultsOnly, Category = "Locomotion", meta = (ClampMin = "0.0"))
+	float MoveSpeedThreshold = 3.0f;
+
+#pragma endregion
+
+#pragma region Aim
+	// Where the player is looking (LookUp/LookRight) relative to the body, in degrees
+	UPROPERTY(BlueprintReadOnly, Category = "Aim")
+	float AimPitch = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Aim")
+	float AimYaw = 0.0f;
+
+#pragma endregion
+
+#pragma region Strings
+	// Solved string results, one entry per string of the string component, in component space.
+	// Feed them to a Two Bone IK per string (effector + joint target), weighted by StringAlpha.
+	UPROPERTY(BlueprintReadOnly, Category = "Strings")
+	TArray<FVector> StringEffectors;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Strings")
+	TArray<FVector> StringJointTargets;
+
+	// 1 while the strings are being solved, 0 while they're frozen off screen (or there are none)
+	UPROPERTY(BlueprintReadOnly, Category = "Strings")
+	float StringAlpha = 0.0f;
+
+#pragma endregion
+
+private:
+	// Copied off the character on the game thread, read on the worker thread. Never touched anywhere else.
+	struct FSnapshot
+	{
+		FVector Velocity = FVector::ZeroVector;
+		FRotator ActorRotation = FRotator::ZeroRotator;
+		FRotator AimRotation = FRotator::ZeroRotator;
+		bool bIsFalling = false;
+	};
+
+	FSnapshot Snapshot;
+
+	// Last frame's facing, for TurnRate (worker thread only)
+	float PreviousYaw = 0.0f;
+	bool bHasPreviousYaw = false;
+
+	UPROPERTY(Transient)
+	TObjectPtr<AA1H_MarionetteCharacter> Marionette;
+};
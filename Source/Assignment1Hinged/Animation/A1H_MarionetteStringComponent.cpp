@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_MarionetteStringComponent.h"
+#include "Animation/A1H_MarionetteStringSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+
+UA1H_MarionetteStringComponent::UA1H_MarionetteStringComponent()
+{
+    // The subsystem solves everyone in one go, nothing to do per component
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+USkeletalMeshComponent* UA1H_MarionetteStringComponent::GetStringMesh() const
+{
+    if (const ACharacter* Character = Cast<ACharacter>(GetOwner()))
+    {
+        return Character->GetMesh();
+    }
+    return GetOwner() ? GetOwner()->FindComponentByClass<USkeletalMeshComponent>() : nullptr;
+}
+
+void UA1H_MarionetteStringComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (Strings.IsEmpty())
+    {
+        return;
+    }
+
+    if (UA1H_MarionetteStringSubsystem* StringSubsystem = GetWorld()->GetSubsystem<UA1H_MarionetteStringSubsystem>())
+    {
+        StringSubsystem->RegisterStrings(this);
+    }
+}
+
+void UA1H_MarionetteStringComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UA1H_MarionetteStringSubsystem* StringSubsystem = GetWorld()->GetSubsystem<UA1H_MarionetteStringSubsystem>())
+    {
+        StringSubsystem->UnregisterStrings(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "A1H_MarionetteStringComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * One string from the control bar down to a limb.
+ * The string is tied to Bone. Bone's parent is treated as the hinge (elbow/knee) and its grandparent as the
+ * fixed limb root (shoulder/hip), which follows the animated pose.
+ */
+USTRUCT(BlueprintType)
+struct FA1H_MarionetteString
+{
+	GENERATED_BODY()
+
+	// Bone the string is tied to (hand, foot, head, ...)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "String")
+	FName Bone;
+
+	// Where the string hangs from on the control bar, relative to the actor
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "String")
+	FVector ControlBarOffset = FVector(0.0f, 0.0f, 250.0f);
+
+	// String length on top of the rest pose distance, so the limb can hang a little
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "String", meta = (ClampMin = "0.0"))
+	float Slack = 10.0f;
+
+	// Simulated points along the string. More looks rope-ier, costs more.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "String", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 Segments = 4;
+
+	// How far the hinge may bend, in degrees (0 = limb straight)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hinge", meta = (ClampMin = "0.0", ClampMax = "180.0"))
+	float MinBendDegrees = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hinge", meta = (ClampMin = "0.0", ClampMax = "180.0"))
+	float MaxBendDegrees = 150.0f;
+
+	// Axis the hinge bends around, in the limb root bone's space. Bending is positive (counter-clockwise) around it.
+	// Zero = taken from the rest pose, which then has to be a little bent the right way.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hinge")
+	FVector HingeAxis = FVector::ZeroVector;
+};
+
+/**
+ * Strings and hinge joints for a marionette.
+ * This component only describes the rig and holds the results. The actual solve happens for all marionettes
+ * at once in UA1H_MarionetteStringSubsystem. Once solved, every string has an effector (where the tied bone
+ * is pulled to) and a joint target (where the hinge ended up), in the mesh's component space and in string
+ * order. UA1H_MarionetteAnimInstance hands these to the graph for a Two Bone IK per string.
+ */
+UCLASS(ClassGroup = (A1H), meta = (BlueprintSpawnableComponent))
+class ASSIGNMENT1HINGED_API UA1H_MarionetteStringComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UA1H_MarionetteStringComponent();
+
+	// Leave empty for an unstrung marionette, it then costs nothing
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Strings")
+	TArray<FA1H_MarionetteString> Strings;
+
+	// Keep simulating while nobody can see us. Otherwise the strings freeze off screen and settle back when seen again.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Strings")
+	bool bSimulateWhenOffscreen = false;
+
+	// Mesh whose bones the strings are tied to. Defaults to the owning character's mesh.
+	USkeletalMeshComponent* GetStringMesh() const;
+
+	// Results of the last solve, one entry per string (component space of GetStringMesh). Empty until the first solve.
+	const TArray<FVector>& GetEffectorLocations() const { return EffectorLocations; }
+	const TArray<FVector>& GetJointTargetLocations() const { return JointTargetLocations; }
+
+	// True if the last solve produced results this frame (false while frozen off screen)
+	bool HasSolvedResults() const { return bHasSolvedResults; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	friend class UA1H_MarionetteStringSubsystem;
+
+	TArray<FVector> EffectorLocations;
+	TArray<FVector> JointTargetLocations;
+	bool bHasSolvedResults = false;
+};
@@ -0,0 +1,713 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_MarionetteStringSubsystem.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "Animation/A1H_MarionetteStringComponent.h"
+#include "Async/ParallelFor.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("String Solver"), STAT_A1H_StringSolver, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("String Solver Task"), STAT_A1H_StringSolverTask, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("String Solver Layout"), STAT_A1H_StringSolverLayout, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("String Particles"), STAT_A1H_StringParticles, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("String Constraint Batches"), STAT_A1H_StringConstraintBatches, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated String Rigs"), STAT_A1H_SimulatedStringRigs, STATGROUP_A1H);
+
+namespace A1HStringSolver
+{
+    constexpr int32 Lanes = 4;
+
+    // One side (A or B) of a constraint batch, gathered so it can be loaded into registers
+    struct alignas(16) FLaneGather
+    {
+        float X[Lanes];
+        float Y[Lanes];
+        float Z[Lanes];
+        float W[Lanes];
+    };
+}
+
+#pragma region Subsystem Lifetime
+void UA1H_MarionetteStringSubsystem::Deinitialize()
+{
+    Rigs.Reset();
+    Particles.SetNumZeroed(0);
+    ConstraintBatches.SetNumZeroed(0);
+    SimulatedRigIndices.Reset();
+    SET_DWORD_STAT(STAT_A1H_StringParticles, 0);
+    SET_DWORD_STAT(STAT_A1H_StringConstraintBatches, 0);
+    SET_DWORD_STAT(STAT_A1H_SimulatedStringRigs, 0);
+
+    Super::Deinitialize();
+}
+
+void UA1H_MarionetteStringSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_StringSolver);
+
+    // Drop anything that went away without unregistering, and build rigs whose mesh has turned up
+    if (Rigs.RemoveAll([](const FRig& Rig) { return !Rig.Component.IsValid(); }) > 0)
+    {
+        bLayoutDirty = true;
+    }
+    for (FRig& Rig : Rigs)
+    {
+        if (!Rig.bBuilt && BuildRig(Rig))
+        {
+            Rig.bBuilt = true;
+            bLayoutDirty = true;
+        }
+    }
+
+    if (bLayoutDirty)
+    {
+        RebuildLayout();
+    }
+
+    GatherTargets();
+
+    SimulatedRigIndices.Reset();
+    for (int32 RigIndex = 0; RigIndex < Rigs.Num(); ++RigIndex)
+    {
+        if (Rigs[RigIndex].bSimulate)
+        {
+            SimulatedRigIndices.Add(RigIndex);
+        }
+    }
+    SET_DWORD_STAT(STAT_A1H_SimulatedStringRigs, SimulatedRigIndices.Num());
+
+    const float StepDeltaTime = FMath::Min(DeltaTime, MaxDeltaTime);
+    if (SimulatedRigIndices.IsEmpty() || StepDeltaTime <= 0.0f)
+    {
+        WriteResults();
+        return;
+    }
+
+    // Rigs own disjoint ranges of the SoA arrays, so tasks never touch each other's data
+    const float SubDeltaTime = StepDeltaTime / FMath::Max(SubSteps, 1);
+    const float GravityZ = GetWorld()->GetGravityZ();
+    const int32 RigsPerTask = FMath::Max(MarionettesPerTask, 1);
+    const int32 NumTasks = FMath::DivideAndRoundUp(SimulatedRigIndices.Num(), RigsPerTask);
+
+    ParallelFor(NumTasks, [this, RigsPerTask, SubDeltaTime, GravityZ](int32 TaskIndex)
+    {
+        A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_StringSolverTask);
+
+        const int32 First = TaskIndex * RigsPerTask;
+        const int32 Last = FMath::Min(First + RigsPerTask, SimulatedRigIndices.Num());
+        for (int32 Index = First; Index < Last; ++Index)
+        {
+            SolveRig(Rigs[SimulatedRigIndices[Index]], SubDeltaTime, GravityZ);
+        }
+    });
+
+    WriteResults();
+}
+
+TStatId UA1H_MarionetteStringSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UA1H_MarionetteStringSubsystem, STATGROUP_Tickables);
+}
+
+bool UA1H_MarionetteStringSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    // Same as the budget - only worlds that actually play
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+#pragma endregion
+
+#pragma region Registration
+void UA1H_MarionetteStringSubsystem::RegisterStrings(UA1H_MarionetteStringComponent* Component)
+{
+    LLM_SCOPE_BYTAG(A1H_Animation);
+
+    if (!Component || Rigs.ContainsByPredicate([Component](const FRig& Rig) { return Rig.Component.Get() == Component; }))
+    {
+        return;
+    }
+
+    // Built on the next tick (or later, if the mesh is still streaming in)
+    FRig& Rig = Rigs.AddDefaulted_GetRef();
+    Rig.Component = Component;
+}
+
+void UA1H_MarionetteStringSubsystem::UnregisterStrings(UA1H_MarionetteStringComponent* Component)
+{
+    const int32 RigIndex = Rigs.IndexOfByPredicate([Component](const FRig& Rig) { return Rig.Component.Get() == Component; });
+    if (RigIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    if (Rigs[RigIndex].bBuilt)
+    {
+        bLayoutDirty = true;
+    }
+    Rigs.RemoveAt(RigIndex);
+
+    Component->EffectorLocations.Reset();
+    Component->JointTargetLocations.Reset();
+    Component->bHasSolvedResults = false;
+}
+
+#pragma endregion
+
+#pragma region Rig Layout
+bool UA1H_MarionetteStringSubsystem::BuildRig(FRig& Rig) const
+{
+    const UA1H_MarionetteStringComponent* Component = Rig.Component.Get();
+    USkeletalMeshComponent* Mesh = Component ? Component->GetStringMesh() : nullptr;
+    if (!Mesh || !Mesh->GetSkeletalMeshAsset() || !Component->GetOwner())
+    {
+        return false;
+    }
+
+    Rig.Mesh = Mesh;
+    Rig.Strings.Reset();
+    Rig.Constraints.Reset();
+    Rig.InitialPositions.Reset();
+    Rig.InvMasses.Reset();
+
+    // Everything relative to the actor, see FRig::Origin
+    const FTransform ActorTransform = Component->GetOwner()->GetActorTransform();
+    Rig.Origin = ActorTransform.GetLocation();
+
+    auto AddParticle = [&Rig](const FVector& Location, float ParticleInvMass)
+    {
+        Rig.InitialPositions.Add(Location - Rig.Origin);
+        Rig.InvMasses.Add(ParticleInvMass);
+        return Rig.InitialPositions.Num() - 1;
+    };
+
+    auto AddConstraint = [&Rig](int32 A, int32 B, float MinDistance, float MaxDistance, float Compliance)
+    {
+        Rig.Constraints.Add({ A, B, MinDistance, MaxDistance, Compliance });
+    };
+
+    for (const FA1H_MarionetteString& String : Component->Strings)
+    {
+        // Always one slot per string, so results line up with the Strings array even when one is broken
+        FStringSlots& Slots = Rig.Strings.AddDefaulted_GetRef();
+
+        const FName JointBone = Mesh->GetBoneIndex(String.Bone) != INDEX_NONE ? Mesh->GetParentBone(String.Bone) : NAME_None;
+        const FName RootBone = JointBone.IsNone() ? NAME_None : Mesh->GetParentBone(JointBone);
+        if (RootBone.IsNone())
+        {
+            UE_LOG(LogA1H, Warning, TEXT("%s: string bone '%s' needs a parent and grandparent to hinge on, skipping it"),
+                *GetNameSafe(Component->GetOwner()), *String.Bone.ToString());
+            continue;
+        }
+
+        const FVector RootLocation = Mesh->GetBoneLocation(RootBone);
+        const FVector JointLocation = Mesh->GetBoneLocation(JointBone);
+        const FVector EndLocation = Mesh->GetBoneLocation(String.Bone);
+        const FVector AnchorLocation = ActorTransform.TransformPosition(String.ControlBarOffset);
+
+        const float UpperLength = FVector::Dist(RootLocation, JointLocation);
+        const float LowerLength = FVector::Dist(JointLocation, EndLocation);
+
+        // No pose yet (everything still at the origin), try again next frame
+        if (UpperLength < UE_KINDA_SMALL_NUMBER || LowerLength < UE_KINDA_SMALL_NUMBER)
+        {
+            return false;
+        }
+
+        Slots.Anchor = AddParticle(AnchorLocation, 0.0f);
+        Slots.Root = AddParticle(RootLocation, 0.0f);
+        Slots.Joint = AddParticle(JointLocation, 1.0f);
+        Slots.End = AddParticle(EndLocation, 1.0f);
+        Slots.RootBone = RootBone;
+        Slots.ControlBarOffset = String.ControlBarOffset;
+
+        // Bones don't stretch
+        AddConstraint(Slots.Root, Slots.Joint, UpperLength, UpperLength, 0.0f);
+        AddConstraint(Slots.Joint, Slots.End, LowerLength, LowerLength, 0.0f);
+
+        // Hinge: bending by an angle puts the end at a fixed distance from the root (law of cosines),
+        // so the bend limits turn into a min/max distance between the two
+        auto RootToEndDistance = [UpperLength, LowerLength](float BendDegrees)
+        {
+            const float CosBend = FMath::Cos(FMath::DegreesToRadians(BendDegrees));
+            return FMath::Sqrt(FMath::Max(UpperLength * UpperLength + LowerLength * LowerLength + 2.0f * UpperLength * LowerLength * CosBend, 0.0f));
+        };
+        const float MinBend = FMath::Min(String.MinBendDegrees, String.MaxBendDegrees);
+        const float MaxBend = FMath::Max(String.MinBendDegrees, String.MaxBendDegrees);
+        AddConstraint(Slots.Root, Slots.End, RootToEndDistance(MaxBend), RootToEndDistance(MinBend), HingeCompliance);
+
+        // The distance alone allows any bend direction, so SolveHinges also needs the axis it bends around.
+        // Kept in the root bone's space so it turns with the animated shoulder/hip.
+        const FQuat RootRotation = Mesh->GetBoneQuaternion(RootBone);
+        FVector WorldHingeAxis = RootRotation.RotateVector(String.HingeAxis).GetSafeNormal();
+        if (WorldHingeAxis.IsZero())
+        {
+            WorldHingeAxis = FVector::CrossProduct(JointLocation - RootLocation, EndLocation - JointLocation).GetSafeNormal();
+        }
+        if (WorldHingeAxis.IsZero())
+        {
+            UE_LOG(LogA1H, Warning, TEXT("%s: '%s' is straight in the rest pose and has no HingeAxis, its bend direction isn't limited"),
+                *GetNameSafe(Component->GetOwner()), *String.Bone.ToString());
+        }
+        Slots.LocalHingeAxis = RootRotation.UnrotateVector(WorldHingeAxis);
+        Slots.HingeAxis = FVector3f(WorldHingeAxis);
+        Slots.MinBend = FMath::DegreesToRadians(MinBend);
+        Slots.MaxBend = FMath::DegreesToRadians(MaxBend);
+
+        // String: a chain from the control bar to the tied bone that can only pull
+        const int32 Segments = FMath::Clamp(String.Segments, 1, 16);
+        const float SegmentLength = (FVector::Dist(AnchorLocation, EndLocation) + String.Slack) / Segments;
+        int32 Previous = Slots.Anchor;
+        for (int32 Segment = 1; Segment < Segments; ++Segment)
+        {
+            const int32 Point = AddParticle(FMath::Lerp(AnchorLocation, EndLocation, float(Segment) / Segments), StringPointInvMass);
+            AddConstraint(Previous, Point, 0.0f, SegmentLength, StringCompliance);
+            Previous = Point;
+        }
+        AddConstraint(Previous, Slots.End, 0.0f, SegmentLength, StringCompliance);
+    }
+
+    // Even with every string skipped the rig counts as built (it's just empty), so we don't warn every frame
+    return true;
+}
+
+void UA1H_MarionetteStringSubsystem::RebuildLayout()
+{
+    using namespace A1HStringSolver;
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_StringSolverLayout);
+    LLM_SCOPE_BYTAG(A1H_Animation);
+
+    bLayoutDirty = false;
+
+    // Greedy batching: each constraint goes into the first batch of its rig that has a free lane and
+    // doesn't touch either of its particles yet
+    TArray<TArray<TArray<int32, TInlineAllocator<Lanes>>>> RigBatches;
+    RigBatches.SetNum(Rigs.Num());
+
+    int32 TotalParticles = 0;
+    int32 TotalBatches = 0;
+    for (int32 RigIndex = 0; RigIndex < Rigs.Num(); ++RigIndex)
+    {
+        const FRig& Rig = Rigs[RigIndex];
+        if (!Rig.bBuilt)
+        {
+            continue;
+        }
+
+        TArray<TArray<int32, TInlineAllocator<Lanes>>>& Batches = RigBatches[RigIndex];
+        for (int32 ConstraintIndex = 0; ConstraintIndex < Rig.Constraints.Num(); ++ConstraintIndex)
+        {
+            const FConstraint& Constraint = Rig.Constraints[ConstraintIndex];
+            auto Fits = [&Rig, &Constraint](const TArray<int32, TInlineAllocator<Lanes>>& Batch)
+            {
+                return Batch.Num() < Lanes && !Batch.ContainsByPredicate([&Rig, &Constraint](int32 Other)
+                {
+                    const FConstraint& OtherConstraint = Rig.Constraints[Other];
+                    return OtherConstraint.A == Constraint.A || OtherConstraint.A == Constraint.B
+                        || OtherConstraint.B == Constraint.A || OtherConstraint.B == Constraint.B;
+                });
+            };
+
+            TArray<int32, TInlineAllocator<Lanes>>* Batch = Batches.FindByPredicate(Fits);
+            if (!Batch)
+            {
+                Batch = &Batches.AddDefaulted_GetRef();
+            }
+            Batch->Add(ConstraintIndex);
+        }
+
+        TotalParticles += Align(Rig.InitialPositions.Num(), Lanes);
+        TotalBatches += Batches.Num();
+    }
+
+    FParticleSoA NewParticles;
+    NewParticles.SetNumZeroed(TotalParticles);
+    FConstraintSoA NewBatches;
+    NewBatches.SetNumZeroed(TotalBatches);
+
+    int32 NextParticle = 0;
+    int32 NextBatch = 0;
+    for (int32 RigIndex = 0; RigIndex < Rigs.Num(); ++RigIndex)
+    {
+        FRig& Rig = Rigs[RigIndex];
+        if (!Rig.bBuilt)
+        {
+            continue;
+        }
+
+        // Rigs that were already simulating keep where they are, new ones start from the rest pose
+        for (int32 Local = 0; Local < Rig.InitialPositions.Num(); ++Local)
+        {
+            const int32 Index = NextParticle + Local;
+            FVector Position = Rig.InitialPositions[Local];
+            FVector Previous = Position;
+            if (Rig.ParticleStart != INDEX_NONE)
+            {
+                const int32 OldIndex = Rig.ParticleStart + Local;
+                Position = FVector(Particles.PosX[OldIndex], Particles.PosY[OldIndex], Particles.PosZ[OldIndex]);
+                Previous = FVector(Particles.PrevX[OldIndex], Particles.PrevY[OldIndex], Particles.PrevZ[OldIndex]);
+            }
+
+            NewParticles.PosX[Index] = NewParticles.PinFromX[Index] = NewParticles.PinToX[Index] = Position.X;
+            NewParticles.PosY[Index] = NewParticles.PinFromY[Index] = NewParticles.PinToY[Index] = Position.Y;
+            NewParticles.PosZ[Index] = NewParticles.PinFromZ[Index] = NewParticles.PinToZ[Index] = Position.Z;
+            NewParticles.PrevX[Index] = Previous.X;
+            NewParticles.PrevY[Index] = Previous.Y;
+            NewParticles.PrevZ[Index] = Previous.Z;
+            NewParticles.InvMass[Index] = Rig.InvMasses[Local];
+        }
+
+        const TArray<TArray<int32, TInlineAllocator<Lanes>>>& Batches = RigBatches[RigIndex];
+        for (int32 BatchIndex = 0; BatchIndex < Batches.Num(); ++BatchIndex)
+        {
+            const int32 Batch = NextBatch + BatchIndex;
+            NewBatches.LaneCounts[Batch] = Batches[BatchIndex].Num();
+
+            // Unused lanes point at the rig's first particle and are never written back
+            for (int32 Lane = 0; Lane < Lanes; ++Lane)
+            {
+                const int32 Slot = Batch * Lanes + Lane;
+                NewBatches.A[Slot] = NewBatches.B[Slot] = NextParticle;
+                if (Batches[BatchIndex].IsValidIndex(Lane))
+                {
+                    const FConstraint& Constraint = Rig.Constraints[Batches[BatchIndex][Lane]];
+                    NewBatches.A[Slot] = NextParticle + Constraint.A;
+                    NewBatches.B[Slot] = NextParticle + Constraint.B;
+                    NewBatches.MinDistance[Slot] = Constraint.MinDistance;
+                    NewBatches.MaxDistance[Slot] = Constraint.MaxDistance;
+                    NewBatches.Compliance[Slot] = Constraint.Compliance;
+                }
+            }
+        }
+
+        Rig.ParticleStart = NextParticle;
+        Rig.ParticleCount = Align(Rig.InitialPositions.Num(), Lanes);
+        Rig.BatchStart = NextBatch;
+        Rig.BatchCount = Batches.Num();
+
+        NextParticle += Rig.ParticleCount;
+        NextBatch += Rig.BatchCount;
+    }
+
+    Particles = MoveTemp(NewParticles);
+    ConstraintBatches = MoveTemp(NewBatches);
+
+    SET_DWORD_STAT(STAT_A1H_StringParticles, TotalParticles);
+    SET_DWORD_STAT(STAT_A1H_StringConstraintBatches, TotalBatches);
+}
+
+void UA1H_MarionetteStringSubsystem::FParticleSoA::SetNumZeroed(int32 Num)
+{
+    for (TSimdArray<float>* Array : { &PosX, &PosY, &PosZ, &PrevX, &PrevY, &PrevZ, &PinFromX, &PinFromY, &PinFromZ, &PinToX, &PinToY, &PinToZ, &InvMass })
+    {
+        Array->SetNumZeroed(Num);
+    }
+}
+
+void UA1H_MarionetteStringSubsystem::FConstraintSoA::SetNumZeroed(int32 NumBatches)
+{
+    const int32 NumLanes = NumBatches * A1HStringSolver::Lanes;
+    A.SetNumZeroed(NumLanes);
+    B.SetNumZeroed(NumLanes);
+    MinDistance.SetNumZeroed(NumLanes);
+    MaxDistance.SetNumZeroed(NumLanes);
+    Compliance.SetNumZeroed(NumLanes);
+    LaneCounts.SetNumZeroed(NumBatches);
+}
+
+#pragma endregion
+
+#pragma region Solve
+void UA1H_MarionetteStringSubsystem::GatherTargets()
+{
+    for (FRig& Rig : Rigs)
+    {
+        const UA1H_MarionetteStringComponent* Component = Rig.Component.Get();
+        const USkeletalMeshComponent* Mesh = Rig.Mesh.Get();
+        const AActor* Owner = Component ? Component->GetOwner() : nullptr;
+
+        // Strings nobody can see are left hanging where they were
+        Rig.bSimulate = Rig.bBuilt && Mesh && Owner && (Component->bSimulateWhenOffscreen || Owner->WasRecentlyRendered(OffscreenTolerance));
+        if (!Rig.bSimulate)
+        {
+            continue;
+        }
+
+        // Move the origin along with the actor. Normally the particles are shifted back by the same amount so they
+        // stay where they are in the world. Teleported (or popped back on screen far away): leave them, which
+        // carries the whole rig along instead of letting it stretch.
+        const FTransform ActorTransform = Owner->GetActorTransform();
+        const FVector Delta = ActorTransform.GetLocation() - Rig.Origin;
+        Rig.Origin = ActorTransform.GetLocation();
+        if (!Delta.IsZero() && Delta.SizeSquared() <= FMath::Square(TeleportDistance))
+        {
+            const FVector3f Shift(Delta);
+            for (int32 Index = Rig.ParticleStart; Index < Rig.ParticleStart + Rig.ParticleCount; ++Index)
+            {
+                Particles.PosX[Index] -= Shift.X;
+                Particles.PosY[Index] -= Shift.Y;
+                Particles.PosZ[Index] -= Shift.Z;
+                Particles.PrevX[Index] -= Shift.X;
+                Particles.PrevY[Index] -= Shift.Y;
+                Particles.PrevZ[Index] -= Shift.Z;
+            }
+        }
+
+        for (FStringSlots& Slots : Rig.Strings)
+        {
+            if (Slots.End == INDEX_NONE)
+            {
+                continue;
+            }
+
+            SetPinTarget(Rig.ParticleStart + Slots.Anchor, ActorTransform.TransformVector(Slots.ControlBarOffset));
+            SetPinTarget(Rig.ParticleStart + Slots.Root, Mesh->GetBoneLocation(Slots.RootBone) - Rig.Origin);
+            Slots.HingeAxis = FVector3f(Mesh->GetBoneQuaternion(Slots.RootBone).RotateVector(Slots.LocalHingeAxis));
+        }
+    }
+}
+
+void UA1H_MarionetteStringSubsystem::SetPinTarget(int32 ParticleIndex, const FVector& Target)
+{
+    Particles.PinFromX[ParticleIndex] = Particles.PosX[ParticleIndex];
+    Particles.PinFromY[ParticleIndex] = Particles.PosY[ParticleIndex];
+    Particles.PinFromZ[ParticleIndex] = Particles.PosZ[ParticleIndex];
+    Particles.PinToX[ParticleIndex] = Target.X;
+    Particles.PinToY[ParticleIndex] = Target.Y;
+    Particles.PinToZ[ParticleIndex] = Target.Z;
+}
+
+void UA1H_MarionetteStringSubsystem::SolveRig(const FRig& Rig, float SubDeltaTime, float GravityZ)
+{
+    using namespace A1HStringSolver;
+
+    const VectorRegister4Float Zero = VectorZeroFloat();
+    const VectorRegister4Float Epsilon = VectorSetFloat1(UE_KINDA_SMALL_NUMBER);
+    const VectorRegister4Float Keep = VectorSetFloat1(1.0f - Damping);
+    const VectorRegister4Float GravityStep = VectorSetFloat1(GravityZ * SubDeltaTime * SubDeltaTime);
+    const VectorRegister4Float InvSubDeltaTimeSq = VectorSetFloat1(1.0f / (SubDeltaTime * SubDeltaTime));
+
+    const int32 ParticleEnd = Rig.ParticleStart + Rig.ParticleCount;
+    const int32 BatchEnd = Rig.BatchStart + Rig.BatchCount;
+    const int32 NumSubSteps = FMath::Max(SubSteps, 1);
+
+    FLaneGather GatherA;
+    FLaneGather GatherB;
+
+    for (int32 SubStep = 0; SubStep < NumSubSteps; ++SubStep)
+    {
+        // Verlet, 4 particles at a time: x' = x + (x - prev) * (1 - damping) + g * dt^2
+        const VectorRegister4Float PinAlpha = VectorSetFloat1(float(SubStep + 1) / NumSubSteps);
+        for (int32 Index = Rig.ParticleStart; Index < ParticleEnd; Index += Lanes)
+        {
+            const VectorRegister4Float X = VectorLoadAligned(&Particles.PosX[Index]);
+            const VectorRegister4Float Y = VectorLoadAligned(&Particles.PosY[Index]);
+            const VectorRegister4Float Z = VectorLoadAligned(&Particles.PosZ[Index]);
+
+            VectorRegister4Float NewX = VectorMultiplyAdd(VectorSubtract(X, VectorLoadAligned(&Particles.PrevX[Index])), Keep, X);
+            VectorRegister4Float NewY = VectorMultiplyAdd(VectorSubtract(Y, VectorLoadAligned(&Particles.PrevY[Index])), Keep, Y);
+            VectorRegister4Float NewZ = VectorAdd(VectorMultiplyAdd(VectorSubtract(Z, VectorLoadAligned(&Particles.PrevZ[Index])), Keep, Z), GravityStep);
+
+            // Pinned particles ignore all that and slide towards their target over the frame
+            const VectorRegister4Float Pinned = VectorCompareEQ(VectorLoadAligned(&Particles.InvMass[Index]), Zero);
+            const VectorRegister4Float PinFromX = VectorLoadAligned(&Particles.PinFromX[Index]);
+            const VectorRegister4Float PinFromY = VectorLoadAligned(&Particles.PinFromY[Index]);
+            const VectorRegister4Float PinFromZ = VectorLoadAligned(&Particles.PinFromZ[Index]);
+            NewX = VectorSelect(Pinned, VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(&Particles.PinToX[Index]), PinFromX), PinAlpha, PinFromX), NewX);
+            NewY = VectorSelect(Pinned, VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(&Particles.PinToY[Index]), PinFromY), PinAlpha, PinFromY), NewY);
+            NewZ = VectorSelect(Pinned, VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(&Particles.PinToZ[Index]), PinFromZ), PinAlpha, PinFromZ), NewZ);
+
+            VectorStoreAligned(X, &Particles.PrevX[Index]);
+            VectorStoreAligned(Y, &Particles.PrevY[Index]);
+            VectorStoreAligned(Z, &Particles.PrevZ[Index]);
+            VectorStoreAligned(NewX, &Particles.PosX[Index]);
+            VectorStoreAligned(NewY, &Particles.PosY[Index]);
+            VectorStoreAligned(NewZ, &Particles.PosZ[Index]);
+        }
+
+        // Constraints, 4 at a time. One pass per sub step, so lambda starts at 0 every time (small steps XPBD)
+        // and a constraint's correction is just -C / (wA + wB + compliance / dt^2) along the gradient.
+        for (int32 Batch = Rig.BatchStart; Batch < BatchEnd; ++Batch)
+        {
+            const int32 FirstLane = Batch * Lanes;
+            for (int32 Lane = 0; Lane < Lanes; ++Lane)
+            {
+                const int32 A = ConstraintBatches.A[FirstLane + Lane];
+                const int32 B = ConstraintBatches.B[FirstLane + Lane];
+                GatherA.X[Lane] = Particles.PosX[A];
+                GatherA.Y[Lane] = Particles.PosY[A];
+                GatherA.Z[Lane] = Particles.PosZ[A];
+                GatherA.W[Lane] = Particles.InvMass[A];
+                GatherB.X[Lane] = Particles.PosX[B];
+                GatherB.Y[Lane] = Particles.PosY[B];
+                GatherB.Z[Lane] = Particles.PosZ[B];
+                GatherB.W[Lane] = Particles.InvMass[B];
+            }
+
+            const VectorRegister4Float AX = VectorLoadAligned(GatherA.X);
+            const VectorRegister4Float AY = VectorLoadAligned(GatherA.Y);
+            const VectorRegister4Float AZ = VectorLoadAligned(GatherA.Z);
+            const VectorRegister4Float AW = VectorLoadAligned(GatherA.W);
+            const VectorRegister4Float BX = VectorLoadAligned(GatherB.X);
+            const VectorRegister4Float BY = VectorLoadAligned(GatherB.Y);
+            const VectorRegister4Float BZ = VectorLoadAligned(GatherB.Z);
+            const VectorRegister4Float BW = VectorLoadAligned(GatherB.W);
+
+            const VectorRegister4Float DX = VectorSubtract(BX, AX);
+            const VectorRegister4Float DY = VectorSubtract(BY, AY);
+            const VectorRegister4Float DZ = VectorSubtract(BZ, AZ);
+            const VectorRegister4Float Length = VectorSqrt(VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ))));
+
+            // How far outside [Min, Max] the distance is
+            const VectorRegister4Float Clamped = VectorMin(VectorMax(Length, VectorLoadAligned(&ConstraintBatches.MinDistance[FirstLane])), VectorLoadAligned(&ConstraintBatches.MaxDistance[FirstLane]));
+            const VectorRegister4Float Error = VectorSubtract(Length, Clamped);
+
+            const VectorRegister4Float Alpha = VectorMultiply(VectorLoadAligned(&ConstraintBatches.Compliance[FirstLane]), InvSubDeltaTimeSq);
+            const VectorRegister4Float Denominator = VectorMax(VectorAdd(VectorAdd(AW, BW), Alpha), Epsilon);
+
+            // Lambda / length, so multiplying by D gives lambda * normal. Zero length lanes end up tiny instead of NaN.
+            const VectorRegister4Float Scale = VectorDivide(VectorNegate(Error), VectorMultiply(Denominator, VectorMax(Length, Epsilon)));
+            const VectorRegister4Float CX = VectorMultiply(DX, Scale);
+            const VectorRegister4Float CY = VectorMultiply(DY, Scale);
+            const VectorRegister4Float CZ = VectorMultiply(DZ, Scale);
+
+            VectorStoreAligned(VectorNegateMultiplyAdd(AW, CX, AX), GatherA.X);
+            VectorStoreAligned(VectorNegateMultiplyAdd(AW, CY, AY), GatherA.Y);
+            VectorStoreAligned(VectorNegateMultiplyAdd(AW, CZ, AZ), GatherA.Z);
+            VectorStoreAligned(VectorMultiplyAdd(BW, CX, BX), GatherB.X);
+            VectorStoreAligned(VectorMultiplyAdd(BW, CY, BY), GatherB.Y);
+            VectorStoreAligned(VectorMultiplyAdd(BW, CZ, BZ), GatherB.Z);
+
+            // Scatter only the lanes in use. They share no particle, so order doesn't matter.
+            const int32 LaneCount = ConstraintBatches.LaneCounts[Batch];
+            for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+            {
+                const int32 A = ConstraintBatches.A[FirstLane + Lane];
+                const int32 B = ConstraintBatches.B[FirstLane + Lane];
+                Particles.PosX[A] = GatherA.X[Lane];
+                Particles.PosY[A] = GatherA.Y[Lane];
+                Particles.PosZ[A] = GatherA.Z[Lane];
+                Particles.PosX[B] = GatherB.X[Lane];
+                Particles.PosY[B] = GatherB.Y[Lane];
+                Particles.PosZ[B] = GatherB.Z[Lane];
+            }
+        }
+
+        SolveHinges(Rig);
+    }
+}
+
+void UA1H_MarionetteStringSubsystem::SolveHinges(const FRig& Rig)
+{
+    // Only a handful per rig, so plain scalar code
+    auto Load = [this, &Rig](int32 Local)
+    {
+        const int32 Index = Rig.ParticleStart + Local;
+        return FVector3f(Particles.PosX[Index], Particles.PosY[Index], Particles.PosZ[Index]);
+    };
+    auto Store = [this, &Rig](int32 Local, const FVector3f& Position)
+    {
+        const int32 Index = Rig.ParticleStart + Local;
+        Particles.PosX[Index] = Position.X;
+        Particles.PosY[Index] = Position.Y;
+        Particles.PosZ[Index] = Position.Z;
+    };
+
+    for (const FStringSlots& Slots : Rig.Strings)
+    {
+        if (Slots.End == INDEX_NONE || Slots.HingeAxis.IsNearlyZero())
+        {
+            continue;
+        }
+
+        const FVector3f Root = Load(Slots.Root);
+        FVector3f Joint = Load(Slots.Joint);
+        FVector3f End = Load(Slots.End);
+
+        // The bend plane goes through the root and the end. Its normal is the animated hinge axis, turned to lie
+        // across the root-end line (that's the twist the pose wants).
+        const FVector3f RootToEnd = (End - Root).GetSafeNormal();
+        const FVector3f Axis = (Slots.HingeAxis - RootToEnd * (Slots.HingeAxis | RootToEnd)).GetSafeNormal();
+        if (RootToEnd.IsZero() || Axis.IsZero())
+        {
+            continue;
+        }
+
+        // No sideways bending: the joint goes onto the plane
+        Joint -= Axis * ((Joint - Root) | Axis);
+
+        // Bent backwards: mirror the joint across the root-end line. Both bone lengths stay the same.
+        FVector3f Upper = Joint - Root;
+        FVector3f Lower = End - Joint;
+        float Bend = FMath::Atan2((Upper ^ Lower) | Axis, Upper | Lower);
+        if (Bend < 0.0f)
+        {
+            const FVector3f OnLine = Root + RootToEnd * ((Joint - Root) | RootToEnd);
+            Joint = OnLine * 2.0f - Joint;
+            Upper = Joint - Root;
+            Lower = End - Joint;
+            Bend = -Bend;
+        }
+
+        // Still outside the limits (the distance constraint is compliant): swing the lower bone round the hinge
+        const float ClampedBend = FMath::Clamp(Bend, Slots.MinBend, Slots.MaxBend);
+        if (ClampedBend != Bend)
+        {
+            End = Joint + FQuat4f(Axis, ClampedBend).RotateVector(Upper.GetSafeNormal()) * Lower.Size();
+            Store(Slots.End, End);
+        }
+
+        Store(Slots.Joint, Joint);
+    }
+}
+
+void UA1H_MarionetteStringSubsystem::WriteResults()
+{
+    // Anim has already updated this frame by the time tickables run, so the graph picks these up next frame
+    for (const FRig& Rig : Rigs)
+    {
+        UA1H_MarionetteStringComponent* Component = Rig.Component.Get();
+        const USkeletalMeshComponent* Mesh = Rig.Mesh.Get();
+        if (!Component || !Mesh)
+        {
+            continue;
+        }
+
+        Component->bHasSolvedResults = Rig.bSimulate;
+        if (!Rig.bSimulate)
+        {
+            continue;
+        }
+
+        const FTransform& MeshTransform = Mesh->GetComponentTransform();
+        Component->EffectorLocations.SetNum(Rig.Strings.Num());
+        Component->JointTargetLocations.SetNum(Rig.Strings.Num());
+        for (int32 StringIndex = 0; StringIndex < Rig.Strings.Num(); ++StringIndex)
+        {
+            const FStringSlots& Slots = Rig.Strings[StringIndex];
+            if (Slots.End == INDEX_NONE)
+            {
+                Component->EffectorLocations[StringIndex] = FVector::ZeroVector;
+                Component->JointTargetLocations[StringIndex] = FVector::ZeroVector;
+                continue;
+            }
+
+            Component->EffectorLocations[StringIndex] = MeshTransform.InverseTransformPosition(GetParticleLocation(Rig, Slots.End));
+            Component->JointTargetLocations[StringIndex] = MeshTransform.InverseTransformPosition(GetParticleLocation(Rig, Slots.Joint));
+        }
+    }
+}
+
+FVector UA1H_MarionetteStringSubsystem::GetParticleLocation(const FRig& Rig, int32 LocalIndex) const
+{
+    const int32 Index = Rig.ParticleStart + LocalIndex;
+    return Rig.Origin + FVector(Particles.PosX[Index], Particles.PosY[Index], Particles.PosZ[Index]);
+}
+
+#pragma endregion
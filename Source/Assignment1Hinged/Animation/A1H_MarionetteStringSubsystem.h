@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "A1H_MarionetteStringSubsystem.generated.h"
+
+class UA1H_MarionetteStringComponent;
+class USkeletalMeshComponent;
+
+/**
+ * Solves the strings and hinges of every strung marionette in the world.
+ * Each marionette becomes a small particle rig:
+ *   - the control bar points and limb roots are pinned (they follow the actor and the animated pose)
+ *   - the hinge and string end of each limb, and the points along the string, are free
+ * All constraints are min/max distance constraints between two particles, solved XPBD style:
+ *   - bones are rigid (min = max)
+ *   - strings only pull (0 .. length)
+ *   - hinge limits become a min/max distance between the limb root and the string end
+ * After the constraints, a hinge pass per string keeps the joint in the bend plane (root, end and the animated hinge
+ * axis) and clamps the signed bend angle, so elbows and knees can't fold backwards or sideways.
+ * Particles are stored relative to their actor, so rigs stay precise far from the world origin.
+ * Particles and constraints of all marionettes live in flat SoA arrays padded to 4. Verlet integration runs
+ * 4 particles at a time and constraints are projected in batches of 4 that share no particle, both with
+ * VectorRegister4Float. Marionettes are independent, so they're spread over worker tasks with ParallelFor.
+ * Tuned from DefaultGame.ini.
+ */
+UCLASS(Config = Game)
+class ASSIGNMENT1HINGED_API UA1H_MarionetteStringSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Subsystem Lifetime
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+#pragma endregion
+
+public:
+#pragma region Registration
+	// Called by string components from BeginPlay/EndPlay. The rig is built once the mesh has its asset.
+	void RegisterStrings(UA1H_MarionetteStringComponent* Component);
+	void UnregisterStrings(UA1H_MarionetteStringComponent* Component);
+
+#pragma endregion
+
+#pragma region Solver Settings
+	// Sub steps per frame. Each does one integration and one constraint pass (small steps XPBD).
+	UPROPERTY(Config, EditAnywhere, Category = "Solver", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 SubSteps = 4;
+
+	// Frame time is clamped to this before being split into sub steps, so hitches don't blow the rigs up
+	UPROPERTY(Config, EditAnywhere, Category = "Solver")
+	float MaxDeltaTime = 1.0f / 30.0f;
+
+	// Fraction of velocity lost per sub step
+	UPROPERTY(Config, EditAnywhere, Category = "Solver", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float Damping = 0.02f;
+
+	// XPBD compliance of strings and hinge limits (bones are always rigid). 0 = perfectly stiff.
+	UPROPERTY(Config, EditAnywhere, Category = "Solver", meta = (ClampMin = "0.0"))
+	float StringCompliance = 0.0001f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Solver", meta = (ClampMin = "0.0"))
+	float HingeCompliance = 0.00001f;
+
+	// Inverse mass of the points along a string, relative to the limb points (1). Higher = lighter string.
+	UPROPERTY(Config, EditAnywhere, Category = "Solver", meta = (ClampMin = "0.01"))
+	float StringPointInvMass = 10.0f;
+
+	// Marionettes solved per worker task
+	UPROPERTY(Config, EditAnywhere, Category = "Solver", meta = (ClampMin = "1"))
+	int32 MarionettesPerTask = 4;
+
+	// If the control bar moves further than this in one frame, the whole rig is moved along instead of stretched
+	UPROPERTY(Config, EditAnywhere, Category = "Solver")
+	float TeleportDistance = 500.0f;
+
+	// How long a marionette may go unrendered before its strings freeze (unless bSimulateWhenOffscreen)
+	UPROPERTY(Config, EditAnywhere, Category = "Solver")
+	float OffscreenTolerance = 0.25f;
+
+#pragma endregion
+
+private:
+	// Local (per rig) particle indices of one string
+	struct FStringSlots
+	{
+		int32 Anchor = INDEX_NONE;
+		int32 Root = INDEX_NONE;
+		int32 Joint = INDEX_NONE;
+		int32 End = INDEX_NONE;
+		FName RootBone;
+		FVector ControlBarOffset = FVector::ZeroVector;
+
+		// Bend axis in the root bone's space, and rotated by its current pose for this frame. Zero = no bend plane.
+		FVector LocalHingeAxis = FVector::ZeroVector;
+		FVector3f HingeAxis = FVector3f::ZeroVector;
+
+		// Allowed signed bend, in radians
+		float MinBend = 0.0f;
+		float MaxBend = 0.0f;
+	};
+
+	// Min/max distance constraint, local particle indices
+	struct FConstraint
+	{
+		int32 A = 0;
+		int32 B = 0;
+		float MinDistance = 0.0f;
+		float MaxDistance = 0.0f;
+		float Compliance = 0.0f;
+	};
+
+	struct FRig
+	{
+		TWeakObjectPtr<UA1H_MarionetteStringComponent> Component;
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+		// Built once the mesh has bones to read
+		bool bBuilt = false;
+
+		// Solved this frame (false while frozen off screen)
+		bool bSimulate = false;
+
+		// Rig description, local indices
+		TArray<FStringSlots> Strings;
+		TArray<FConstraint> Constraints;
+		TArray<FVector> InitialPositions;
+		TArray<float> InvMasses;
+
+		// Where the rig sits in the SoA arrays. Both multiples of 4.
+		int32 ParticleStart = INDEX_NONE;
+		int32 ParticleCount = 0;
+		int32 BatchStart = 0;
+		int32 BatchCount = 0;
+
+		// Where the actor was last frame. Particles are stored relative to it (floats far from the world origin
+		// would lose precision) and a big jump counts as a teleport.
+		FVector Origin = FVector::ZeroVector;
+	};
+
+	// Reads the rest pose off the mesh and lays out particles/constraints. False if the mesh isn't ready yet.
+	bool BuildRig(FRig& Rig) const;
+
+	// Repacks the SoA arrays after rigs came or went, keeping the state of the ones that stay
+	void RebuildLayout();
+
+	// Game thread: pinned particle targets from the actors and poses
+	void GatherTargets();
+
+	// Worker thread: sub stepped integration + constraint projection for one rig
+	void SolveRig(const FRig& Rig, float SubDeltaTime, float GravityZ);
+
+	// Worker thread: keeps each of the rig's hinges in its bend plane and its bend angle in range
+	void SolveHinges(const FRig& Rig);
+
+	// Game thread: hands effector/joint positions back to the components
+	void WriteResults();
+
+	// World position of one of a rig's particles (local index)
+	FVector GetParticleLocation(const FRig& Rig, int32 LocalIndex) const;
+
+	// Starts a pinned particle's slide towards Target (relative to the rig's origin) for this frame
+	void SetPinTarget(int32 ParticleIndex, const FVector& Target);
+
+	TArray<FRig> Rigs;
+	bool bLayoutDirty = false;
+
+#pragma region SoA Storage
+	template <typename ElementType>
+	using TSimdArray = TArray<ElementType, TAlignedHeapAllocator<16>>;
+
+	struct FParticleSoA
+	{
+		TSimdArray<float> PosX, PosY, PosZ;
+		TSimdArray<float> PrevX, PrevY, PrevZ;
+
+		// Pinned particles slide from PinFrom to PinTo over the sub steps of a frame
+		TSimdArray<float> PinFromX, PinFromY, PinFromZ;
+		TSimdArray<float> PinToX, PinToY, PinToZ;
+
+		// 0 = pinned (also used for padding)
+		TSimdArray<float> InvMass;
+
+		void SetNumZeroed(int32 Num);
+	};
+
+	// 4 lanes per batch. Lanes of one batch never share a particle, so they can be projected together.
+	struct FConstraintSoA
+	{
+		TSimdArray<int32> A, B;
+		TSimdArray<float> MinDistance, MaxDistance, Compliance;
+
+		// Lanes actually in use, per batch
+		TArray<int32> LaneCounts;
+
+		void SetNumZeroed(int32 NumBatches);
+	};
+
+	FParticleSoA Particles;
+	FConstraintSoA ConstraintBatches;
+
+	// Scratch list of rigs solved this frame
+	TArray<int32> SimulatedRigIndices;
+
+#pragma endregion
+};
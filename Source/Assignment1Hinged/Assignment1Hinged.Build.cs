@@ -10,7 +10,19 @@ public class Assignment1Hinged : ModuleRules
 	
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] {  });
+		PrivateDependencyModuleNames.AddRange(new string[] { "NetCore", "RenderCore", "RHI", "AIModule" });
+
+		// Lets sub-folders include each other relative to the module root (e.g. "Interaction/...")
+		PublicIncludePaths.Add(ModuleDirectory);
+
+		// Editor builds listen for Blueprint compiles (GEditor) to drop the interaction dispatch cache
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
+
+		// The A1H gameplay debugger category. Adds the GameplayDebugger module when the target uses it and defines WITH_GAMEPLAY_DEBUGGER either way.
+		SetupGameplayDebuggerSupport(Target);
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -2,5 +2,174 @@
 
 #include "Assignment1Hinged.h"
 #include "Modules/ModuleManager.h"
+#include "Containers/Ticker.h"
+#include "Debug/A1H_EventJournal.h"
+#include "Debug/A1H_GameplayDebuggerCategory.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Assignment1Hinged, "Assignment1Hinged" );
+#if A1H_WITH_GAMEPLAY_DEBUGGER
+#include "GameplayDebugger.h"
+#endif
+
+DEFINE_LOG_CATEGORY(LogA1H);
+
+LLM_DEFINE_TAG(A1H);
+LLM_DEFINE_TAG(A1H_Marionette, TEXT("Marionette"), TEXT("A1H"));
+LLM_DEFINE_TAG(A1H_Animation, TEXT("Animation"), TEXT("A1H"));
+LLM_DEFINE_TAG(A1H_Interaction, TEXT("Interaction"), TEXT("A1H"));
+LLM_DEFINE_TAG(A1H_Crowd, TEXT("Crowd"), TEXT("A1H"));
+LLM_DEFINE_TAG(A1H_Pooling, TEXT("Pooling"), TEXT("A1H"));
+LLM_DEFINE_TAG(A1H_Tools, TEXT("Tools"), TEXT("A1H"));
+
+DEFINE_STAT(STAT_A1H_Interactions);
+DEFINE_STAT(STAT_A1H_InteractionTraceHits);
+DEFINE_STAT(STAT_A1H_InteractionTraceMisses);
+DEFINE_STAT(STAT_A1H_InteractionInterfaceMisses);
+DEFINE_STAT(STAT_A1H_InteractionsPerSecond);
+DEFINE_STAT(STAT_A1H_InterfaceMissRate);
+DEFINE_STAT(STAT_A1H_InteractRequests);
+DEFINE_STAT(STAT_A1H_InteractRequestsRejected);
+
+CSV_DEFINE_CATEGORY(A1H, true);
+
+#pragma region Profiling
+#if A1H_WITH_PROFILING
+namespace A1HStats
+{
+    // Running totals since the last rate update. Interactions only happen on the game thread.
+    static uint32 WindowInteractions = 0;
+    static uint32 WindowTraceHits = 0;
+    static uint32 WindowInterfaceMisses = 0;
+    static float WindowSeconds = 0.0f;
+
+    // Lifetime totals of interaction RPCs. Also game thread only.
+    static uint64 TotalInteractRequestsAccepted = 0;
+    static uint64 TotalInteractRequestsRejected = 0;
+
+    void RecordInteractionTrace(bool bHit)
+    {
+        if (bHit)
+        {
+            INC_DWORD_STAT(STAT_A1H_InteractionTraceHits);
+            CSV_CUSTOM_STAT(A1H, InteractionTraceHits, 1, ECsvCustomStatOp::Accumulate);
+            ++WindowTraceHits;
+        }
+        else
+        {
+            INC_DWORD_STAT(STAT_A1H_InteractionTraceMisses);
+            CSV_CUSTOM_STAT(A1H, InteractionTraceMisses, 1, ECsvCustomStatOp::Accumulate);
+        }
+    }
+
+    void RecordInteractionDispatch(bool bDispatched)
+    {
+        if (bDispatched)
+        {
+            INC_DWORD_STAT(STAT_A1H_Interactions);
+            CSV_CUSTOM_STAT(A1H, Interactions, 1, ECsvCustomStatOp::Accumulate);
+            ++WindowInteractions;
+        }
+        else
+        {
+            INC_DWORD_STAT(STAT_A1H_InteractionInterfaceMisses);
+            CSV_CUSTOM_STAT(A1H, InteractionInterfaceMisses, 1, ECsvCustomStatOp::Accumulate);
+            ++WindowInterfaceMisses;
+        }
+    }
+
+    void RecordInteractRequest(bool bAccepted)
+    {
+        INC_DWORD_STAT(STAT_A1H_InteractRequests);
+        CSV_CUSTOM_STAT(A1H, InteractRequests, 1, ECsvCustomStatOp::Accumulate);
+        if (bAccepted)
+        {
+            ++TotalInteractRequestsAccepted;
+        }
+        else
+        {
+            INC_DWORD_STAT(STAT_A1H_InteractRequestsRejected);
+            CSV_CUSTOM_STAT(A1H, InteractRequestsRejected, 1, ECsvCustomStatOp::Accumulate);
+            ++TotalInteractRequestsRejected;
+        }
+    }
+
+    void GetInteractRequestTotals(uint64& OutAccepted, uint64& OutRejected)
+    {
+        OutAccepted = TotalInteractRequestsAccepted;
+        OutRejected = TotalInteractRequestsRejected;
+    }
+
+    void UpdateRates(float DeltaTime)
+    {
+        WindowSeconds += DeltaTime;
+        if (WindowSeconds < 1.0f)
+        {
+            return;
+        }
+
+        const float InteractionsPerSecond = WindowInteractions / WindowSeconds;
+        const float InterfaceMissRate = WindowTraceHits > 0 ? static_cast<float>(WindowInterfaceMisses) / WindowTraceHits : 0.0f;
+
+        SET_FLOAT_STAT(STAT_A1H_InteractionsPerSecond, InteractionsPerSecond);
+        SET_FLOAT_STAT(STAT_A1H_InterfaceMissRate, InterfaceMissRate);
+        CSV_CUSTOM_STAT(A1H, InteractionsPerSecond, InteractionsPerSecond, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(A1H, InterfaceMissRate, InterfaceMissRate, ECsvCustomStatOp::Set);
+
+        WindowInteractions = 0;
+        WindowTraceHits = 0;
+        WindowInterfaceMisses = 0;
+        WindowSeconds = 0.0f;
+    }
+}
+#endif
+
+#pragma endregion
+
+class FAssignment1HingedModule : public FDefaultGameModuleImpl
+{
+public:
+    virtual void StartupModule() override
+    {
+        // -A1HJournal=<Name> records from the very start
+        FA1H_EventJournal::StartFromCommandLine();
+
+#if A1H_WITH_PROFILING
+        // Rates are computed off a ticker so they decay to zero when nobody's interacting
+        StatsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float DeltaTime)
+        {
+            A1HStats::UpdateRates(DeltaTime);
+            return true;
+        }));
+#endif
+
+#if A1H_WITH_GAMEPLAY_DEBUGGER
+        // Shows up as "A1H" behind the apostrophe key
+        IGameplayDebugger& GameplayDebugger = IGameplayDebugger::Get();
+        GameplayDebugger.RegisterCategory("A1H", IGameplayDebugger::FOnGetCategory::CreateStatic(&FA1H_GameplayDebuggerCategory::MakeInstance),
+            EGameplayDebuggerCategoryState::EnabledInGameAndSimulate, 5);
+        GameplayDebugger.NotifyCategoriesChanged();
+#endif
+    }
+
+    virtual void ShutdownModule() override
+    {
+        FA1H_EventJournal::Shutdown();
+
+#if A1H_WITH_PROFILING
+        FTSTicker::GetCoreTicker().RemoveTicker(StatsTickerHandle);
+#endif
+
+#if A1H_WITH_GAMEPLAY_DEBUGGER
+        if (IGameplayDebugger::IsAvailable())
+        {
+            IGameplayDebugger& GameplayDebugger = IGameplayDebugger::Get();
+            GameplayDebugger.UnregisterCategory("A1H");
+            GameplayDebugger.NotifyCategoriesChanged();
+        }
+#endif
+    }
+
+private:
+    FTSTicker::FDelegateHandle StatsTickerHandle;
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FAssignment1HingedModule, Assignment1Hinged, "Assignment1Hinged" );
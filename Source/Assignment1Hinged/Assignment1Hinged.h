@@ -3,4 +3,83 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Logging/LogMacros.h"
+#include "HAL/LowLevelMemTracker.h"
 
+// Everything our own code logs goes here, so it can be filtered ("log LogA1H Verbose") without touching LogTemp
+DECLARE_LOG_CATEGORY_EXTERN(LogA1H, Log, All);
+
+#pragma region Memory Tracking
+// Low Level Memory tracker tags, so "-llm" captures (and stat LLMFULL) split out what our own systems allocate.
+// Everything lives under A1H. Wrap allocations with LLM_SCOPE_BYTAG(A1H_<System>).
+LLM_DECLARE_TAG_API(A1H, ASSIGNMENT1HINGED_API);
+LLM_DECLARE_TAG_API(A1H_Marionette, ASSIGNMENT1HINGED_API);     // Characters, controllers and their input state
+LLM_DECLARE_TAG_API(A1H_Animation, ASSIGNMENT1HINGED_API);      // Anim instances and the string rigs
+LLM_DECLARE_TAG_API(A1H_Interaction, ASSIGNMENT1HINGED_API);    // Interactable index, instanced interactables, dispatch cache
+LLM_DECLARE_TAG_API(A1H_Crowd, ASSIGNMENT1HINGED_API);          // Crowd agents and their instances
+LLM_DECLARE_TAG_API(A1H_Pooling, ASSIGNMENT1HINGED_API);        // Actor pools, including the pooled actors themselves
+LLM_DECLARE_TAG_API(A1H_Tools, ASSIGNMENT1HINGED_API);          // Journal, latency tracing and the other debug tools
+
+#pragma endregion
+
+#pragma region Profiling
+// All our profiling hooks compile out of Shipping builds
+#define A1H_WITH_PROFILING (!UE_BUILD_SHIPPING)
+
+// "stat A1H" shows everything our own gameplay code costs
+DECLARE_STATS_GROUP(TEXT("A1H"), STATGROUP_A1H, STATCAT_Advanced);
+
+// Interaction counters. These are bumped from several files, so they live here.
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interactions"), STAT_A1H_Interactions, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction Trace Hits"), STAT_A1H_InteractionTraceHits, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction Trace Misses"), STAT_A1H_InteractionTraceMisses, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction Interface Misses"), STAT_A1H_InteractionInterfaceMisses, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Interactions Per Second"), STAT_A1H_InteractionsPerSecond, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Interface Miss Rate"), STAT_A1H_InterfaceMissRate, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+
+// Server side interaction requests from clients (ServerRequestInteract)
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interact Requests"), STAT_A1H_InteractRequests, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interact Requests Rejected"), STAT_A1H_InteractRequestsRejected, STATGROUP_A1H, ASSIGNMENT1HINGED_API);
+
+// "-csvprofile" captures get an A1H category so long soak runs can be charted
+CSV_DECLARE_CATEGORY_EXTERN(A1H);
+
+#if A1H_WITH_PROFILING
+// One scope that shows up in "stat A1H", Unreal Insights and CSV captures. Keep it to one per line.
+#define A1H_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat); \
+	CSV_SCOPED_TIMING_STAT(A1H, Stat)
+
+namespace A1HStats
+{
+	// Called once per finished interaction trace (sync or async)
+	ASSIGNMENT1HINGED_API void RecordInteractionTrace(bool bHit);
+
+	// Called once per trace hit, with whether the hit actor actually took the interaction
+	ASSIGNMENT1HINGED_API void RecordInteractionDispatch(bool bDispatched);
+
+	// Called on the server once per interaction request RPC, with whether it passed the rate limit and aim check
+	ASSIGNMENT1HINGED_API void RecordInteractRequest(bool bAccepted);
+
+	// Requests seen since startup, for soak reports
+	ASSIGNMENT1HINGED_API void GetInteractRequestTotals(uint64& OutAccepted, uint64& OutRejected);
+
+	// Pushes the per-second rates into the stat system, driven by the module's ticker
+	void UpdateRates(float DeltaTime);
+}
+
+#define A1H_RECORD_INTERACTION_TRACE(bHit) A1HStats::RecordInteractionTrace(bHit)
+#define A1H_RECORD_INTERACTION_DISPATCH(bDispatched) A1HStats::RecordInteractionDispatch(bDispatched)
+#define A1H_RECORD_INTERACT_REQUEST(bAccepted) A1HStats::RecordInteractRequest(bAccepted)
+#else
+#define A1H_SCOPE_CYCLE_COUNTER(Stat)
+#define A1H_RECORD_INTERACTION_TRACE(bHit)
+#define A1H_RECORD_INTERACTION_DISPATCH(bDispatched)
+#define A1H_RECORD_INTERACT_REQUEST(bAccepted)
+#endif
+
+#pragma endregion
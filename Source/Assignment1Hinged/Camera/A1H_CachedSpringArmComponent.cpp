@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_CachedSpringArmComponent.h"
+#include "Assignment1Hinged.h"              // For STATGROUP_A1H and the profiling macros
+#include "GameFramework/Pawn.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spring Arm Probe"), STAT_A1H_SpringArmProbe, STATGROUP_A1H);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spring Arm Probes"), STAT_A1H_SpringArmProbes, STATGROUP_A1H);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spring Arm Probes Reused"), STAT_A1H_SpringArmProbesReused, STATGROUP_A1H);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spring Arm Probes Skipped (Not Viewed)"), STAT_A1H_SpringArmProbesSkipped, STATGROUP_A1H);
+
+void UA1H_CachedSpringArmComponent::UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime)
+{
+    // Nobody is looking through this camera, so where it would collide doesn't matter
+    if (bDoTrace)
+    {
+        const APawn* OwningPawn = Cast<APawn>(GetOwner());
+        if (OwningPawn && !OwningPawn->IsLocallyViewed())
+        {
+            INC_DWORD_STAT(STAT_A1H_SpringArmProbesSkipped);
+            bDoTrace = false;
+        }
+    }
+
+    if (!bDoTrace)
+    {
+        // Forget the cache so we probe straight away once someone does look through us
+        bHasProbe = false;
+        CurrentFraction = 1.0f;
+        Super::UpdateDesiredArmLocation(false, bDoLocationLag, bDoRotationLag, DeltaTime);
+        return;
+    }
+
+    SecondsSinceProbe += DeltaTime;
+    ++FramesSinceProbe;
+
+    // Same pose Super is about to use (before lag, which only ever trails it)
+    const FVector ArmOrigin = GetComponentLocation() + TargetOffset;
+    const FRotator ArmRotation = GetTargetRotation();
+
+    if (ShouldProbe(ArmOrigin, ArmRotation))
+    {
+        A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_SpringArmProbe);
+        INC_DWORD_STAT(STAT_A1H_SpringArmProbes);
+
+        Super::UpdateDesiredArmLocation(true, bDoLocationLag, bDoRotationLag, DeltaTime);
+
+        // Turn the result into a fraction along the arm so it can be reused while the arm stays put
+        const FVector SocketLocation = GetComponentTransform().TransformPosition(RelativeSocketLocation);
+        const float ArmLength = FVector::Dist(PreviousArmOrigin, UnfixedCameraPosition);
+        ProbedFraction = ArmLength > UE_KINDA_SMALL_NUMBER ? FMath::Clamp(FVector::Dist(PreviousArmOrigin, SocketLocation) / ArmLength, 0.0f, 1.0f) : 1.0f;
+
+        ProbedArmOrigin = ArmOrigin;
+        ProbedArmRotation = ArmRotation;
+        SecondsSinceProbe = 0.0f;
+        FramesSinceProbe = 0;
+        bHasProbe = true;
+
+        // Pulling in has to be instant or the camera clips into the wall. Only easing out is smoothed.
+        if (ProbedFraction < CurrentFraction)
+        {
+            CurrentFraction = ProbedFraction;
+            return;
+        }
+    }
+    else
+    {
+        INC_DWORD_STAT(STAT_A1H_SpringArmProbesReused);
+        Super::UpdateDesiredArmLocation(false, bDoLocationLag, bDoRotationLag, DeltaTime);
+    }
+
+    CurrentFraction = FMath::FInterpTo(CurrentFraction, ProbedFraction, DeltaTime, ExtendInterpSpeed);
+    ApplyArmFraction(CurrentFraction);
+}
+
+bool UA1H_CachedSpringArmComponent::ShouldProbe(const FVector& ArmOrigin, const FRotator& ArmRotation) const
+{
+    if (!bHasProbe || SecondsSinceProbe >= ReprobeInterval || FramesSinceProbe >= MaxReuseFrames)
+    {
+        return true;
+    }
+
+    return FVector::DistSquared(ArmOrigin, ProbedArmOrigin) > FMath::Square(PoseLocationTolerance)
+        || !ArmRotation.Equals(ProbedArmRotation, PoseRotationTolerance);
+}
+
+void UA1H_CachedSpringArmComponent::ApplyArmFraction(float ArmFraction)
+{
+    // Same as the tail of USpringArmComponent::UpdateDesiredArmLocation, just with our own result location
+    const FVector ResultLocation = PreviousArmOrigin + (UnfixedCameraPosition - PreviousArmOrigin) * ArmFraction;
+    bIsCameraFixed = ArmFraction < 1.0f;
+
+    const FTransform WorldCamTM(PreviousDesiredRot, ResultLocation);
+    const FTransform RelCamTM = WorldCamTM.GetRelativeTransform(GetComponentTransform());
+    RelativeSocketLocation = RelCamTM.GetLocation();
+    RelativeSocketRotation = RelCamTM.GetRotation();
+
+    UpdateChildTransforms();
+}
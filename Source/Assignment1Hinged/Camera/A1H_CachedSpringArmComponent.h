@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "A1H_CachedSpringArmComponent.generated.h"
+
+/**
+ * Spring arm that doesn't sweep for camera collision every single frame.
+ * - Pawns no local player is looking through never probe at all (nobody sees their camera).
+ * - While the arm's pose hasn't moved, the last probe's result is reused, with a refresh every
+ *   ReprobeInterval seconds (or MaxReuseFrames frames) so moving geometry is still noticed.
+ * - Getting pulled in by a hit is instant, easing back out between probes is interpolated.
+ */
+UCLASS(ClassGroup = Camera, meta = (BlueprintSpawnableComponent))
+class ASSIGNMENT1HINGED_API UA1H_CachedSpringArmComponent : public USpringArmComponent
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Probe Caching
+	// Arm origin movement (cm) below which the pose counts as unchanged
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Collision|Caching", meta = (ClampMin = "0.0"))
+	float PoseLocationTolerance = 1.0f;
+
+	// Arm rotation change (degrees) below which the pose counts as unchanged
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Collision|Caching", meta = (ClampMin = "0.0"))
+	float PoseRotationTolerance = 0.5f;
+
+	// While the pose is unchanged, probe again after this long anyway to catch geometry moving into the arm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Collision|Caching", meta = (ClampMin = "0.0"))
+	float ReprobeInterval = 0.25f;
+
+	// Hard cap on how many frames in a row a cached result is used
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Collision|Caching", meta = (ClampMin = "1"))
+	int32 MaxReuseFrames = 30;
+
+	// How fast the arm eases back out when a probe finds more room than before
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Collision|Caching", meta = (ClampMin = "0.0"))
+	float ExtendInterpSpeed = 10.0f;
+
+#pragma endregion
+
+protected:
+	virtual void UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime) override;
+
+private:
+	// Whether this frame needs a real sweep
+	bool ShouldProbe(const FVector& ArmOrigin, const FRotator& ArmRotation) const;
+
+	// Places the socket ArmFraction of the way from the arm origin to the unobstructed camera position
+	void ApplyArmFraction(float ArmFraction);
+
+	// Pose the last probe was taken at
+	FVector ProbedArmOrigin = FVector::ZeroVector;
+	FRotator ProbedArmRotation = FRotator::ZeroRotator;
+
+	// 0..1 along the arm: what the last probe found, and what we're currently showing
+	float ProbedFraction = 1.0f;
+	float CurrentFraction = 1.0f;
+
+	float SecondsSinceProbe = 0.0f;
+	int32 FramesSinceProbe = 0;
+	bool bHasProbe = false;
+};
@@ -0,0 +1,380 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_MarionetteCrowd.h"
+#include "AIController.h"
+#include "Assignment1Hinged.h"                          // For STATGROUP_A1H and the profiling macros
+#include "Async/ParallelFor.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Player/A1H_MarionetteCharacter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Tick"), STAT_A1H_CrowdTick, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Crowd Simulate"), STAT_A1H_CrowdSimulate, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Crowd Promotions"), STAT_A1H_CrowdPromotions, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Crowd Instance Update"), STAT_A1H_CrowdInstances, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Agents"), STAT_A1H_CrowdAgents, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Promoted"), STAT_A1H_CrowdPromoted, STATGROUP_A1H);
+
+namespace A1HCrowd
+{
+    // Agents are split into batches of this size for the parallel update
+    constexpr int32 SimulationBatchSize = 1024;
+
+    // Tiny xorshift so each agent can have its own RNG without sharing state across worker threads
+    FORCEINLINE uint32 NextRandom(uint32& State)
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        return State;
+    }
+
+    FORCEINLINE float NextRandomFloat(uint32& State)
+    {
+        return (NextRandom(State) & 0xFFFFFF) / static_cast<float>(0x1000000);
+    }
+}
+
+AA1H_MarionetteCrowd::AA1H_MarionetteCrowd()
+{
+    // Simulation and promotion run every frame
+    PrimaryActorTick.bCanEverTick = true;
+
+    AgentInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("AgentInstances"));
+    RootComponent = AgentInstances;
+    // Distant marionettes are just visuals, the promoted actors handle collision
+    AgentInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    AgentInstances->SetCanEverAffectNavigation(false);
+    AgentInstances->SetMobility(EComponentMobility::Movable);
+
+    // A plain AI controller is enough, DriveAgents does the steering
+    PromotedControllerClass = AAIController::StaticClass();
+}
+
+void AA1H_MarionetteCrowd::BeginPlay()
+{
+    LLM_SCOPE_BYTAG(A1H_Crowd);
+
+    Super::BeginPlay();
+
+    if (AgentMesh)
+    {
+        AgentInstances->SetStaticMesh(AgentMesh);
+    }
+
+    if (MarionetteClass)
+    {
+        if (const AA1H_MarionetteCharacter* MarionetteDefaults = MarionetteClass->GetDefaultObject<AA1H_MarionetteCharacter>())
+        {
+            MarionetteHalfHeight = MarionetteDefaults->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+        }
+    }
+
+    // Scatter agents evenly over the crowd disc
+    FRandomStream Layout(RandomSeed);
+    const FVector Centre = GetActorLocation();
+
+    Positions.SetNumUninitialized(AgentCount);
+    Velocities.SetNumZeroed(AgentCount);
+    Yaws.SetNumZeroed(AgentCount);
+    WanderTimers.SetNumZeroed(AgentCount);
+    RandomStates.SetNumUninitialized(AgentCount);
+    FocusDistancesSq.SetNumUninitialized(AgentCount);
+    PromotedFlags.SetNumZeroed(AgentCount);
+
+    for (int32 Index = 0; Index < AgentCount; ++Index)
+    {
+        const float Radius = CrowdRadius * FMath::Sqrt(Layout.FRand());
+        const float Angle = Layout.FRandRange(0.0f, UE_TWO_PI);
+        Positions[Index] = Centre + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.0f);
+        RandomStates[Index] = static_cast<uint32>(Layout.GetUnsignedInt()) | 1u; // xorshift state must not be 0
+        FocusDistancesSq[Index] = TNumericLimits<float>::Max();
+    }
+
+    // One instance per agent for the whole lifetime of the crowd, we only ever move them around
+    InstanceTransforms.SetNum(AgentCount);
+    AgentInstances->ClearInstances();
+    AgentInstances->AddInstances(InstanceTransforms, false, true);
+    UpdateInstances();
+
+    SET_DWORD_STAT(STAT_A1H_CrowdAgents, AgentCount);
+}
+
+void AA1H_MarionetteCrowd::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    for (const TPair<int32, TWeakObjectPtr<AA1H_MarionetteCharacter>>& Promoted : PromotedActors)
+    {
+        DestroyPromoted(Promoted.Value.Get());
+    }
+    PromotedActors.Reset();
+
+    SET_DWORD_STAT(STAT_A1H_CrowdAgents, 0);
+    SET_DWORD_STAT(STAT_A1H_CrowdPromoted, 0);
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AA1H_MarionetteCrowd::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_CrowdTick);
+
+    // Promoted agents are driven by their actors, so pull their positions back before measuring distances
+    for (const TPair<int32, TWeakObjectPtr<AA1H_MarionetteCharacter>>& Promoted : PromotedActors)
+    {
+        if (const AA1H_MarionetteCharacter* Marionette = Promoted.Value.Get())
+        {
+            Positions[Promoted.Key] = Marionette->GetActorLocation() - FVector(0.0f, 0.0f, MarionetteHalfHeight);
+        }
+    }
+
+    FocusLocations.Reset();
+    GatherFocusLocations(FocusLocations);
+
+    SimulateAgents(DeltaTime);
+    UpdatePromotions();
+    DriveAgents();
+    UpdateInstances();
+}
+
+#pragma region Simulation
+void AA1H_MarionetteCrowd::GatherFocusLocations(TArray<FVector>& OutFocusLocations) const
+{
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (PlayerController && PlayerController->GetPawn())
+        {
+            OutFocusLocations.Add(PlayerController->GetPawn()->GetActorLocation());
+        }
+    }
+}
+
+void AA1H_MarionetteCrowd::SimulateAgents(float DeltaTime)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_CrowdSimulate);
+
+    const FVector Centre = GetActorLocation();
+    const float RadiusSq = FMath::Square(CrowdRadius);
+    const int32 NumBatches = FMath::DivideAndRoundUp(Positions.Num(), A1HCrowd::SimulationBatchSize);
+
+    // Every agent only ever touches its own row, so batches can run on any thread in any order
+    ParallelFor(NumBatches, [&](int32 BatchIndex)
+    {
+        const int32 First = BatchIndex * A1HCrowd::SimulationBatchSize;
+        const int32 Last = FMath::Min(First + A1HCrowd::SimulationBatchSize, Positions.Num());
+
+        for (int32 Index = First; Index < Last; ++Index)
+        {
+            WanderTimers[Index] -= DeltaTime;
+
+            // Head back towards the middle if we've drifted out of the crowd area,
+            // otherwise pick a random new heading every few seconds.
+            // Promoted agents still choose headings here (DriveAgents hands them to the actor), they just don't move themselves.
+            const FVector ToCentre = Centre - Positions[Index];
+            if (FVector::DistSquaredXY(Positions[Index], Centre) > RadiusSq)
+            {
+                Velocities[Index] = ToCentre.GetSafeNormal2D() * WalkSpeed;
+                Yaws[Index] = Velocities[Index].Rotation().Yaw;
+                WanderTimers[Index] = 2.0f;
+            }
+            else if (WanderTimers[Index] <= 0.0f)
+            {
+                uint32& RandomState = RandomStates[Index];
+                const float Angle = A1HCrowd::NextRandomFloat(RandomState) * UE_TWO_PI;
+                const float Speed = A1HCrowd::NextRandomFloat(RandomState) < 0.3f ? 0.0f : WalkSpeed; // Some just stand around
+                Velocities[Index] = FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * Speed;
+                Yaws[Index] = FMath::RadiansToDegrees(Angle);
+                WanderTimers[Index] = 2.0f + A1HCrowd::NextRandomFloat(RandomState) * 6.0f;
+            }
+
+            if (!PromotedFlags[Index])
+            {
+                Positions[Index] += Velocities[Index] * DeltaTime;
+            }
+
+            float NearestSq = TNumericLimits<float>::Max();
+            for (const FVector& Focus : FocusLocations)
+            {
+                NearestSq = FMath::Min(NearestSq, static_cast<float>(FVector::DistSquared(Positions[Index], Focus)));
+            }
+            FocusDistancesSq[Index] = NearestSq;
+        }
+    });
+}
+
+void AA1H_MarionetteCrowd::UpdatePromotions()
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_CrowdPromotions);
+
+    if (!MarionetteClass)
+    {
+        return;
+    }
+
+    // Demote anything that wandered off (or whose actor got destroyed behind our back)
+    const float DemoteDistanceSq = FMath::Square(DemoteDistance);
+    TArray<int32, TInlineAllocator<16>> ToDemote;
+    for (const TPair<int32, TWeakObjectPtr<AA1H_MarionetteCharacter>>& Promoted : PromotedActors)
+    {
+        if (!Promoted.Value.IsValid() || FocusDistancesSq[Promoted.Key] > DemoteDistanceSq)
+        {
+            ToDemote.Add(Promoted.Key);
+        }
+    }
+    for (const int32 AgentIndex : ToDemote)
+    {
+        DemoteAgent(AgentIndex);
+    }
+
+    if (PromotedActors.Num() >= MaxPromoted)
+    {
+        return;
+    }
+
+    // Nearest agents inside the promotion radius get the free actor slots
+    const float PromoteDistanceSq = FMath::Square(PromoteDistance);
+    PromotionCandidates.Reset();
+    for (int32 Index = 0; Index < FocusDistancesSq.Num(); ++Index)
+    {
+        if (!PromotedFlags[Index] && FocusDistancesSq[Index] < PromoteDistanceSq)
+        {
+            PromotionCandidates.Add(Index);
+        }
+    }
+
+    PromotionCandidates.Sort([this](int32 A, int32 B) { return FocusDistancesSq[A] < FocusDistancesSq[B]; });
+
+    for (const int32 AgentIndex : PromotionCandidates)
+    {
+        if (PromotedActors.Num() >= MaxPromoted)
+        {
+            break;
+        }
+        PromoteAgent(AgentIndex);
+    }
+}
+
+void AA1H_MarionetteCrowd::PromoteAgent(int32 AgentIndex)
+{
+    // The promoted marionette's own allocations still go to A1H/Marionette
+    LLM_SCOPE_BYTAG(A1H_Crowd);
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+    const FVector SpawnLocation = Positions[AgentIndex] + FVector(0.0f, 0.0f, MarionetteHalfHeight);
+    const FRotator SpawnRotation(0.0f, Yaws[AgentIndex], 0.0f);
+
+    AA1H_MarionetteCharacter* Marionette = GetWorld()->SpawnActor<AA1H_MarionetteCharacter>(MarionetteClass, SpawnLocation, SpawnRotation, SpawnParams);
+    if (!Marionette)
+    {
+        return;
+    }
+
+    // Carry the crowd velocity over so promotion doesn't cause a visible stop
+    Marionette->GetCharacterMovement()->Velocity = Velocities[AgentIndex];
+
+    // Character movement only simulates for a controlled pawn, so give it a controller of its own to walk under
+    if (PromotedControllerClass)
+    {
+        Marionette->AIControllerClass = PromotedControllerClass;
+    }
+    Marionette->SpawnDefaultController();
+    if (!Marionette->GetController())
+    {
+        // No controller class anywhere, at least keep gravity and our movement input running
+        Marionette->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+    }
+
+    PromotedActors.Add(AgentIndex, Marionette);
+    PromotedFlags[AgentIndex] = 1;
+    INC_DWORD_STAT(STAT_A1H_CrowdPromoted);
+}
+
+void AA1H_MarionetteCrowd::DemoteAgent(int32 AgentIndex)
+{
+    TWeakObjectPtr<AA1H_MarionetteCharacter> Promoted;
+    if (!PromotedActors.RemoveAndCopyValue(AgentIndex, Promoted))
+    {
+        return;
+    }
+
+    if (AA1H_MarionetteCharacter* Marionette = Promoted.Get())
+    {
+        // Hand the actor's state back to the crowd arrays
+        Positions[AgentIndex] = Marionette->GetActorLocation() - FVector(0.0f, 0.0f, MarionetteHalfHeight);
+        Velocities[AgentIndex] = Marionette->GetVelocity() * FVector(1.0f, 1.0f, 0.0f);
+        Yaws[AgentIndex] = Marionette->GetActorRotation().Yaw;
+        DestroyPromoted(Marionette);
+    }
+
+    PromotedFlags[AgentIndex] = 0;
+    DEC_DWORD_STAT(STAT_A1H_CrowdPromoted);
+}
+
+void AA1H_MarionetteCrowd::DestroyPromoted(AA1H_MarionetteCharacter* Marionette)
+{
+    if (!Marionette)
+    {
+        return;
+    }
+
+    // The controller belongs to this promotion, don't leave it behind with nothing to possess
+    AController* Controller = Marionette->GetController();
+    Marionette->Destroy();
+    if (Controller && !Controller->IsA<APlayerController>())
+    {
+        Controller->Destroy();
+    }
+}
+
+void AA1H_MarionetteCrowd::DriveAgents()
+{
+    for (const TPair<int32, TWeakObjectPtr<AA1H_MarionetteCharacter>>& Promoted : PromotedActors)
+    {
+        AA1H_MarionetteCharacter* Marionette = Promoted.Value.Get();
+        const float Speed = Velocities[Promoted.Key].Size2D();
+        if (!Marionette || Speed <= UE_KINDA_SMALL_NUMBER)
+        {
+            continue;
+        }
+
+        // Scaled so the character ends up at the crowd's walk speed rather than its own max
+        const float MaxSpeed = FMath::Max(Marionette->GetCharacterMovement()->GetMaxSpeed(), 1.0f);
+        Marionette->AddMovementInput(Velocities[Promoted.Key] / Speed, FMath::Min(Speed / MaxSpeed, 1.0f));
+    }
+}
+
+void AA1H_MarionetteCrowd::UpdateInstances()
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_CrowdInstances);
+
+    if (InstanceTransforms.IsEmpty())
+    {
+        return;
+    }
+
+    ParallelFor(FMath::DivideAndRoundUp(InstanceTransforms.Num(), A1HCrowd::SimulationBatchSize), [this](int32 BatchIndex)
+    {
+        const int32 First = BatchIndex * A1HCrowd::SimulationBatchSize;
+        const int32 Last = FMath::Min(First + A1HCrowd::SimulationBatchSize, InstanceTransforms.Num());
+
+        for (int32 Index = First; Index < Last; ++Index)
+        {
+            // Promoted agents are drawn by their actor, so collapse their instance instead of removing it
+            const FVector Scale = PromotedFlags[Index] ? FVector::ZeroVector : FVector::OneVector;
+            InstanceTransforms[Index] = FTransform(FRotator(0.0f, Yaws[Index], 0.0f), Positions[Index], Scale);
+        }
+    });
+
+    AgentInstances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, false);
+}
+
+#pragma endregion
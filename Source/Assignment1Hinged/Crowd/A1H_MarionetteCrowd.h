@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "A1H_MarionetteCrowd.generated.h"
+
+class AA1H_MarionetteCharacter;
+class AController;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * Crowd mode for marionettes.
+ * Distant marionettes aren't actors at all - they're rows in a few flat arrays, simulated in parallel
+ * and drawn as instances of a single instanced static mesh. When one gets close to a player it's promoted
+ * to a real AA1H_MarionetteCharacter (with movement, camera rig and everything else) under an AI controller
+ * that keeps walking it along its crowd heading, and when it wanders far enough away again it's demoted back into the arrays.
+ * Drop one in the level and point it at the marionette Blueprint.
+ */
+UCLASS()
+class ASSIGNMENT1HINGED_API AA1H_MarionetteCrowd : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AA1H_MarionetteCrowd();
+
+	virtual void Tick(float DeltaTime) override;
+
+	// How many crowd agents are currently full actors
+	UFUNCTION(BlueprintPure, Category = "Crowd")
+	int32 GetNumPromoted() const { return PromotedActors.Num(); }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#pragma region Components
+	// Draws every agent that isn't a full actor right now
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	TObjectPtr<UInstancedStaticMeshComponent> AgentInstances;
+
+#pragma endregion
+
+#pragma region Crowd Settings
+	// Cheap stand-in mesh used for distant marionettes
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	TObjectPtr<UStaticMesh> AgentMesh;
+
+	// What an agent turns into when it's promoted
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	TSubclassOf<AA1H_MarionetteCharacter> MarionetteClass;
+
+	// Controller spawned for each promoted marionette. Without one its movement doesn't run and it freezes in place.
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	TSubclassOf<AController> PromotedControllerClass;
+
+	// Number of marionettes in the crowd
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0"))
+	int32 AgentCount = 10000;
+
+	// Agents spawn (and stay) within this radius of the crowd actor, on the plane of the crowd actor
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0.0"))
+	float CrowdRadius = 20000.0f;
+
+	// Wander speed of simulated agents
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0.0"))
+	float WalkSpeed = 150.0f;
+
+	// Agents closer than this to a player pawn become full actors.
+	// Keep it well above the character's InteractionDistance so anything a player can interact with is already a real actor.
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0.0"))
+	float PromoteDistance = 1500.0f;
+
+	// Promoted agents further than this go back into the crowd. Bigger than PromoteDistance so they don't flicker.
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0.0"))
+	float DemoteDistance = 2000.0f;
+
+	// Hard cap on full actors at once, nearest agents win
+	UPROPERTY(EditAnywhere, Category = "Crowd", meta = (ClampMin = "0"))
+	int32 MaxPromoted = 32;
+
+	// Seed for the initial layout and wandering, so runs are repeatable
+	UPROPERTY(EditAnywhere, Category = "Crowd")
+	int32 RandomSeed = 1337;
+
+#pragma endregion
+
+private:
+#pragma region Simulation
+	// Moves every non-promoted agent and works out how far each one is from the nearest player
+	void SimulateAgents(float DeltaTime);
+
+	// Promotes/demotes agents based on the distances SimulateAgents just computed
+	void UpdatePromotions();
+
+	void PromoteAgent(int32 AgentIndex);
+	void DemoteAgent(int32 AgentIndex);
+
+	// Destroys a promoted marionette along with the controller we gave it
+	static void DestroyPromoted(AA1H_MarionetteCharacter* Marionette);
+
+	// Keeps promoted marionettes walking along the heading their crowd row still picks for them
+	void DriveAgents();
+
+	// Pushes agent transforms to the instanced mesh (promoted agents are collapsed to zero scale)
+	void UpdateInstances();
+
+	// Where the players are, which is what promotion is measured against
+	void GatherFocusLocations(TArray<FVector>& OutFocusLocations) const;
+
+#pragma endregion
+
+	// Structure of arrays - one entry per agent, same index in every array
+	TArray<FVector> Positions;          // On the ground (feet), not capsule centre
+	TArray<FVector> Velocities;         // Horizontal only
+	TArray<float> Yaws;                 // Facing, kept when the agent stops
+	TArray<float> WanderTimers;         // Seconds until the agent picks a new heading
+	TArray<uint32> RandomStates;        // Per-agent RNG state so the parallel update doesn't share a stream
+	TArray<float> FocusDistancesSq;     // Squared distance to the nearest player, refreshed every tick
+	TArray<uint8> PromotedFlags;        // 1 while the agent is a full actor
+
+	// Agent index -> actor standing in for it
+	TMap<int32, TWeakObjectPtr<AA1H_MarionetteCharacter>> PromotedActors;
+
+	// Scratch buffers reused every tick
+	TArray<FVector> FocusLocations;     // Player pawn locations, filled by GatherFocusLocations
+	TArray<FTransform> InstanceTransforms;
+	TArray<int32> PromotionCandidates;
+
+	// Capsule half height of MarionetteClass, used to convert between feet and actor location
+	float MarionetteHalfHeight = 88.0f;
+};
@@ -0,0 +1,368 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_ActorPoolBenchmark.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Assignment1Hinged.h"                  // For LogA1H
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "InputActionValue.h"
+#include "Interaction/A1H_SpawningInteractable.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+#include "Pooling/A1H_ActorPoolSubsystem.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace A1HActorPoolBenchmark
+{
+    // Whether each phase goes through the pool. Spawn/destroy, pool, pool, spawn/destroy, so neither mode always
+    // gets the warmer slot and each is averaged over an early and a late phase.
+    static const bool PhasePooled[] = { false, true, true, false };
+    constexpr int32 NumPhases = UE_ARRAY_COUNT(PhasePooled);
+
+    // Frames thrown away at the start of each phase, same as the marionette benchmark
+    constexpr int32 WarmupFrames = 5;
+
+    // How far in front of the marionette the interactable sits, well inside InteractionDistance
+    constexpr float InteractableDistance = 150.0f;
+
+    // Short, so the spawned actors turn over quickly and the pool reaches its steady state early on
+    constexpr float SpawnedLifetime = 0.25f;
+
+    static double CyclesToUs(uint64 Cycles, int64 Calls)
+    {
+        return Calls > 0 ? FPlatformTime::ToMilliseconds64(Cycles) * 1000.0 / static_cast<double>(Calls) : 0.0;
+    }
+
+    static void RunBenchmarkCommand(const TArray<FString>& Args, UWorld* World)
+    {
+        int32 InteractionsPerFrame = 8;
+        int32 FramesPerPhase = 600;
+        int32 GCIntervalFrames = 60;
+        UClass* ActorClass = AStaticMeshActor::StaticClass();
+        bool bQuitWhenDone = false;
+
+        TArray<FString> Positional;
+        FA1H_HeadlessHarness::ParseArgs(Args, Positional, bQuitWhenDone);
+
+        if (Positional.IsValidIndex(0))
+        {
+            InteractionsPerFrame = FMath::Max(1, FCString::Atoi(*Positional[0]));
+        }
+        if (Positional.IsValidIndex(1))
+        {
+            FramesPerPhase = FMath::Max(1, FCString::Atoi(*Positional[1]));
+        }
+        if (Positional.IsValidIndex(2))
+        {
+            GCIntervalFrames = FMath::Max(1, FCString::Atoi(*Positional[2]));
+        }
+        if (Positional.IsValidIndex(3))
+        {
+            UClass* RequestedClass = LoadClass<AActor>(nullptr, *Positional[3]);
+            if (!RequestedClass)
+            {
+                UE_LOG(LogA1H, Warning, TEXT("A1H.Benchmark.ActorPool: %s isn't an actor class."), *Positional[3]);
+                return;
+            }
+            ActorClass = RequestedClass;
+        }
+
+        FA1H_ActorPoolBenchmark::Start(World, InteractionsPerFrame, FramesPerPhase, GCIntervalFrames, ActorClass, bQuitWhenDone);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+        TEXT("A1H.Benchmark.ActorPool"),
+        TEXT("Spams HandleInteract on an interactable that spawns actors, alternating spawning/destroying them with pooling them, and writes interaction cost and GC time to Saved/Profiling/A1H.\n")
+        TEXT("Fails (exit code 1 with quit) unless pooling is cheaper on both.\n")
+        TEXT("Usage: A1H.Benchmark.ActorPool [InteractionsPerFrame=8] [FramesPerPhase=600] [GCIntervalFrames=60] [ActorClass=/Script/Engine.StaticMeshActor] [quit]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmarkCommand));
+}
+
+#pragma region Lifetime
+void FA1H_ActorPoolBenchmark::Start(UWorld* World, int32 InteractionsPerFrame, int32 FramesPerPhase, int32 GCIntervalFrames, UClass* ActorClass, bool bQuitWhenDone)
+{
+    FA1H_HeadlessHarness::Start(TUniquePtr<FA1H_HeadlessHarness>(new FA1H_ActorPoolBenchmark(World, InteractionsPerFrame, FramesPerPhase, GCIntervalFrames, ActorClass, bQuitWhenDone)));
+}
+
+FA1H_ActorPoolBenchmark::FA1H_ActorPoolBenchmark(UWorld* InWorld, int32 InInteractionsPerFrame, int32 InFramesPerPhase, int32 InGCIntervalFrames, UClass* InActorClass, bool bInQuitWhenDone)
+    : FA1H_HeadlessHarness(InWorld, TEXT("A1H actor pool benchmark"), bInQuitWhenDone)
+    , InteractionsPerFrame(InInteractionsPerFrame)
+    , FramesPerPhase(InFramesPerPhase)
+    , GCIntervalFrames(InGCIntervalFrames)
+    , ActorClass(InActorClass)
+{
+}
+
+FA1H_ActorPoolBenchmark::~FA1H_ActorPoolBenchmark()
+{
+    // The marionette goes with the harness, the interactable is ours
+    if (Interactable.IsValid())
+    {
+        Interactable->Destroy();
+    }
+}
+
+bool FA1H_ActorPoolBenchmark::BeginRun()
+{
+    UWorld* BenchWorld = World.Get();
+    if (!BenchWorld->GetSubsystem<UA1H_ActorPoolSubsystem>())
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H actor pool benchmark: this world has no actor pool (game and PIE worlds only)."));
+        return false;
+    }
+
+    if (Marionettes.Spawn(BenchWorld, 1) == 0)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H actor pool benchmark: couldn't spawn the marionette."));
+        return false;
+    }
+
+    // Look straight ahead (+X), which is where the interactable goes
+    GetController()->SetControlRotation(FRotator::ZeroRotator);
+    return BeginNextPhase();
+}
+
+AA1H_MarionetteController* FA1H_ActorPoolBenchmark::GetController() const
+{
+    return Marionettes.Controllers.IsEmpty() ? nullptr : Marionettes.Controllers[0].Get();
+}
+
+#pragma endregion
+
+#pragma region Phases
+bool FA1H_ActorPoolBenchmark::BeginNextPhase()
+{
+    UWorld* BenchWorld = World.Get();
+    AA1H_MarionetteCharacter* Character = Marionettes.Characters.IsEmpty() ? nullptr : Marionettes.Characters[0].Get();
+    if (!BenchWorld || !Character || ++PhaseIndex >= A1HActorPoolBenchmark::NumPhases)
+    {
+        return false;
+    }
+
+    FrameIndex = 0;
+    InteractCycles = 0;
+    InteractCalls = 0;
+    FrameTimesMs.Reset(FramesPerPhase);
+    GCTimesMs.Reset();
+
+    const bool bPooled = A1HActorPoolBenchmark::PhasePooled[PhaseIndex];
+
+    // A fresh interactable per phase, attached to the marionette so it stays in the trace even if the marionette falls
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    AA1H_SpawningInteractable* NewInteractable = BenchWorld->SpawnActor<AA1H_SpawningInteractable>(AA1H_SpawningInteractable::StaticClass(), FTransform::Identity, SpawnParams);
+    if (!NewInteractable)
+    {
+        return false;
+    }
+
+    NewInteractable->SpawnedClass = ActorClass.Get();
+    NewInteractable->SpawnedLifetime = A1HActorPoolBenchmark::SpawnedLifetime;
+    NewInteractable->bUseActorPool = bPooled;
+    NewInteractable->AttachToActor(Character, FAttachmentTransformRules::KeepRelativeTransform);
+    NewInteractable->SetActorRelativeLocation(FVector(A1HActorPoolBenchmark::InteractableDistance, 0.0f, 0.0f));
+    Interactable = NewInteractable;
+
+    // Prewarm about as many as will be alive at once at 60 fps, like PrewarmPools would at map load
+    if (bPooled)
+    {
+        if (UA1H_ActorPoolSubsystem* ActorPool = BenchWorld->GetSubsystem<UA1H_ActorPoolSubsystem>())
+        {
+            ActorPool->Prewarm(ActorClass.Get(), InteractionsPerFrame * FMath::CeilToInt32(A1HActorPoolBenchmark::SpawnedLifetime * 60.0f));
+        }
+    }
+
+    UE_LOG(LogA1H, Log, TEXT("A1H actor pool benchmark: %s, %d interactions per frame for %d frames."),
+        bPooled ? TEXT("pooled") : TEXT("spawn/destroy"), InteractionsPerFrame, FramesPerPhase);
+    return true;
+}
+
+bool FA1H_ActorPoolBenchmark::TickRun(float DeltaTime)
+{
+    if (!GetController() || !Interactable.IsValid())
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H actor pool benchmark: marionette or interactable went away, aborting."));
+        SetFailed();
+        return false;
+    }
+
+    ++FrameIndex;
+    const bool bMeasure = FrameIndex > A1HActorPoolBenchmark::WarmupFrames;
+    if (bMeasure)
+    {
+        // Real time between engine frames, so it includes the spawn/destroy work and the GC below
+        FrameTimesMs.Add(DeltaTime * 1000.0);
+    }
+
+    DriveInteractions();
+
+    if (bMeasure && FrameIndex % GCIntervalFrames == 0)
+    {
+        CollectGarbageTimed();
+    }
+
+    if (FrameIndex < FramesPerPhase + A1HActorPoolBenchmark::WarmupFrames)
+    {
+        return true;
+    }
+
+    FinishPhase();
+    if (BeginNextPhase())
+    {
+        return true;
+    }
+
+    const bool bPoolingCheaper = ComparePhases();
+    if (!bPoolingCheaper)
+    {
+        SetFailed();
+    }
+
+    WriteResults(bPoolingCheaper);
+    return false;
+}
+
+void FA1H_ActorPoolBenchmark::DriveInteractions()
+{
+    AA1H_MarionetteController* Controller = GetController();
+    const FInputActionValue PressedValue(true);
+
+    // HandleInteract only queues the press, ApplyFrameInput runs the trace and the interaction for each of them
+    const uint64 Start = FPlatformTime::Cycles64();
+    for (int32 Index = 0; Index < InteractionsPerFrame; ++Index)
+    {
+        Controller->HandleInteract(PressedValue);
+    }
+    Controller->ApplyFrameInput();
+
+    if (FrameIndex > A1HActorPoolBenchmark::WarmupFrames)
+    {
+        InteractCycles += FPlatformTime::Cycles64() - Start;
+        InteractCalls += InteractionsPerFrame;
+    }
+}
+
+void FA1H_ActorPoolBenchmark::CollectGarbageTimed()
+{
+    const uint64 Start = FPlatformTime::Cycles64();
+    CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, /*bPerformFullPurge*/ true);
+    GCTimesMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Start));
+}
+
+void FA1H_ActorPoolBenchmark::FinishPhase()
+{
+    FPhaseResult& Result = Results.AddDefaulted_GetRef();
+    Result.bPooled = Interactable->bUseActorPool;
+    Result.Frames = FrameTimesMs.Num();
+    Result.Interactions = InteractCalls;
+    Result.InteractUs = A1HActorPoolBenchmark::CyclesToUs(InteractCycles, InteractCalls);
+
+    Summarize(FrameTimesMs, Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs);
+
+    double P95GCMs = 0.0;
+    Result.GCRuns = GCTimesMs.Num();
+    Summarize(GCTimesMs, Result.AvgGCMs, P95GCMs, Result.MaxGCMs);
+
+    if (Result.bPooled)
+    {
+        if (const UA1H_ActorPoolSubsystem* ActorPool = World->GetSubsystem<UA1H_ActorPoolSubsystem>())
+        {
+            const FA1H_ActorPoolStats Stats = ActorPool->GetPoolStats(ActorClass.Get());
+            Result.PoolHitRate = Stats.GetHitRate();
+            Result.PoolPeakSize = Stats.PeakSize;
+        }
+    }
+
+    UE_LOG(LogA1H, Log, TEXT("A1H actor pool benchmark: %s interact=%.3fus frame avg=%.2fms p95=%.2fms max=%.2fms gc avg=%.2fms max=%.2fms (%d runs) pool hit=%.1f%% peak=%d"),
+        Result.bPooled ? TEXT("pooled") : TEXT("spawn/destroy"), Result.InteractUs, Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs,
+        Result.AvgGCMs, Result.MaxGCMs, Result.GCRuns, Result.PoolHitRate * 100.0f, Result.PoolPeakSize);
+
+    // EndPlay retires whatever it still has out, then start the next phase from a clean heap
+    Interactable->Destroy();
+    Interactable.Reset();
+    CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, /*bPerformFullPurge*/ true);
+}
+
+bool FA1H_ActorPoolBenchmark::ComparePhases() const
+{
+    // Average each mode over its phases
+    double InteractUs[2] = {};
+    double GCMs[2] = {};
+    int32 Phases[2] = {};
+    for (const FPhaseResult& Result : Results)
+    {
+        const int32 Mode = Result.bPooled ? 1 : 0;
+        InteractUs[Mode] += Result.InteractUs;
+        GCMs[Mode] += Result.AvgGCMs;
+        ++Phases[Mode];
+    }
+
+    if (Phases[0] == 0 || Phases[1] == 0)
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H actor pool benchmark: didn't get through both modes, nothing to compare."));
+        return false;
+    }
+
+    for (int32 Mode = 0; Mode < 2; ++Mode)
+    {
+        InteractUs[Mode] /= Phases[Mode];
+        GCMs[Mode] /= Phases[Mode];
+    }
+
+    // Both are what pooling is for: no spawn per interaction, and no dead actors for the collector to purge
+    const bool bInteractCheaper = InteractUs[1] < InteractUs[0];
+    const bool bGCCheaper = GCMs[1] < GCMs[0];
+
+    UE_LOG(LogA1H, Log, TEXT("A1H actor pool benchmark: interact %.3fus pooled vs %.3fus spawn/destroy, gc %.2fms pooled vs %.2fms spawn/destroy."),
+        InteractUs[1], InteractUs[0], GCMs[1], GCMs[0]);
+
+    if (!bInteractCheaper)
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H actor pool benchmark: pooled interactions aren't cheaper than spawning and destroying."));
+    }
+    if (!bGCCheaper)
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H actor pool benchmark: garbage collection isn't cheaper with pooling."));
+    }
+
+    return bInteractCheaper && bGCCheaper;
+}
+
+#pragma endregion
+
+#pragma region Output
+void FA1H_ActorPoolBenchmark::WriteResults(bool bPoolingCheaper) const
+{
+    FString Csv = TEXT("Mode,Frames,Interactions,InteractUs,AvgFrameMs,P95FrameMs,MaxFrameMs,GCRuns,AvgGCMs,MaxGCMs,PoolHitRate,PoolPeakSize\n");
+    FString Json = FString::Printf(TEXT("{\n  \"actor_class\": \"%s\",\n  \"interactions_per_frame\": %d,\n  \"pooling_cheaper\": %s,\n  \"phases\": [\n"),
+        ActorClass.IsValid() ? *ActorClass->GetPathName() : TEXT(""), InteractionsPerFrame, bPoolingCheaper ? TEXT("true") : TEXT("false"));
+
+    for (int32 Index = 0; Index < Results.Num(); ++Index)
+    {
+        const FPhaseResult& Result = Results[Index];
+        const TCHAR* Mode = Result.bPooled ? TEXT("pooled") : TEXT("spawn_destroy");
+
+        Csv += FString::Printf(TEXT("%s,%d,%lld,%.4f,%.4f,%.4f,%.4f,%d,%.4f,%.4f,%.4f,%d\n"),
+            Mode, Result.Frames, Result.Interactions, Result.InteractUs, Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs,
+            Result.GCRuns, Result.AvgGCMs, Result.MaxGCMs, Result.PoolHitRate, Result.PoolPeakSize);
+
+        Json += FString::Printf(
+            TEXT("    { \"mode\": \"%s\", \"frames\": %d, \"interactions\": %lld, \"interact_us\": %.4f, \"avg_frame_ms\": %.4f, \"p95_frame_ms\": %.4f, \"max_frame_ms\": %.4f, \"gc_runs\": %d, \"avg_gc_ms\": %.4f, \"max_gc_ms\": %.4f, \"pool_hit_rate\": %.4f, \"pool_peak_size\": %d }%s\n"),
+            Mode, Result.Frames, Result.Interactions, Result.InteractUs, Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs,
+            Result.GCRuns, Result.AvgGCMs, Result.MaxGCMs, Result.PoolHitRate, Result.PoolPeakSize,
+            Index + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+    }
+
+    Json += TEXT("  ]\n}\n");
+
+    WriteReport(TEXT("ActorPoolBenchmark"), Csv, Json);
+}
+
+#pragma endregion
+
+#endif // !UE_BUILD_SHIPPING
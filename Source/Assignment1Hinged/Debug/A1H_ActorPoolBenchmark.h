@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/A1H_HeadlessHarness.h"
+
+#if !UE_BUILD_SHIPPING
+
+class AA1H_MarionetteController;
+class AA1H_SpawningInteractable;
+
+/**
+ * Headless benchmark for UA1H_ActorPoolSubsystem under interaction spam.
+ * Spawns one marionette with an AA1H_SpawningInteractable right in front of it and calls HandleInteract
+ * K times a frame, so every frame spawns K short-lived actors and retires K older ones. It runs four phases,
+ * spawning and destroying (the old Blueprint pattern) in the first and last and recycling through the actor pool
+ * in the two between, so warm-up favours neither. Every GCIntervalFrames a full garbage collection is forced and timed.
+ * Per phase it records the cost of one interaction (trace + dispatch + spawn or acquire), frame time,
+ * GC time and the pool's hit rate and peak size, and writes them to Saved/Profiling/A1H as CSV and JSON.
+ *
+ * Unless pooling comes out cheaper on both interaction cost and GC time (averaged per mode) it logs an error and,
+ * with "quit", exits with code 1, so a CI run fails.
+ *
+ * Usage (e.g. -nullrhi -unattended -ExecCmds="A1H.Benchmark.ActorPool 8 600 60 quit"):
+ *   A1H.Benchmark.ActorPool [InteractionsPerFrame=8] [FramesPerPhase=600] [GCIntervalFrames=60] [ActorClass=/Script/Engine.StaticMeshActor] [quit]
+ */
+class FA1H_ActorPoolBenchmark : public FA1H_HeadlessHarness
+{
+public:
+	// Kicks off a benchmark in World. Only one headless run can go at a time.
+	static void Start(UWorld* World, int32 InteractionsPerFrame, int32 FramesPerPhase, int32 GCIntervalFrames, UClass* ActorClass, bool bQuitWhenDone);
+
+	virtual ~FA1H_ActorPoolBenchmark() override;
+
+private:
+	// Results for one phase
+	struct FPhaseResult
+	{
+		bool bPooled = false;
+		int32 Frames = 0;
+		int64 Interactions = 0;
+
+		// Average cost of one HandleInteract and the interaction it causes, in microseconds
+		double InteractUs = 0.0;
+
+		// Game frame time, in milliseconds
+		double AvgFrameMs = 0.0;
+		double P95FrameMs = 0.0;
+		double MaxFrameMs = 0.0;
+
+		// Forced full collections, in milliseconds
+		int32 GCRuns = 0;
+		double AvgGCMs = 0.0;
+		double MaxGCMs = 0.0;
+
+		// Only meaningful for the pooled phase
+		float PoolHitRate = 0.0f;
+		int32 PoolPeakSize = 0;
+	};
+
+	FA1H_ActorPoolBenchmark(UWorld* InWorld, int32 InInteractionsPerFrame, int32 InFramesPerPhase, int32 InGCIntervalFrames, UClass* InActorClass, bool bInQuitWhenDone);
+
+	virtual bool BeginRun() override;
+	virtual bool TickRun(float DeltaTime) override;
+
+	// The one marionette doing the interacting
+	AA1H_MarionetteController* GetController() const;
+
+	// Sets up the interactable for the next phase, returns false if there's nothing left to run
+	bool BeginNextPhase();
+
+	// Interaction spam for one frame, timed
+	void DriveInteractions();
+
+	// Full GC, timed
+	void CollectGarbageTimed();
+
+	void FinishPhase();
+
+	// True if the pooled phases beat the spawn/destroy ones on interaction cost and GC time
+	bool ComparePhases() const;
+
+	void WriteResults(bool bPoolingCheaper) const;
+
+	int32 InteractionsPerFrame = 8;
+	int32 FramesPerPhase = 600;
+	int32 GCIntervalFrames = 60;
+	TWeakObjectPtr<UClass> ActorClass;
+
+	TWeakObjectPtr<AA1H_SpawningInteractable> Interactable;
+
+	// Per-phase accumulators
+	int32 PhaseIndex = INDEX_NONE;
+	int32 FrameIndex = 0;
+	uint64 InteractCycles = 0;
+	int64 InteractCalls = 0;
+	TArray<double> FrameTimesMs;
+	TArray<double> GCTimesMs;
+
+	TArray<FPhaseResult> Results;
+};
+
+#endif // !UE_BUILD_SHIPPING
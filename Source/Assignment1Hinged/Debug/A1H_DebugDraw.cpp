@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_DebugDraw.h"
+
+#if A1H_WITH_DEBUG_DRAW
+
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+namespace A1HDebugDraw
+{
+    bool bDrawInteraction = false;
+
+    static FAutoConsoleVariableRef CVarDrawInteraction(
+        TEXT("A1H.Debug.DrawInteraction"),
+        bDrawInteraction,
+        TEXT("Draws every interaction trace (green hit, red miss)."),
+        ECVF_Cheat);
+
+    void InteractionTrace(const UWorld* World, const FVector& Start, const FVector& End, bool bHit)
+    {
+        DrawDebugLine(World, Start, End, bHit ? FColor::Green : FColor::Red, false, 2.0f, 0, 1.0f);
+    }
+}
+
+#endif // A1H_WITH_DEBUG_DRAW
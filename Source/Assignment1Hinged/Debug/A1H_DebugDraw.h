@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+// Debug drawing compiles out of Shipping (and anything built without debug draw), and is off until asked for
+#define A1H_WITH_DEBUG_DRAW (ENABLE_DRAW_DEBUG && !UE_BUILD_SHIPPING)
+
+#if A1H_WITH_DEBUG_DRAW
+namespace A1HDebugDraw
+{
+	// A1H.Debug.DrawInteraction
+	ASSIGNMENT1HINGED_API extern bool bDrawInteraction;
+
+	// Green for a hit, red for a miss, kept on screen for a couple of seconds
+	ASSIGNMENT1HINGED_API void InteractionTrace(const UWorld* World, const FVector& Start, const FVector& End, bool bHit);
+}
+
+#define A1H_DRAW_INTERACTION_TRACE(World, Start, End, bHit) \
+	if (A1HDebugDraw::bDrawInteraction) { A1HDebugDraw::InteractionTrace(World, Start, End, bHit); }
+#else
+#define A1H_DRAW_INTERACTION_TRACE(World, Start, End, bHit)
+#endif
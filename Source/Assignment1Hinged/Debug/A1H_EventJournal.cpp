@@ -0,0 +1,444 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_EventJournal.h"
+#include "Assignment1Hinged.h"                  // For LogA1H
+#include "Algo/StableSort.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+std::atomic<bool> FA1H_EventJournal::bRecording{ false };
+
+namespace A1HJournal
+{
+    constexpr uint32 FileMagic = 0x4A483141;    // "A1HJ"
+    constexpr uint32 FileVersion = 1;
+
+    // Records per thread, has to be a power of two. 128 KB each, and only threads that record get one.
+    constexpr uint32 RingCapacity = 4096;
+
+    // How often the writer drains the rings
+    constexpr uint32 FlushIntervalMs = 100;
+
+    struct FFileHeader
+    {
+        uint32 Magic = FileMagic;
+        uint32 Version = FileVersion;
+        uint32 RecordSize = sizeof(FA1H_JournalRecord);
+        uint64 StartCycles = 0;
+        double SecondsPerCycle = 0.0;
+
+        friend FArchive& operator<<(FArchive& Ar, FFileHeader& Header)
+        {
+            return Ar << Header.Magic << Header.Version << Header.RecordSize << Header.StartCycles << Header.SecondsPerCycle;
+        }
+    };
+
+    // Single producer (the owning thread), single consumer (the writer). Head and Tail only ever count up.
+    struct FThreadRing
+    {
+        FA1H_JournalRecord Records[RingCapacity];
+        std::atomic<uint32> Head{ 0 };
+        std::atomic<uint32> Tail{ 0 };
+        uint32 ThreadId = 0;
+    };
+
+    // Only taken when a thread records for the first time, and by the writer while it drains
+    static FCriticalSection RingsLock;
+    static TArray<TUniquePtr<FThreadRing>> Rings;
+    static thread_local FThreadRing* LocalRing = nullptr;
+
+    static std::atomic<uint64> DroppedRecords{ 0 };
+
+    static FThreadRing& GetLocalRing()
+    {
+        if (!LocalRing)
+        {
+            LLM_SCOPE_BYTAG(A1H_Tools);
+            TUniquePtr<FThreadRing> NewRing = MakeUnique<FThreadRing>();
+            NewRing->ThreadId = FPlatformTLS::GetCurrentThreadId();
+            LocalRing = NewRing.Get();
+
+            FScopeLock Lock(&RingsLock);
+            Rings.Add(MoveTemp(NewRing));
+        }
+        return *LocalRing;
+    }
+
+    // Drains the rings into the file in blocks of [uint32 Count][Count records]. Closing writes a zero count,
+    // then the name table [int32 Num][uint32 Id, FString Name]... and the dropped record count.
+    class FWriter : public FRunnable
+    {
+    public:
+        explicit FWriter(TUniquePtr<FArchive> InFile)
+            : File(MoveTemp(InFile))
+            , WakeEvent(FPlatformProcess::GetSynchEventFromPool())
+        {
+        }
+
+        virtual ~FWriter() override
+        {
+            FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+        }
+
+        virtual uint32 Run() override
+        {
+            while (!bStopRequested.load(std::memory_order_acquire))
+            {
+                WakeEvent->Wait(FlushIntervalMs);
+                Drain();
+            }
+            return 0;
+        }
+
+        virtual void Stop() override
+        {
+            bStopRequested.store(true, std::memory_order_release);
+            WakeEvent->Trigger();
+        }
+
+        // Once the thread is gone: picks up the stragglers and writes the trailer
+        uint64 Finish()
+        {
+            Drain();
+
+            uint32 EndOfRecords = 0;
+            *File << EndOfRecords;
+
+            int32 NumNames = SubjectNames.Num();
+            *File << NumNames;
+            for (uint32 NameId : SubjectNames)
+            {
+                FString Name = FName::CreateFromDisplayId(FNameEntryId::FromUnstableInt(NameId), NAME_NO_NUMBER_INTERNAL).ToString();
+                *File << NameId << Name;
+            }
+
+            uint64 Dropped = DroppedRecords.load(std::memory_order_relaxed);
+            *File << Dropped;
+
+            File->Close();
+            File.Reset();
+            return RecordsWritten;
+        }
+
+    private:
+        void Drain()
+        {
+            Scratch.Reset();
+            {
+                FScopeLock Lock(&RingsLock);
+                for (const TUniquePtr<FThreadRing>& Ring : Rings)
+                {
+                    const uint32 Tail = Ring->Tail.load(std::memory_order_relaxed);
+                    const uint32 Head = Ring->Head.load(std::memory_order_acquire);
+                    for (uint32 Index = Tail; Index != Head; ++Index)
+                    {
+                        Scratch.Add(Ring->Records[Index & (RingCapacity - 1)]);
+                    }
+                    Ring->Tail.store(Head, std::memory_order_release);
+                }
+            }
+
+            if (Scratch.IsEmpty())
+            {
+                return;
+            }
+
+            for (const FA1H_JournalRecord& Record : Scratch)
+            {
+                if (Record.SubjectName != 0)
+                {
+                    SubjectNames.Add(Record.SubjectName);
+                }
+            }
+
+            uint32 Count = Scratch.Num();
+            *File << Count;
+            File->Serialize(Scratch.GetData(), Scratch.Num() * sizeof(FA1H_JournalRecord));
+            RecordsWritten += Count;
+        }
+
+        TUniquePtr<FArchive> File;
+        FEvent* WakeEvent = nullptr;
+        std::atomic<bool> bStopRequested{ false };
+
+        TArray<FA1H_JournalRecord> Scratch;
+        TSet<uint32> SubjectNames;
+        uint64 RecordsWritten = 0;
+    };
+
+    // Game thread only
+    static TUniquePtr<FWriter> Writer;
+    static FRunnableThread* WriterThread = nullptr;
+    static FString JournalPath;
+}
+
+#pragma region Recording
+const TCHAR* LexToString(EA1H_JournalEvent Event)
+{
+    switch (Event)
+    {
+    case EA1H_JournalEvent::None:                       return TEXT("None");
+    case EA1H_JournalEvent::JumpStarted:                return TEXT("JumpStarted");
+    case EA1H_JournalEvent::JumpCompleted:              return TEXT("JumpCompleted");
+    case EA1H_JournalEvent::Interact:                   return TEXT("Interact");
+    case EA1H_JournalEvent::InteractArea:               return TEXT("InteractArea");
+    case EA1H_JournalEvent::MissingCharacter:           return TEXT("MissingCharacter");
+    case EA1H_JournalEvent::InteractionDispatched:      return TEXT("InteractionDispatched");
+    case EA1H_JournalEvent::InteractionNotInteractable: return TEXT("InteractionNotInteractable");
+    case EA1H_JournalEvent::InteractRequestRejected:    return TEXT("InteractRequestRejected");
+    case EA1H_JournalEvent::AreaInteraction:            return TEXT("AreaInteraction");
+    default:                                            return TEXT("Unknown");
+    }
+}
+
+void FA1H_EventJournal::RecordInternal(EA1H_JournalEvent Event, const UObject* Subject, float Value)
+{
+    using namespace A1HJournal;
+
+    FThreadRing& Ring = GetLocalRing();
+    const uint32 Head = Ring.Head.load(std::memory_order_relaxed);
+    if (Head - Ring.Tail.load(std::memory_order_acquire) >= RingCapacity)
+    {
+        // The writer is behind. Losing a record beats stalling the game thread.
+        DroppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    FA1H_JournalRecord& Record = Ring.Records[Head & (RingCapacity - 1)];
+    Record.Cycles = FPlatformTime::Cycles64();
+    Record.Frame = static_cast<uint32>(GFrameCounter);
+    Record.ThreadId = Ring.ThreadId;
+    Record.Event = Event;
+    Record.SubjectName = 0;
+    Record.SubjectNumber = 0;
+    Record.Value = Value;
+    if (Subject)
+    {
+        const FName Name = Subject->GetFName();
+        Record.SubjectName = Name.GetDisplayIndex().ToUnstableInt();
+        Record.SubjectNumber = Name.GetNumber();
+    }
+
+    Ring.Head.store(Head + 1, std::memory_order_release);
+}
+
+#pragma endregion
+
+#pragma region Journal Lifetime
+bool FA1H_EventJournal::Start(const FString& Name)
+{
+    using namespace A1HJournal;
+    check(IsInGameThread());
+
+    if (Writer)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H event journal: already recording to %s"), *JournalPath);
+        return false;
+    }
+
+    JournalPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("A1H"),
+        FString::Printf(TEXT("Journal-%s-%s.a1hj"), Name.IsEmpty() ? TEXT("Session") : *Name, *FDateTime::Now().ToString()));
+
+    TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*JournalPath));
+    if (!File)
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H event journal: couldn't create %s"), *JournalPath);
+        return false;
+    }
+
+    FFileHeader Header;
+    Header.StartCycles = FPlatformTime::Cycles64();
+    Header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+    *File << Header;
+
+    // Anything still sitting in the rings belongs to the previous journal
+    {
+        FScopeLock Lock(&RingsLock);
+        for (const TUniquePtr<FThreadRing>& Ring : Rings)
+        {
+            Ring->Tail.store(Ring->Head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+    DroppedRecords.store(0, std::memory_order_relaxed);
+
+    LLM_SCOPE_BYTAG(A1H_Tools);
+    Writer = MakeUnique<FWriter>(MoveTemp(File));
+    WriterThread = FRunnableThread::Create(Writer.Get(), TEXT("A1H Event Journal"), 0, TPri_BelowNormal);
+    if (!WriterThread)
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H event journal: couldn't start the writer thread"));
+        Writer->Finish();
+        Writer.Reset();
+        return false;
+    }
+
+    bRecording.store(true, std::memory_order_release);
+    UE_LOG(LogA1H, Log, TEXT("A1H event journal: recording to %s"), *JournalPath);
+    return true;
+}
+
+void FA1H_EventJournal::Stop()
+{
+    using namespace A1HJournal;
+    check(IsInGameThread());
+
+    if (!Writer)
+    {
+        return;
+    }
+
+    bRecording.store(false, std::memory_order_release);
+
+    // Kill asks the writer to stop and waits for its last drain
+    WriterThread->Kill(true);
+    delete WriterThread;
+    WriterThread = nullptr;
+
+    const uint64 RecordsWritten = Writer->Finish();
+    Writer.Reset();
+
+    UE_LOG(LogA1H, Log, TEXT("A1H event journal: wrote %llu records (%llu dropped) to %s"),
+        RecordsWritten, DroppedRecords.load(std::memory_order_relaxed), *JournalPath);
+}
+
+void FA1H_EventJournal::StartFromCommandLine()
+{
+    FString Name;
+    if (FParse::Value(FCommandLine::Get(), TEXT("A1HJournal="), Name))
+    {
+        Start(Name);
+    }
+}
+
+void FA1H_EventJournal::Shutdown()
+{
+    Stop();
+
+    // Nothing records any more, so nobody is going to touch their ring again
+    FScopeLock Lock(&A1HJournal::RingsLock);
+    A1HJournal::Rings.Empty();
+}
+
+#pragma endregion
+
+#pragma region Decoding
+bool FA1H_EventJournal::DecodeToCsv(const FString& InJournalPath, const FString& CsvPath)
+{
+    using namespace A1HJournal;
+
+    TUniquePtr<FArchive> File(IFileManager::Get().CreateFileReader(*InJournalPath));
+    if (!File)
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H event journal: couldn't open %s"), *InJournalPath);
+        return false;
+    }
+
+    FFileHeader Header;
+    *File << Header;
+    if (File->IsError() || Header.Magic != FileMagic || Header.Version != FileVersion || Header.RecordSize != sizeof(FA1H_JournalRecord))
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H event journal: %s isn't a version %u journal"), *InJournalPath, FileVersion);
+        return false;
+    }
+
+    // A journal from a crashed session just stops, so everything up to the last whole block is still good
+    TArray<FA1H_JournalRecord> Records;
+    TMap<uint32, FString> Names;
+    uint64 Dropped = 0;
+    bool bComplete = false;
+    while (!File->AtEnd())
+    {
+        uint32 Count = 0;
+        *File << Count;
+        if (Count == 0)
+        {
+            int32 NumNames = 0;
+            *File << NumNames;
+            for (int32 Index = 0; Index < NumNames && !File->IsError(); ++Index)
+            {
+                uint32 NameId = 0;
+                FString Name;
+                *File << NameId << Name;
+                Names.Add(NameId, MoveTemp(Name));
+            }
+            *File << Dropped;
+            bComplete = !File->IsError();
+            break;
+        }
+
+        const int64 BlockSize = static_cast<int64>(Count) * sizeof(FA1H_JournalRecord);
+        if (File->TotalSize() - File->Tell() < BlockSize)
+        {
+            break;
+        }
+
+        const int32 FirstNew = Records.AddUninitialized(Count);
+        File->Serialize(&Records[FirstNew], BlockSize);
+    }
+
+    // Blocks come a thread at a time, put everything back in time order
+    Algo::StableSortBy(Records, &FA1H_JournalRecord::Cycles);
+
+    FString Csv = TEXT("Seconds,Frame,Thread,Event,Subject,Value\n");
+    for (const FA1H_JournalRecord& Record : Records)
+    {
+        FString Subject;
+        if (Record.SubjectName != 0)
+        {
+            const FString* Name = Names.Find(Record.SubjectName);
+            Subject = Name ? *Name : FString::Printf(TEXT("#%u"), Record.SubjectName);
+            if (Record.SubjectNumber != NAME_NO_NUMBER_INTERNAL)
+            {
+                Subject += FString::Printf(TEXT("_%u"), NAME_INTERNAL_TO_EXTERNAL(Record.SubjectNumber));
+            }
+        }
+
+        Csv += FString::Printf(TEXT("%.6f,%u,%u,%s,%s,%g\n"),
+            (Record.Cycles - Header.StartCycles) * Header.SecondsPerCycle, Record.Frame, Record.ThreadId,
+            LexToString(Record.Event), *Subject, Record.Value);
+    }
+
+    if (!FFileHelper::SaveStringToFile(Csv, *CsvPath))
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H event journal: couldn't write %s"), *CsvPath);
+        return false;
+    }
+
+    UE_LOG(LogA1H, Log, TEXT("A1H event journal: decoded %d records (%llu dropped while recording) to %s%s"),
+        Records.Num(), Dropped, *CsvPath, bComplete ? TEXT("") : TEXT(" - the journal wasn't closed, object names are missing"));
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Console
+#if !UE_BUILD_SHIPPING
+namespace A1HJournal
+{
+    static FAutoConsoleCommandWithArgs StartCommand(
+        TEXT("A1H.Journal.Start"),
+        TEXT("Starts recording the binary event journal to Saved/Profiling/A1H.\n")
+        TEXT("Usage: A1H.Journal.Start [Name=Session]"),
+        FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+        {
+            FA1H_EventJournal::Start(Args.IsValidIndex(0) ? Args[0] : FString());
+        }));
+
+    static FAutoConsoleCommand StopCommand(
+        TEXT("A1H.Journal.Stop"),
+        TEXT("Stops the event journal and closes its file."),
+        FConsoleCommandDelegate::CreateStatic(&FA1H_EventJournal::Stop));
+}
+#endif
+
+#pragma endregion
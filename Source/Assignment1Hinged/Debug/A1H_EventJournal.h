@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// What happened. Stored as a number in the journal, so only ever add to the end.
+enum class EA1H_JournalEvent : uint16
+{
+	None,
+	JumpStarted,                    // Subject: marionette
+	JumpCompleted,                  // Subject: marionette
+	Interact,                       // Subject: marionette
+	InteractArea,                   // Subject: marionette
+	MissingCharacter,               // Subject: controller, whose pawn isn't a marionette
+	InteractionDispatched,          // Subject: the actor interacted with. Value: instance index, -1 for whole actors
+	InteractionNotInteractable,     // Subject: the actor hit, which doesn't implement the interface
+	InteractRequestRejected,        // Subject: marionette. Value: 0 rate limited, 1 aim mismatch
+	AreaInteraction,                // Subject: marionette. Value: number of actors interacted with
+
+	Count
+};
+
+ASSIGNMENT1HINGED_API const TCHAR* LexToString(EA1H_JournalEvent Event);
+
+// One journal entry. Fixed size and written to disk as is.
+struct FA1H_JournalRecord
+{
+	uint64 Cycles = 0;              // FPlatformTime::Cycles64 when it was recorded
+	uint32 Frame = 0;               // GFrameCounter, truncated
+	uint32 ThreadId = 0;
+	EA1H_JournalEvent Event = EA1H_JournalEvent::None;
+	uint16 Reserved = 0;
+	uint32 SubjectName = 0;         // Display index of the subject's FName, resolved when the journal is written
+	uint32 SubjectNumber = 0;       // ...and its number
+	float Value = 0.0f;
+};
+static_assert(sizeof(FA1H_JournalRecord) == 32, "Journal records are written to disk as is, keep them 32 bytes");
+
+/**
+ * Low-overhead binary event journal for hot paths that used to UE_LOG.
+ * Record() copies a fixed-size record into a ring buffer owned by the calling thread - no locks, no string
+ * formatting and no allocation after the thread's first event. A background thread drains every ring a few
+ * times a second and appends the records to Saved/Profiling/A1H/Journal-<Name>-<date>.a1hj. Object names are
+ * only resolved once, by that thread, when the journal is closed.
+ * If a ring fills up faster than it's drained the new record is dropped and counted, the caller never waits.
+ *
+ * Decode with: UnrealEditor-Cmd <Project> -run=A1H_JournalDecode File=<path.a1hj> [Out=<path.csv>]
+ * Start with -A1HJournal=<Name> on the command line, or A1H.Journal.Start [Name] / A1H.Journal.Stop.
+ * When nothing is recording, Record() costs one relaxed atomic load.
+ */
+class ASSIGNMENT1HINGED_API FA1H_EventJournal
+{
+public:
+	static void Record(EA1H_JournalEvent Event, const UObject* Subject = nullptr, float Value = 0.0f)
+	{
+		if (bRecording.load(std::memory_order_relaxed))
+		{
+			RecordInternal(Event, Subject, Value);
+		}
+	}
+
+	// Opens a new journal file and starts the flush thread. False if one is already open or the file can't be created.
+	static bool Start(const FString& Name);
+
+	// Flushes everything recorded so far, writes the name table and closes the file
+	static void Stop();
+
+	static bool IsRecording() { return bRecording.load(std::memory_order_relaxed); }
+
+	// Starts a journal if -A1HJournal=<Name> is on the command line (module startup)
+	static void StartFromCommandLine();
+
+	// Stops recording and frees every thread's ring (module shutdown)
+	static void Shutdown();
+
+	// Turns a journal file into a CSV, one row per record. False if the file isn't a journal.
+	static bool DecodeToCsv(const FString& JournalPath, const FString& CsvPath);
+
+private:
+	static void RecordInternal(EA1H_JournalEvent Event, const UObject* Subject, float Value);
+
+	static std::atomic<bool> bRecording;
+};
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_FastForward.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Assignment1Hinged.h"                  // For LogA1H
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "InputActionValue.h"
+#include "Misc/App.h"
+#include "Misc/Crc.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+
+namespace A1HFastForward
+{
+    // Simulated seconds between checksum checkpoints
+    constexpr double CheckpointInterval = 60.0;
+
+    static void RunFastForwardCommand(const TArray<FString>& Args, UWorld* World)
+    {
+        if (!World)
+        {
+            UE_LOG(LogA1H, Warning, TEXT("A1H.FastForward.Start: no world to run in."));
+            return;
+        }
+
+        int32 MarionetteCount = 8;
+        double SimSeconds = 600.0;
+        int32 Seed = 1;
+        float StepSeconds = 1.0f / 60.0f;
+        bool bQuitWhenDone = false;
+
+        TArray<FString> Positional;
+        FA1H_HeadlessHarness::ParseArgs(Args, Positional, bQuitWhenDone);
+
+        if (Positional.IsValidIndex(0))
+        {
+            MarionetteCount = FMath::Max(1, FCString::Atoi(*Positional[0]));
+        }
+        if (Positional.IsValidIndex(1))
+        {
+            SimSeconds = FMath::Max(1.0, FCString::Atod(*Positional[1]));
+        }
+        if (Positional.IsValidIndex(2))
+        {
+            Seed = FCString::Atoi(*Positional[2]);
+        }
+        if (Positional.IsValidIndex(3))
+        {
+            StepSeconds = FMath::Clamp(FCString::Atof(*Positional[3]), 0.001f, 0.1f);
+        }
+
+        FA1H_FastForward::Start(World, MarionetteCount, SimSeconds, Seed, StepSeconds, bQuitWhenDone);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs FastForwardCommand(
+        TEXT("A1H.FastForward.Start"),
+        TEXT("Runs marionettes with seeded input at a fixed, uncapped timestep and writes state checksums and speed to Saved/Profiling/A1H.\n")
+        TEXT("Usage: A1H.FastForward.Start [Marionettes=8] [SimSeconds=600] [Seed=1] [StepSeconds=0.0166667] [quit]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunFastForwardCommand));
+}
+
+#pragma region Lifetime
+void FA1H_FastForward::Start(UWorld* World, int32 MarionetteCount, double SimSeconds, int32 Seed, float StepSeconds, bool bQuitWhenDone)
+{
+    FA1H_HeadlessHarness::Start(TUniquePtr<FA1H_HeadlessHarness>(new FA1H_FastForward(World, MarionetteCount, SimSeconds, Seed, StepSeconds, bQuitWhenDone)));
+}
+
+FA1H_FastForward::FA1H_FastForward(UWorld* InWorld, int32 InMarionetteCount, double InSimSeconds, int32 InSeed, float InStepSeconds, bool bInQuitWhenDone)
+    : FA1H_HeadlessHarness(InWorld, TEXT("A1H fast-forward"), bInQuitWhenDone)
+    , MarionetteCount(InMarionetteCount)
+    , TargetSimSeconds(InSimSeconds)
+    , Seed(InSeed)
+    , StepSeconds(InStepSeconds)
+    , Random(InSeed)
+{
+}
+
+FA1H_FastForward::~FA1H_FastForward()
+{
+    if (bOverrodeTimeStep)
+    {
+        FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+        FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+    }
+}
+
+bool FA1H_FastForward::BeginRun()
+{
+    Marionettes.Spawn(World.Get(), MarionetteCount);
+    Drivers.SetNum(Marionettes.Num());
+
+    // Fixed step: every frame advances the game by exactly StepSeconds, and the engine stops sleeping to hold a frame rate
+    bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+    PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+    FApp::SetUseFixedTimeStep(true);
+    FApp::SetFixedDeltaTime(StepSeconds);
+    bOverrodeTimeStep = true;
+
+    StartWallTime = FPlatformTime::Seconds();
+    NextCheckpointSeconds = A1HFastForward::CheckpointInterval;
+
+    UE_LOG(LogA1H, Log, TEXT("A1H fast-forward: %d marionettes, %.0f s of game time at %.4f s per step, seed %d."),
+        Marionettes.Num(), TargetSimSeconds, StepSeconds, Seed);
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Simulation
+bool FA1H_FastForward::TickRun(float DeltaTime)
+{
+    // The core ticker runs before the world ticks, so this frame's input lands in this frame's movement update
+    DriveInput();
+
+    ++Frame;
+    SimSeconds = Frame * static_cast<double>(StepSeconds);
+
+    if (SimSeconds >= NextCheckpointSeconds)
+    {
+        AddCheckpoint();
+        NextCheckpointSeconds += A1HFastForward::CheckpointInterval;
+    }
+
+    if (SimSeconds < TargetSimSeconds)
+    {
+        return true;
+    }
+
+    FinishRun();
+    return false;
+}
+
+void FA1H_FastForward::DriveInput()
+{
+    const FInputActionValue PressedValue(true);
+    const FInputActionValue ReleasedValue(false);
+
+    for (int32 Index = 0; Index < Marionettes.Controllers.Num(); ++Index)
+    {
+        FDriver& Driver = Drivers[Index];
+
+        // Every random number is drawn whether or not the controller is still around, so one marionette
+        // going missing can't shift everybody else's input
+        if (--Driver.HoldFrames <= 0)
+        {
+            Driver.Move = FVector2D(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f));
+            Driver.Look = FVector2D(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-0.3f, 0.3f));
+            Driver.HoldFrames = Random.RandRange(30, 180);
+        }
+        const bool bJump = Driver.JumpReleaseFrame == INDEX_NONE && Random.FRand() < 0.01f;
+        const int32 JumpHoldFrames = Random.RandRange(5, 20);
+        const bool bInteract = Random.FRand() < 0.02f;
+        const bool bInteractArea = Random.FRand() < 0.002f;
+
+        AA1H_MarionetteController* Controller = Marionettes.Controllers[Index].Get();
+        if (!Controller)
+        {
+            continue;
+        }
+
+        Controller->HandleMove(FInputActionValue(Driver.Move));
+        Controller->HandleLook(FInputActionValue(Driver.Look));
+
+        if (bJump)
+        {
+            Controller->HandleJumpStarted(PressedValue);
+            Driver.JumpReleaseFrame = static_cast<int32>(Frame) + JumpHoldFrames;
+        }
+        else if (Driver.JumpReleaseFrame != INDEX_NONE && static_cast<int32>(Frame) >= Driver.JumpReleaseFrame)
+        {
+            Controller->HandleJumpCompleted(ReleasedValue);
+            Driver.JumpReleaseFrame = INDEX_NONE;
+        }
+
+        if (bInteract)
+        {
+            Controller->HandleInteract(PressedValue);
+        }
+        if (bInteractArea)
+        {
+            Controller->HandleInteractArea(PressedValue);
+        }
+
+        // These controllers have no local player, so nothing calls TickPlayerInput for them
+        Controller->ApplyFrameInput();
+    }
+}
+
+uint32 FA1H_FastForward::ComputeChecksum() const
+{
+    uint32 Crc = 0;
+
+    // Quantized to 1/100th so the checksum tracks behaviour, not the last bits of float noise
+    auto Mix = [&Crc](double Value)
+    {
+        const int64 Quantized = FMath::RoundToInt64(Value * 100.0);
+        Crc = FCrc::MemCrc32(&Quantized, sizeof(Quantized), Crc);
+    };
+
+    for (const TWeakObjectPtr<AA1H_MarionetteCharacter>& CharacterPtr : Marionettes.Characters)
+    {
+        const AA1H_MarionetteCharacter* Character = CharacterPtr.Get();
+        if (!Character)
+        {
+            Mix(-1.0);
+            continue;
+        }
+
+        const FVector Location = Character->GetActorLocation();
+        const FVector Velocity = Character->GetVelocity();
+        const FRotator ControlRotation = Character->GetControlRotation();
+        Mix(Location.X);
+        Mix(Location.Y);
+        Mix(Location.Z);
+        Mix(Velocity.X);
+        Mix(Velocity.Y);
+        Mix(Velocity.Z);
+        Mix(Character->GetActorRotation().Yaw);
+        Mix(ControlRotation.Pitch);
+        Mix(ControlRotation.Yaw);
+
+        const UCharacterMovementComponent* Movement = Character->GetCharacterMovement();
+        Mix(Movement ? static_cast<double>(Movement->MovementMode.GetValue()) : -1.0);
+    }
+
+    return Crc;
+}
+
+void FA1H_FastForward::AddCheckpoint()
+{
+    FCheckpoint& Checkpoint = Checkpoints.AddDefaulted_GetRef();
+    Checkpoint.Frame = Frame;
+    Checkpoint.SimSeconds = SimSeconds;
+    Checkpoint.WallSeconds = FPlatformTime::Seconds() - StartWallTime;
+    Checkpoint.Checksum = ComputeChecksum();
+
+    UE_LOG(LogA1H, Log, TEXT("A1H fast-forward: %.0f s simulated in %.1f s (x%.1f), checksum %08X"),
+        Checkpoint.SimSeconds, Checkpoint.WallSeconds, Checkpoint.WallSeconds > 0.0 ? Checkpoint.SimSeconds / Checkpoint.WallSeconds : 0.0, Checkpoint.Checksum);
+}
+
+void FA1H_FastForward::FinishRun()
+{
+    WallSeconds = FPlatformTime::Seconds() - StartWallTime;
+
+    // Always end on a checkpoint, even if the run length isn't a multiple of the interval
+    if (Checkpoints.IsEmpty() || Checkpoints.Last().Frame != Frame)
+    {
+        AddCheckpoint();
+    }
+
+    WriteResults();
+}
+
+#pragma endregion
+
+#pragma region Output
+void FA1H_FastForward::WriteResults() const
+{
+    FString Csv = TEXT("Frame,SimSeconds,WallSeconds,Checksum\n");
+    for (const FCheckpoint& Checkpoint : Checkpoints)
+    {
+        Csv += FString::Printf(TEXT("%llu,%.3f,%.3f,%08X\n"), Checkpoint.Frame, Checkpoint.SimSeconds, Checkpoint.WallSeconds, Checkpoint.Checksum);
+    }
+
+    const uint32 FinalChecksum = Checkpoints.IsEmpty() ? 0 : Checkpoints.Last().Checksum;
+    const double Speedup = WallSeconds > 0.0 ? SimSeconds / WallSeconds : 0.0;
+    const double FramesPerSecond = WallSeconds > 0.0 ? Frame / WallSeconds : 0.0;
+
+    FString Json = TEXT("{\n");
+    Json += FString::Printf(TEXT("  \"build\": \"%s\",\n"), FApp::GetBuildVersion());
+    Json += FString::Printf(TEXT("  \"map\": \"%s\",\n"), World.IsValid() ? *World->GetMapName() : TEXT(""));
+    Json += FString::Printf(TEXT("  \"marionettes\": %d,\n"), Marionettes.Num());
+    Json += FString::Printf(TEXT("  \"seed\": %d,\n"), Seed);
+    Json += FString::Printf(TEXT("  \"step_seconds\": %.6f,\n"), StepSeconds);
+    Json += FString::Printf(TEXT("  \"frames\": %llu,\n"), Frame);
+    Json += FString::Printf(TEXT("  \"sim_seconds\": %.3f,\n"), SimSeconds);
+    Json += FString::Printf(TEXT("  \"wall_seconds\": %.3f,\n"), WallSeconds);
+    Json += FString::Printf(TEXT("  \"speedup\": %.2f,\n"), Speedup);
+    Json += FString::Printf(TEXT("  \"frames_per_second\": %.1f,\n"), FramesPerSecond);
+    Json += FString::Printf(TEXT("  \"checksum\": \"%08X\"\n"), FinalChecksum);
+    Json += TEXT("}\n");
+
+    UE_LOG(LogA1H, Log, TEXT("A1H fast-forward: %.0f s in %.1f s (x%.1f, %.0f frames/s), checksum %08X."),
+        SimSeconds, WallSeconds, Speedup, FramesPerSecond, FinalChecksum);
+    WriteReport(TEXT("FastForward"), Csv, Json);
+}
+
+#pragma endregion
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/A1H_HeadlessHarness.h"
+#include "Math/RandomStream.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Fixed-step, uncapped fast-forward of the marionette gameplay loop for soak testing.
+ * Spawns N marionettes with their own controllers, switches the engine to a fixed timestep (which also stops
+ * it waiting for the frame rate cap) and drives every controller's input handlers with seeded pseudo-random
+ * input - walking, looking around, jumping and interacting - until the requested amount of game time has
+ * been simulated. Movement, input handling and interaction dispatch all run their normal code paths.
+ *
+ * The state of every marionette is folded into a CRC at regular checkpoints and at the end. Two builds run
+ * with the same arguments and map should produce the same checksums. The first differing checkpoint shows
+ * roughly when they diverged, and the speed numbers show which one is faster.
+ * Results go to Saved/Profiling/A1H as CSV (checkpoints) and JSON (summary).
+ *
+ * Usage (headless, e.g. -nullrhi -unattended -ExecCmds="A1H.FastForward.Start 16 3600 quit"):
+ *   A1H.FastForward.Start [Marionettes=8] [SimSeconds=600] [Seed=1] [StepSeconds=0.0166667] [quit]
+ */
+class FA1H_FastForward : public FA1H_HeadlessHarness
+{
+public:
+	// Kicks off a run in World. Only one headless run can go at a time.
+	static void Start(UWorld* World, int32 MarionetteCount, double SimSeconds, int32 Seed, float StepSeconds, bool bQuitWhenDone);
+
+	virtual ~FA1H_FastForward() override;
+
+private:
+	// Synthetic input state of one marionette, re-rolled whenever HoldFrames runs out
+	struct FDriver
+	{
+		FVector2D Move = FVector2D::ZeroVector;
+		FVector2D Look = FVector2D::ZeroVector;
+		int32 HoldFrames = 0;
+		int32 JumpReleaseFrame = INDEX_NONE;
+	};
+
+	struct FCheckpoint
+	{
+		uint64 Frame = 0;
+		double SimSeconds = 0.0;
+		double WallSeconds = 0.0;
+		uint32 Checksum = 0;
+	};
+
+	FA1H_FastForward(UWorld* InWorld, int32 InMarionetteCount, double InSimSeconds, int32 InSeed, float InStepSeconds, bool bInQuitWhenDone);
+
+	// Spawns the marionettes and switches the engine to the fixed step
+	virtual bool BeginRun() override;
+	virtual bool TickRun(float DeltaTime) override;
+
+	// Feeds one frame of input into every controller
+	void DriveInput();
+
+	// CRC over the (quantized) state of every marionette, in spawn order
+	uint32 ComputeChecksum() const;
+
+	void AddCheckpoint();
+	void FinishRun();
+	void WriteResults() const;
+
+	int32 MarionetteCount = 8;
+	double TargetSimSeconds = 600.0;
+	int32 Seed = 1;
+	float StepSeconds = 1.0f / 60.0f;
+
+	// One per entry in Marionettes, same order
+	TArray<FDriver> Drivers;
+
+	// One stream for everyone, consumed in a fixed order, so the input only depends on the seed
+	FRandomStream Random;
+
+	uint64 Frame = 0;
+	double SimSeconds = 0.0;
+	double NextCheckpointSeconds = 0.0;
+	double StartWallTime = 0.0;
+	double WallSeconds = 0.0;
+	TArray<FCheckpoint> Checkpoints;
+
+	// Timestep settings to put back afterwards, if BeginRun changed them
+	bool bOverrodeTimeStep = false;
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+};
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_GameplayDebuggerCategory.h"
+
+#if A1H_WITH_GAMEPLAY_DEBUGGER
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Performance/A1H_MarionetteBudgetSubsystem.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+
+namespace A1HGameplayDebugger
+{
+    // Same order as EA1H_InputHandler
+    static const TCHAR* HandlerNames[] =
+    {
+        TEXT("Move"),
+        TEXT("Look"),
+        TEXT("Jump"),
+        TEXT("Interact"),
+        TEXT("InteractArea"),
+        TEXT("ApplyFrameInput"),
+    };
+    static_assert(UE_ARRAY_COUNT(HandlerNames) == FA1H_HandlerCosts::NumHandlers, "One name per input handler");
+
+    static void GetHandlerUs(const FA1H_HandlerCosts& Costs, TArray<float>& OutHandlerUs)
+    {
+        OutHandlerUs.SetNumUninitialized(FA1H_HandlerCosts::NumHandlers);
+        for (int32 Index = 0; Index < FA1H_HandlerCosts::NumHandlers; ++Index)
+        {
+            OutHandlerUs[Index] = static_cast<float>(FPlatformTime::ToMilliseconds64(Costs.LastFrameCycles[Index]) * 1000.0);
+        }
+    }
+
+    static void PrintHandlerUs(FGameplayDebuggerCanvasContext& CanvasContext, const TCHAR* Label, const TArray<float>& HandlerUs)
+    {
+        FString Line = FString::Printf(TEXT("{white}%s:"), Label);
+        for (int32 Index = 0; Index < HandlerUs.Num() && Index < UE_ARRAY_COUNT(HandlerNames); ++Index)
+        {
+            Line += FString::Printf(TEXT(" %s {yellow}%.1f{white}us"), HandlerNames[Index], HandlerUs[Index]);
+        }
+        CanvasContext.Print(Line);
+    }
+}
+
+FA1H_GameplayDebuggerCategory::FA1H_GameplayDebuggerCategory()
+{
+    // Falls back to the viewer's own marionette when nothing is selected
+    bShowOnlyWithDebugActor = false;
+    SetDataPackReplication<FRepData>(&DataPack);
+}
+
+TSharedRef<FGameplayDebuggerCategory> FA1H_GameplayDebuggerCategory::MakeInstance()
+{
+    return MakeShareable(new FA1H_GameplayDebuggerCategory());
+}
+
+void FA1H_GameplayDebuggerCategory::FRepData::Serialize(FArchive& Ar)
+{
+    Ar << MarionetteName;
+    Ar << bIsOwnerPawn;
+    Ar << bHasController;
+    Ar << HandlerUs;
+    Ar << LastAppliedEvents;
+    Ar << PeakAppliedEvents;
+    Ar << InteractionTarget;
+    Ar << bInteractionSucceeded;
+    Ar << InteractionSequence;
+    Ar << bHasTrace;
+    Ar << bTraceHit;
+    Ar << TraceStart;
+    Ar << TraceEnd;
+    Ar << MovementTickInterval;
+    Ar << bMovementTickEnabled;
+    Ar << MeshTickInterval;
+    Ar << AnimUpdateRate;
+    Ar << bUpdateRateOptimizations;
+    Ar << BudgetTier;
+}
+
+#pragma region Collect (Server)
+void FA1H_GameplayDebuggerCategory::CollectData(APlayerController* OwnerPC, AActor* DebugActor)
+{
+    AA1H_MarionetteCharacter* Marionette = Cast<AA1H_MarionetteCharacter>(DebugActor);
+    if (!Marionette && OwnerPC)
+    {
+        Marionette = Cast<AA1H_MarionetteCharacter>(OwnerPC->GetPawn());
+    }
+
+    DataPack = FRepData();
+    if (!Marionette)
+    {
+        return;
+    }
+
+    DataPack.MarionetteName = Marionette->GetName();
+    DataPack.bIsOwnerPawn = OwnerPC && OwnerPC->GetPawn() == Marionette;
+
+    if (const AA1H_MarionetteController* Controller = Cast<AA1H_MarionetteController>(Marionette->GetController()))
+    {
+        DataPack.bHasController = true;
+        A1HGameplayDebugger::GetHandlerUs(Controller->GetHandlerCosts(), DataPack.HandlerUs);
+        DataPack.LastAppliedEvents = Controller->GetHandlerCosts().LastAppliedEvents;
+        DataPack.PeakAppliedEvents = Controller->GetHandlerCosts().PeakAppliedEvents;
+    }
+
+    const FA1H_InteractionResult& Result = Marionette->LastInteractionResult;
+    DataPack.InteractionTarget = GetNameSafe(Result.Target);
+    DataPack.bInteractionSucceeded = Result.bSucceeded;
+    DataPack.InteractionSequence = Result.Sequence;
+
+    const AA1H_MarionetteCharacter::FInteractionTraceDebug& Trace = Marionette->LastInteractionTrace;
+    DataPack.bHasTrace = Trace.bValid;
+    DataPack.bTraceHit = Trace.bHit;
+    DataPack.TraceStart = Trace.Start;
+    DataPack.TraceEnd = Trace.End;
+    if (Trace.bValid)
+    {
+        // Shapes go through the same replication as the data pack
+        AddShape(FGameplayDebuggerShape::MakeSegment(Trace.Start, Trace.End, 2.0f, Trace.bHit ? FColor::Green : FColor::Red));
+    }
+
+    if (const UCharacterMovementComponent* Movement = Marionette->GetCharacterMovement())
+    {
+        DataPack.MovementTickInterval = Movement->GetComponentTickInterval();
+        DataPack.bMovementTickEnabled = Movement->IsComponentTickEnabled();
+    }
+
+    if (const USkeletalMeshComponent* Mesh = Marionette->GetMesh())
+    {
+        DataPack.MeshTickInterval = Mesh->GetComponentTickInterval();
+        DataPack.bUpdateRateOptimizations = Mesh->bEnableUpdateRateOptimizations;
+        DataPack.AnimUpdateRate = (Mesh->bEnableUpdateRateOptimizations && Mesh->AnimUpdateRateParams) ? Mesh->AnimUpdateRateParams->UpdateRate : 1;
+    }
+
+    if (const UA1H_MarionetteBudgetSubsystem* Budget = Marionette->GetWorld()->GetSubsystem<UA1H_MarionetteBudgetSubsystem>())
+    {
+        DataPack.BudgetTier = Budget->GetMarionetteTier(Marionette);
+    }
+}
+
+#pragma endregion
+
+#pragma region Draw (Client)
+void FA1H_GameplayDebuggerCategory::DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext)
+{
+    if (DataPack.MarionetteName.IsEmpty())
+    {
+        CanvasContext.Print(TEXT("{red}No marionette selected or possessed"));
+        return;
+    }
+
+    CanvasContext.Printf(TEXT("{white}Marionette: {yellow}%s%s"), *DataPack.MarionetteName, DataPack.bIsOwnerPawn ? TEXT(" {grey}(yours)") : TEXT(""));
+
+    // Input
+    if (DataPack.bHasController)
+    {
+        A1HGameplayDebugger::PrintHandlerUs(CanvasContext, TEXT("Handlers (server)"), DataPack.HandlerUs);
+        CanvasContext.Printf(TEXT("{white}Input queue: last {yellow}%d{white} events, peak {yellow}%d"), DataPack.LastAppliedEvents, DataPack.PeakAppliedEvents);
+    }
+    else
+    {
+        CanvasContext.Print(TEXT("{white}Handlers: {grey}not controlled by a marionette controller"));
+    }
+
+    // The handlers run wherever the player is, so on a client our own numbers are only here
+    const AA1H_MarionetteController* LocalController = Cast<AA1H_MarionetteController>(OwnerPC);
+    if (DataPack.bIsOwnerPawn && LocalController && !LocalController->HasAuthority())
+    {
+        TArray<float> LocalHandlerUs;
+        A1HGameplayDebugger::GetHandlerUs(LocalController->GetHandlerCosts(), LocalHandlerUs);
+        A1HGameplayDebugger::PrintHandlerUs(CanvasContext, TEXT("Handlers (local)"), LocalHandlerUs);
+        CanvasContext.Printf(TEXT("{white}Local input queue: last {yellow}%d{white} events, peak {yellow}%d"),
+            LocalController->GetHandlerCosts().LastAppliedEvents, LocalController->GetHandlerCosts().PeakAppliedEvents);
+    }
+
+    // Interaction
+    CanvasContext.Printf(TEXT("{white}Interaction #%d: {yellow}%s {white}%s"), DataPack.InteractionSequence,
+        DataPack.InteractionTarget.IsEmpty() ? TEXT("None") : *DataPack.InteractionTarget,
+        DataPack.bInteractionSucceeded ? TEXT("{green}succeeded") : TEXT("{red}nothing taken"));
+    if (DataPack.bHasTrace)
+    {
+        CanvasContext.Printf(TEXT("{white}Last trace: %s{white}, %.0f cm"), DataPack.bTraceHit ? TEXT("{green}hit") : TEXT("{red}miss"),
+            FVector::Dist(DataPack.TraceStart, DataPack.TraceEnd));
+    }
+
+    // Update rates
+    CanvasContext.Printf(TEXT("{white}Budget tier: {yellow}%s"), DataPack.BudgetTier == INDEX_NONE ? TEXT("unregistered") : *FString::FromInt(DataPack.BudgetTier));
+    CanvasContext.Printf(TEXT("{white}Movement tick: {yellow}%s"),
+        DataPack.bMovementTickEnabled ? *FString::Printf(TEXT("%.3f s"), DataPack.MovementTickInterval) : TEXT("off"));
+    CanvasContext.Printf(TEXT("{white}Mesh tick: {yellow}%.3f s{white}, anim update rate {yellow}1/%d{white}%s"),
+        DataPack.MeshTickInterval, DataPack.AnimUpdateRate, DataPack.bUpdateRateOptimizations ? TEXT(" (URO)") : TEXT(""));
+}
+
+#pragma endregion
+
+#endif // A1H_WITH_GAMEPLAY_DEBUGGER
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Needs the gameplay debugger (bUseGameplayDebugger) and the per-controller timings, which compile out of Shipping
+#define A1H_WITH_GAMEPLAY_DEBUGGER (WITH_GAMEPLAY_DEBUGGER && !UE_BUILD_SHIPPING)
+
+#if A1H_WITH_GAMEPLAY_DEBUGGER
+#include "GameplayDebuggerCategory.h"
+
+class APlayerController;
+class AActor;
+
+/**
+ * "A1H" gameplay debugger category (apostrophe key, then the category's number).
+ * Shows the selected marionette, or your own if nothing is selected: what its input handlers cost last frame,
+ * how much input the last ApplyFrameInput had queued, the last interaction result and trace (also drawn in the
+ * world), and the tick interval, anim update rate and budget tier its movement and mesh currently run at.
+ * Collected on the server and replicated through the debugger's data pack, so it also works against a dedicated
+ * server. The handler costs come from whoever runs the handlers: the server's copy only sees them for listen
+ * server and standalone players, so for your own marionette the overlay also shows your local numbers.
+ */
+class FA1H_GameplayDebuggerCategory : public FGameplayDebuggerCategory
+{
+public:
+	FA1H_GameplayDebuggerCategory();
+
+	virtual void CollectData(APlayerController* OwnerPC, AActor* DebugActor) override;
+	virtual void DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext) override;
+
+	static TSharedRef<FGameplayDebuggerCategory> MakeInstance();
+
+protected:
+	struct FRepData
+	{
+		FString MarionetteName;
+		bool bIsOwnerPawn = false;
+
+		// Input, from the marionette's controller
+		bool bHasController = false;
+		TArray<float> HandlerUs;
+		int32 LastAppliedEvents = 0;
+		int32 PeakAppliedEvents = 0;
+
+		// Interaction
+		FString InteractionTarget;
+		bool bInteractionSucceeded = false;
+		int32 InteractionSequence = 0;
+		bool bHasTrace = false;
+		bool bTraceHit = false;
+		FVector TraceStart = FVector::ZeroVector;
+		FVector TraceEnd = FVector::ZeroVector;
+
+		// Update rates
+		float MovementTickInterval = 0.0f;
+		bool bMovementTickEnabled = false;
+		float MeshTickInterval = 0.0f;
+		int32 AnimUpdateRate = 1;
+		bool bUpdateRateOptimizations = false;
+		int32 BudgetTier = INDEX_NONE;
+
+		void Serialize(FArchive& Ar);
+	};
+
+	FRepData DataPack;
+};
+
+#endif // A1H_WITH_GAMEPLAY_DEBUGGER
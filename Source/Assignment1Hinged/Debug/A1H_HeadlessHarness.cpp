@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_HeadlessHarness.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Assignment1Hinged.h"                  // For LogA1H
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+
+TUniquePtr<FA1H_HeadlessHarness> FA1H_HeadlessHarness::ActiveRun;
+
+namespace A1HHeadlessHarness
+{
+    // Spacing between spawned marionettes, big enough that capsules never overlap
+    constexpr float SpawnSpacing = 200.0f;
+}
+
+#pragma region Spawned Marionettes
+int32 FA1H_SpawnedMarionettes::Spawn(UWorld* World, int32 Count)
+{
+    if (!World || Count <= 0)
+    {
+        return 0;
+    }
+
+    // Prefer the game mode's Blueprint classes so mesh/anim costs are included, fall back to the native ones
+    UClass* CharacterClass = AA1H_MarionetteCharacter::StaticClass();
+    UClass* ControllerClass = AA1H_MarionetteController::StaticClass();
+    if (const AGameModeBase* GameMode = World->GetAuthGameMode())
+    {
+        if (GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf(CharacterClass))
+        {
+            CharacterClass = GameMode->DefaultPawnClass;
+        }
+        if (GameMode->PlayerControllerClass && GameMode->PlayerControllerClass->IsChildOf(ControllerClass))
+        {
+            ControllerClass = GameMode->PlayerControllerClass;
+        }
+    }
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+    // Lay them out on a square grid, continuing the one we already have
+    const int32 FirstIndex = Characters.Num();
+    const int32 GridSide = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(FirstIndex + Count)));
+    int32 NumSpawned = 0;
+    for (int32 Index = FirstIndex; Index < FirstIndex + Count; ++Index)
+    {
+        const FVector Location((Index % GridSide) * A1HHeadlessHarness::SpawnSpacing, (Index / GridSide) * A1HHeadlessHarness::SpawnSpacing, 200.0f);
+
+        AA1H_MarionetteCharacter* Character = World->SpawnActor<AA1H_MarionetteCharacter>(CharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+        AA1H_MarionetteController* Controller = World->SpawnActor<AA1H_MarionetteController>(ControllerClass, SpawnParams);
+        if (!Character || !Controller)
+        {
+            continue;
+        }
+
+        Controller->Possess(Character);
+        Characters.Add(Character);
+        Controllers.Add(Controller);
+        ++NumSpawned;
+    }
+
+    return NumSpawned;
+}
+
+void FA1H_SpawnedMarionettes::DespawnAll()
+{
+    for (const TWeakObjectPtr<AA1H_MarionetteController>& Controller : Controllers)
+    {
+        if (Controller.IsValid())
+        {
+            Controller->UnPossess();
+            Controller->Destroy();
+        }
+    }
+
+    for (const TWeakObjectPtr<AA1H_MarionetteCharacter>& Character : Characters)
+    {
+        if (Character.IsValid())
+        {
+            Character->Destroy();
+        }
+    }
+
+    Controllers.Reset();
+    Characters.Reset();
+}
+
+#pragma endregion
+
+#pragma region Lifetime
+bool FA1H_HeadlessHarness::Start(TUniquePtr<FA1H_HeadlessHarness> Run)
+{
+    if (!Run)
+    {
+        return false;
+    }
+
+    if (IsRunning())
+    {
+        UE_LOG(LogA1H, Warning, TEXT("%s: %s is still running, only one headless run at a time."), Run->Name, ActiveRun->Name);
+        return false;
+    }
+
+    if (!Run->World.IsValid())
+    {
+        UE_LOG(LogA1H, Warning, TEXT("%s: no world to run in."), Run->Name);
+        return false;
+    }
+
+    ActiveRun = MoveTemp(Run);
+    if (!ActiveRun->BeginRun())
+    {
+        ActiveRun.Reset();
+        return false;
+    }
+
+    ActiveRun->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(ActiveRun.Get(), &FA1H_HeadlessHarness::Tick));
+    return true;
+}
+
+FA1H_HeadlessHarness::FA1H_HeadlessHarness(UWorld* InWorld, const TCHAR* InName, bool bInQuitWhenDone)
+    : World(InWorld)
+    , Name(InName)
+    , bQuitWhenDone(bInQuitWhenDone)
+{
+}
+
+FA1H_HeadlessHarness::~FA1H_HeadlessHarness()
+{
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    }
+}
+
+bool FA1H_HeadlessHarness::Tick(float DeltaTime)
+{
+    if (!World.IsValid())
+    {
+        UE_LOG(LogA1H, Warning, TEXT("%s: world went away, aborting."), Name);
+        SetFailed();
+        Finish();
+        return false;
+    }
+
+    if (TickRun(DeltaTime))
+    {
+        return true;
+    }
+
+    Finish();
+    return false;
+}
+
+void FA1H_HeadlessHarness::Finish()
+{
+    if (bQuitWhenDone)
+    {
+        // A non-zero exit code is what fails the CI step
+        if (bFailed)
+        {
+            FPlatformMisc::RequestExitWithStatus(false, 1, Name);
+        }
+        else
+        {
+            FPlatformMisc::RequestExit(false, Name);
+        }
+    }
+
+    // Can't delete ourselves from inside our own tick, so do it next time the game thread is free
+    TickerHandle.Reset();
+    AsyncTask(ENamedThreads::GameThread, []() { ActiveRun.Reset(); });
+}
+
+#pragma endregion
+
+#pragma region Helpers
+void FA1H_HeadlessHarness::ParseArgs(const TArray<FString>& Args, TArray<FString>& OutPositional, bool& bOutQuitWhenDone)
+{
+    for (const FString& Arg : Args)
+    {
+        if (Arg.Equals(TEXT("quit"), ESearchCase::IgnoreCase))
+        {
+            bOutQuitWhenDone = true;
+        }
+        else
+        {
+            OutPositional.Add(Arg);
+        }
+    }
+}
+
+void FA1H_HeadlessHarness::Summarize(const TArray<double>& Samples, double& OutAvg, double& OutP95, double& OutMax)
+{
+    OutAvg = OutP95 = OutMax = 0.0;
+    if (Samples.IsEmpty())
+    {
+        return;
+    }
+
+    TArray<double> Sorted = Samples;
+    Sorted.Sort();
+
+    double Total = 0.0;
+    for (const double Sample : Sorted)
+    {
+        Total += Sample;
+    }
+
+    OutAvg = Total / Sorted.Num();
+    OutP95 = Sorted[FMath::Min(Sorted.Num() - 1, FMath::FloorToInt32(Sorted.Num() * 0.95))];
+    OutMax = Sorted.Last();
+}
+
+void FA1H_HeadlessHarness::WriteReport(const TCHAR* BaseName, const FString& Csv, const FString& Json)
+{
+    const FString OutputDir = FPaths::Combine(FPaths::ProfilingDir(), TEXT("A1H"));
+    const FString FileName = FString::Printf(TEXT("%s-%s"), BaseName, *FDateTime::Now().ToString());
+
+    const FString CsvPath = FPaths::Combine(OutputDir, FileName + TEXT(".csv"));
+    const FString JsonPath = FPaths::Combine(OutputDir, FileName + TEXT(".json"));
+    FFileHelper::SaveStringToFile(Csv, *CsvPath);
+    FFileHelper::SaveStringToFile(Json, *JsonPath);
+
+    UE_LOG(LogA1H, Log, TEXT("%s: results written to %s and %s"), BaseName, *CsvPath, *JsonPath);
+}
+
+#pragma endregion
+
+#endif // !UE_BUILD_SHIPPING
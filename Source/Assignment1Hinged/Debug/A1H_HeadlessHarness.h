@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+#if !UE_BUILD_SHIPPING
+
+class UWorld;
+class AA1H_MarionetteCharacter;
+class AA1H_MarionetteController;
+
+/**
+ * Marionettes spawned for a headless run or test, each possessed by its own AA1H_MarionetteController.
+ * Uses the game mode's Blueprint classes when they're marionettes (so mesh and anim costs are included),
+ * the native ones otherwise. Despawns whatever is left when it goes away.
+ */
+struct ASSIGNMENT1HINGED_API FA1H_SpawnedMarionettes
+{
+	~FA1H_SpawnedMarionettes() { DespawnAll(); }
+
+	// Spawns Count more on a square grid, continuing where the last call left off. Returns how many made it.
+	int32 Spawn(UWorld* World, int32 Count);
+
+	// Unpossesses and destroys every one of them
+	void DespawnAll();
+
+	int32 Num() const { return Characters.Num(); }
+
+	// Same order in both, one pair per marionette
+	TArray<TWeakObjectPtr<AA1H_MarionetteController>> Controllers;
+	TArray<TWeakObjectPtr<AA1H_MarionetteCharacter>> Characters;
+};
+
+/**
+ * Base for the headless A1H tools (benchmarks, soak and memory reports) that run from a console command,
+ * e.g. with -nullrhi -unattended -ExecCmds="<command> quit".
+ * Only one runs at a time. It's driven by the core ticker (before the world ticks) and deletes itself
+ * once TickRun reports it's done or its world goes away. With "quit" the process exits afterwards,
+ * with exit code 1 if the run called SetFailed, so a CI step fails on it.
+ */
+class ASSIGNMENT1HINGED_API FA1H_HeadlessHarness
+{
+public:
+	virtual ~FA1H_HeadlessHarness();
+
+	// Makes Run the active run and starts ticking it. Refused (and Run deleted) if another one is still going.
+	static bool Start(TUniquePtr<FA1H_HeadlessHarness> Run);
+
+	static bool IsRunning() { return ActiveRun.IsValid(); }
+
+	// Splits console arguments into positional ones and "quit", which is allowed anywhere
+	static void ParseArgs(const TArray<FString>& Args, TArray<FString>& OutPositional, bool& bOutQuitWhenDone);
+
+	// Average, 95th percentile and max of a set of samples (all zero when there are none)
+	static void Summarize(const TArray<double>& Samples, double& OutAvg, double& OutP95, double& OutMax);
+
+	// Writes <BaseName>-<timestamp>.csv and .json to Saved/Profiling/A1H and logs where they went
+	static void WriteReport(const TCHAR* BaseName, const FString& Csv, const FString& Json);
+
+protected:
+	// Name is what the log lines start with, e.g. TEXT("A1H benchmark")
+	FA1H_HeadlessHarness(UWorld* InWorld, const TCHAR* InName, bool bInQuitWhenDone);
+
+	// Called right after the run becomes active, e.g. to spawn. Return false to give up straight away.
+	virtual bool BeginRun() { return true; }
+
+	// Called once per engine frame with the real time since the last one. Return false once the run is finished.
+	virtual bool TickRun(float DeltaTime) = 0;
+
+	// Marks the run as failed (a budget was exceeded), which is what the exit code reports
+	void SetFailed() { bFailed = true; }
+
+	TWeakObjectPtr<UWorld> World;
+	const TCHAR* Name = TEXT("A1H run");
+	bool bQuitWhenDone = false;
+
+	FA1H_SpawnedMarionettes Marionettes;
+
+private:
+	bool Tick(float DeltaTime);
+
+	// Quits if asked to and schedules our own deletion
+	void Finish();
+
+	bool bFailed = false;
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	static TUniquePtr<FA1H_HeadlessHarness> ActiveRun;
+};
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_JournalDecodeCommandlet.h"
+#include "Assignment1Hinged.h"                  // For LogA1H
+#include "Debug/A1H_EventJournal.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+UA1H_JournalDecodeCommandlet::UA1H_JournalDecodeCommandlet()
+{
+    // Just file in, file out - no world, no rendering
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UA1H_JournalDecodeCommandlet::Main(const FString& Params)
+{
+    FString JournalPath;
+    if (!FParse::Value(*Params, TEXT("File="), JournalPath))
+    {
+        UE_LOG(LogA1H, Error, TEXT("Usage: -run=A1H_JournalDecode File=<journal.a1hj> [Out=<file.csv>]"));
+        return 1;
+    }
+
+    FString CsvPath = FPaths::ChangeExtension(JournalPath, TEXT("csv"));
+    FParse::Value(*Params, TEXT("Out="), CsvPath);
+
+    return FA1H_EventJournal::DecodeToCsv(JournalPath, CsvPath) ? 0 : 1;
+}
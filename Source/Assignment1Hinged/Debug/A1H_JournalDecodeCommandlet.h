@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "A1H_JournalDecodeCommandlet.generated.h"
+
+/**
+ * Turns an event journal (FA1H_EventJournal) into a CSV, offline.
+ * Usage: UnrealEditor-Cmd <Project> -run=A1H_JournalDecode File=<journal.a1hj> [Out=<file.csv>]
+ * Out defaults to the journal path with a .csv extension.
+ */
+UCLASS()
+class ASSIGNMENT1HINGED_API UA1H_JournalDecodeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UA1H_JournalDecodeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
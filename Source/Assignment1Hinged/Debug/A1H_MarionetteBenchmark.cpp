@@ -0,0 +1,320 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_MarionetteBenchmark.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Assignment1Hinged.h"                  // For LogA1H
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "InputActionValue.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+
+namespace A1HBenchmark
+{
+    // Frames thrown away after each spawn so the spawn hitch doesn't skew the numbers
+    constexpr int32 WarmupFrames = 5;
+
+    static TAutoConsoleVariable<FString> CVarBudgetMs(
+        TEXT("A1H.Benchmark.Marionettes.BudgetMs"),
+        TEXT(""),
+        TEXT("p95 frame time budget per marionette count for A1H.Benchmark.Marionettes, as Count=Ms pairs, e.g. \"1=8,100=12,1000=33\".\n")
+        TEXT("Each pass uses the budget of the largest listed count not above its own. Empty (or a count below all of them) = no budget."),
+        ECVF_Default);
+
+    // The budget a pass of MarionetteCount is held to, 0 if there isn't one
+    static double GetBudgetMs(int32 MarionetteCount)
+    {
+        TArray<FString> Pairs;
+        CVarBudgetMs.GetValueOnGameThread().ParseIntoArray(Pairs, TEXT(","));
+
+        int32 BestCount = INDEX_NONE;
+        double BudgetMs = 0.0;
+        for (const FString& Pair : Pairs)
+        {
+            FString CountString;
+            FString MsString;
+            if (!Pair.Split(TEXT("="), &CountString, &MsString))
+            {
+                continue;
+            }
+
+            const int32 Count = FCString::Atoi(*CountString.TrimStartAndEnd());
+            if (Count <= MarionetteCount && Count > BestCount)
+            {
+                BestCount = Count;
+                BudgetMs = FCString::Atod(*MsString.TrimStartAndEnd());
+            }
+        }
+        return BudgetMs;
+    }
+
+    static double CyclesToUs(uint64 Cycles, int64 Calls)
+    {
+        return Calls > 0 ? FPlatformTime::ToMilliseconds64(Cycles) * 1000.0 / static_cast<double>(Calls) : 0.0;
+    }
+
+    static void RunBenchmarkCommand(const TArray<FString>& Args, UWorld* World)
+    {
+        TArray<int32> Counts = { 1, 10, 100, 1000 };
+        int32 FramesPerRun = 300;
+        bool bQuitWhenDone = false;
+
+        TArray<FString> Positional;
+        FA1H_HeadlessHarness::ParseArgs(Args, Positional, bQuitWhenDone);
+
+        if (Positional.Num() > 0)
+        {
+            TArray<FString> CountStrings;
+            Positional[0].ParseIntoArray(CountStrings, TEXT(","));
+            Counts.Reset();
+            for (const FString& CountString : CountStrings)
+            {
+                Counts.Add(FMath::Max(1, FCString::Atoi(*CountString)));
+            }
+        }
+
+        if (Positional.Num() > 1)
+        {
+            FramesPerRun = FMath::Max(1, FCString::Atoi(*Positional[1]));
+        }
+
+        FA1H_MarionetteBenchmark::Start(World, Counts, FramesPerRun, bQuitWhenDone);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+        TEXT("A1H.Benchmark.Marionettes"),
+        TEXT("Spawns N marionettes, drives their input handlers with synthetic values and writes timings to Saved/Profiling/A1H.\n")
+        TEXT("Fails (exit code 1 with quit) if a pass goes over A1H.Benchmark.Marionettes.BudgetMs.\n")
+        TEXT("Usage: A1H.Benchmark.Marionettes [Counts=1,10,100,1000] [FramesPerRun=300] [quit]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmarkCommand));
+}
+
+#pragma region Lifetime
+void FA1H_MarionetteBenchmark::Start(UWorld* World, const TArray<int32>& Counts, int32 FramesPerRun, bool bQuitWhenDone)
+{
+    FA1H_HeadlessHarness::Start(TUniquePtr<FA1H_HeadlessHarness>(new FA1H_MarionetteBenchmark(World, Counts, FramesPerRun, bQuitWhenDone)));
+}
+
+FA1H_MarionetteBenchmark::FA1H_MarionetteBenchmark(UWorld* InWorld, const TArray<int32>& InCounts, int32 InFramesPerRun, bool bInQuitWhenDone)
+    : FA1H_HeadlessHarness(InWorld, TEXT("A1H benchmark"), bInQuitWhenDone)
+    , PendingCounts(InCounts)
+    , FramesPerRun(InFramesPerRun)
+{
+}
+
+#pragma endregion
+
+#pragma region Runs
+bool FA1H_MarionetteBenchmark::BeginNextRun()
+{
+    UWorld* BenchWorld = World.Get();
+    if (!BenchWorld || PendingCounts.IsEmpty())
+    {
+        return false;
+    }
+
+    CurrentCount = PendingCounts[0];
+    PendingCounts.RemoveAt(0);
+
+    FrameIndex = 0;
+    MoveCycles = LookCycles = JumpCycles = InteractCycles = ApplyCycles = 0;
+    MoveCalls = LookCalls = JumpCalls = InteractCalls = ApplyCalls = 0;
+    FrameTimesMs.Reset(FramesPerRun);
+
+    Marionettes.Spawn(BenchWorld, CurrentCount);
+
+    UE_LOG(LogA1H, Log, TEXT("A1H benchmark: running %d marionettes for %d frames."), Marionettes.Num(), FramesPerRun);
+    return true;
+}
+
+bool FA1H_MarionetteBenchmark::TickRun(float DeltaTime)
+{
+    ++FrameIndex;
+    if (FrameIndex > A1HBenchmark::WarmupFrames)
+    {
+        // DeltaTime here is the real time between engine frames, which is what we want to see scale
+        FrameTimesMs.Add(DeltaTime * 1000.0);
+    }
+
+    DriveHandlers();
+
+    if (FrameIndex < FramesPerRun + A1HBenchmark::WarmupFrames)
+    {
+        return true;
+    }
+
+    FinishRun();
+    if (BeginNextRun())
+    {
+        return true;
+    }
+
+    WriteResults();
+    return false;
+}
+
+void FA1H_MarionetteBenchmark::DriveHandlers()
+{
+    const bool bMeasure = FrameIndex > A1HBenchmark::WarmupFrames;
+
+    // Walk in a slow circle and pan the camera a little so the movement code has real work to do
+    const float Angle = FrameIndex * 0.05f;
+    const FInputActionValue MoveValue(FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)));
+    const FInputActionValue LookValue(FVector2D(0.5f, 0.1f * FMath::Sin(Angle)));
+    const FInputActionValue PressedValue(true);
+    const FInputActionValue ReleasedValue(false);
+
+    // Interact twice a second. The handler only queues the press and ApplyFrameInput runs the trace and the
+    // interaction, so both are timed together, first thing in the frame so nothing else is queued with it.
+    uint64 Start = 0;
+    if (FrameIndex % 30 == 0)
+    {
+        Start = FPlatformTime::Cycles64();
+        for (const TWeakObjectPtr<AA1H_MarionetteController>& Controller : Marionettes.Controllers)
+        {
+            if (Controller.IsValid())
+            {
+                Controller->HandleInteract(PressedValue);
+                Controller->ApplyFrameInput();
+            }
+        }
+        if (bMeasure)
+        {
+            InteractCycles += FPlatformTime::Cycles64() - Start;
+            InteractCalls += Marionettes.Controllers.Num();
+        }
+    }
+
+    Start = FPlatformTime::Cycles64();
+    for (const TWeakObjectPtr<AA1H_MarionetteController>& Controller : Marionettes.Controllers)
+    {
+        if (Controller.IsValid())
+        {
+            Controller->HandleMove(MoveValue);
+        }
+    }
+    if (bMeasure)
+    {
+        MoveCycles += FPlatformTime::Cycles64() - Start;
+        MoveCalls += Marionettes.Controllers.Num();
+    }
+
+    Start = FPlatformTime::Cycles64();
+    for (const TWeakObjectPtr<AA1H_MarionetteController>& Controller : Marionettes.Controllers)
+    {
+        if (Controller.IsValid())
+        {
+            Controller->HandleLook(LookValue);
+        }
+    }
+    if (bMeasure)
+    {
+        LookCycles += FPlatformTime::Cycles64() - Start;
+        LookCalls += Marionettes.Controllers.Num();
+    }
+
+    // Jump press every second, release a quarter of a second later (at 60 fps)
+    const int32 JumpPhase = FrameIndex % 60;
+    if (JumpPhase == 0 || JumpPhase == 15)
+    {
+        Start = FPlatformTime::Cycles64();
+        for (const TWeakObjectPtr<AA1H_MarionetteController>& Controller : Marionettes.Controllers)
+        {
+            if (Controller.IsValid())
+            {
+                if (JumpPhase == 0)
+                {
+                    Controller->HandleJumpStarted(PressedValue);
+                }
+                else
+                {
+                    Controller->HandleJumpCompleted(ReleasedValue);
+                }
+            }
+        }
+        if (bMeasure)
+        {
+            JumpCycles += FPlatformTime::Cycles64() - Start;
+            JumpCalls += Marionettes.Controllers.Num();
+        }
+    }
+
+    // The handlers only gather input now; push it to the characters like TickPlayerInput would
+    Start = FPlatformTime::Cycles64();
+    for (const TWeakObjectPtr<AA1H_MarionetteController>& Controller : Marionettes.Controllers)
+    {
+        if (Controller.IsValid())
+        {
+            Controller->ApplyFrameInput();
+        }
+    }
+    if (bMeasure)
+    {
+        ApplyCycles += FPlatformTime::Cycles64() - Start;
+        ApplyCalls += Marionettes.Controllers.Num();
+    }
+}
+
+void FA1H_MarionetteBenchmark::FinishRun()
+{
+    FRunResult& Result = Results.AddDefaulted_GetRef();
+    Result.MarionetteCount = Marionettes.Num();
+    Result.Frames = FrameTimesMs.Num();
+    Result.MoveUs = A1HBenchmark::CyclesToUs(MoveCycles, MoveCalls);
+    Result.LookUs = A1HBenchmark::CyclesToUs(LookCycles, LookCalls);
+    Result.JumpUs = A1HBenchmark::CyclesToUs(JumpCycles, JumpCalls);
+    Result.InteractUs = A1HBenchmark::CyclesToUs(InteractCycles, InteractCalls);
+    Result.ApplyUs = A1HBenchmark::CyclesToUs(ApplyCycles, ApplyCalls);
+    Summarize(FrameTimesMs, Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs);
+
+    // Budgets are per requested count, so a pass that lost a few spawns is still held to its own
+    Result.BudgetMs = A1HBenchmark::GetBudgetMs(CurrentCount);
+    Result.bWithinBudget = Result.BudgetMs <= 0.0 || Result.P95FrameMs <= Result.BudgetMs;
+
+    UE_LOG(LogA1H, Log, TEXT("A1H benchmark: N=%d move=%.3fus look=%.3fus jump=%.3fus interact=%.3fus apply=%.3fus frame avg=%.2fms p95=%.2fms max=%.2fms"),
+        Result.MarionetteCount, Result.MoveUs, Result.LookUs, Result.JumpUs, Result.InteractUs, Result.ApplyUs, Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs);
+
+    if (!Result.bWithinBudget)
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H benchmark: N=%d p95 frame %.2f ms is over the %.2f ms budget."), CurrentCount, Result.P95FrameMs, Result.BudgetMs);
+        SetFailed();
+    }
+
+    Marionettes.DespawnAll();
+}
+
+#pragma endregion
+
+#pragma region Output
+void FA1H_MarionetteBenchmark::WriteResults() const
+{
+    FString Csv = TEXT("Marionettes,Frames,MoveUs,LookUs,JumpUs,InteractUs,ApplyUs,AvgFrameMs,P95FrameMs,MaxFrameMs,BudgetMs,WithinBudget\n");
+    FString Json = TEXT("{\n  \"runs\": [\n");
+
+    for (int32 Index = 0; Index < Results.Num(); ++Index)
+    {
+        const FRunResult& Result = Results[Index];
+
+        Csv += FString::Printf(TEXT("%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d\n"),
+            Result.MarionetteCount, Result.Frames, Result.MoveUs, Result.LookUs, Result.JumpUs, Result.InteractUs, Result.ApplyUs,
+            Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs, Result.BudgetMs, Result.bWithinBudget ? 1 : 0);
+
+        Json += FString::Printf(
+            TEXT("    { \"marionettes\": %d, \"frames\": %d, \"move_us\": %.4f, \"look_us\": %.4f, \"jump_us\": %.4f, \"interact_us\": %.4f, \"apply_us\": %.4f, \"avg_frame_ms\": %.4f, \"p95_frame_ms\": %.4f, \"max_frame_ms\": %.4f, \"budget_ms\": %.4f, \"within_budget\": %s }%s\n"),
+            Result.MarionetteCount, Result.Frames, Result.MoveUs, Result.LookUs, Result.JumpUs, Result.InteractUs, Result.ApplyUs,
+            Result.AvgFrameMs, Result.P95FrameMs, Result.MaxFrameMs, Result.BudgetMs, Result.bWithinBudget ? TEXT("true") : TEXT("false"),
+            Index + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+    }
+
+    Json += TEXT("  ]\n}\n");
+
+    WriteReport(TEXT("MarionetteBenchmark"), Csv, Json);
+}
+
+#pragma endregion
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/A1H_HeadlessHarness.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Headless benchmark for the marionette input and interaction paths.
+ * Spawns N marionettes (each possessed by its own AA1H_MarionetteController), feeds every controller
+ * synthetic move/look/jump/interact values each frame and records per-call handler cost and frame time.
+ * Runs one pass per requested N and writes the results to Saved/Profiling/A1H as CSV and JSON.
+ *
+ * Each pass's p95 frame time is checked against A1H.Benchmark.Marionettes.BudgetMs. Over budget logs an error
+ * and, with "quit", exits with code 1, so a CI run fails.
+ *
+ * Usage (e.g. from -ExecCmds with -nullrhi -unattended):
+ *   A1H.Benchmark.Marionettes [Counts=1,10,100,1000] [FramesPerRun=300] [quit]
+ */
+class FA1H_MarionetteBenchmark : public FA1H_HeadlessHarness
+{
+public:
+	// Kicks off a benchmark in World. Only one headless run can go at a time.
+	static void Start(UWorld* World, const TArray<int32>& Counts, int32 FramesPerRun, bool bQuitWhenDone);
+
+private:
+	// Results for one value of N
+	struct FRunResult
+	{
+		int32 MarionetteCount = 0;
+		int32 Frames = 0;
+
+		// Average cost of a single handler call, in microseconds
+		double MoveUs = 0.0;
+		double LookUs = 0.0;
+		double JumpUs = 0.0;
+
+		// Average cost of one whole interaction: the handler plus applying it (trace and dispatch)
+		double InteractUs = 0.0;
+
+		// Average cost of applying one controller's gathered move/look/jump input
+		double ApplyUs = 0.0;
+
+		// Game frame time, in milliseconds
+		double AvgFrameMs = 0.0;
+		double P95FrameMs = 0.0;
+		double MaxFrameMs = 0.0;
+
+		// What P95FrameMs was checked against (0 = no budget for this count)
+		double BudgetMs = 0.0;
+		bool bWithinBudget = true;
+	};
+
+	FA1H_MarionetteBenchmark(UWorld* InWorld, const TArray<int32>& InCounts, int32 InFramesPerRun, bool bInQuitWhenDone);
+
+	virtual bool BeginRun() override { return BeginNextRun(); }
+	virtual bool TickRun(float DeltaTime) override;
+
+	// Spawns the marionettes for the next pass, returns false if there's nothing left to run
+	bool BeginNextRun();
+
+	// Calls every handler on every controller once and adds the time spent to the accumulators
+	void DriveHandlers();
+
+	void FinishRun();
+	void WriteResults() const;
+
+	TArray<int32> PendingCounts;
+	int32 FramesPerRun = 300;
+
+	// Per-run accumulators
+	int32 CurrentCount = 0;
+	int32 FrameIndex = 0;
+	uint64 MoveCycles = 0;
+	uint64 LookCycles = 0;
+	uint64 JumpCycles = 0;
+	uint64 InteractCycles = 0;
+	uint64 ApplyCycles = 0;
+	int64 MoveCalls = 0;
+	int64 LookCalls = 0;
+	int64 JumpCalls = 0;
+	int64 InteractCalls = 0;
+	int64 ApplyCalls = 0;
+	TArray<double> FrameTimesMs;
+
+	TArray<FRunResult> Results;
+};
+
+#endif // !UE_BUILD_SHIPPING
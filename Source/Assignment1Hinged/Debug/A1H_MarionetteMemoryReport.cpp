@@ -0,0 +1,345 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_MarionetteMemoryReport.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Assignment1Hinged.h"                  // For LogA1H and the LLM tags
+#include "Animation/AnimInstance.h"
+#include "Camera/CameraComponent.h"
+#include "Components/InputComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerInput.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace A1HMemoryReport
+{
+    static TAutoConsoleVariable<float> CVarBudgetKB(
+        TEXT("A1H.MemoryReport.BudgetKB"),
+        0.0f,
+        TEXT("Memory budget per marionette (character + controller) in KB for A1H.MemoryReport.Marionettes. 0 = no budget.\n")
+        TEXT("Checked against the LLM tracked total when running with -llm, and the object total otherwise."),
+        ECVF_Default);
+
+    // Rows of the object view, in report order
+    enum EObjectCategory
+    {
+        Actor,
+        Movement,
+        SpringArm,
+        Camera,
+        SkeletalMesh,
+        AnimInstance,
+        OtherComponents,
+        Controller,
+        Input,
+
+        NumObjectCategories
+    };
+
+    static const TCHAR* ObjectCategoryNames[NumObjectCategories] =
+    {
+        TEXT("Actor"),
+        TEXT("Movement"),
+        TEXT("SpringArm"),
+        TEXT("Camera"),
+        TEXT("SkeletalMesh"),
+        TEXT("AnimInstance"),
+        TEXT("OtherComponents"),
+        TEXT("Controller"),
+        TEXT("Input"),
+    };
+
+    // Rows of the LLM view, in the order ReadTrackedTags returns them. The first one is what the budget checks.
+    static const TCHAR* TrackedTagNames[] =
+    {
+        TEXT("LLM TrackedTotal"),
+        TEXT("LLM UObject"),
+        TEXT("LLM Animation"),
+        TEXT("LLM Physics"),
+        TEXT("LLM A1H/Marionette"),
+        TEXT("LLM A1H/Animation"),
+    };
+
+    // What "obj list" shows for an object: its own size and containers (Max), plus its exclusive resource size
+    static int64 GetObjectBytes(UObject* Object)
+    {
+        FArchiveCountMem Count(Object);
+        return static_cast<int64>(Count.GetMax()) + static_cast<int64>(Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive));
+    }
+
+    static void RunReportCommand(const TArray<FString>& Args, UWorld* World)
+    {
+        int32 MarionetteCount = 100;
+        int32 SettleFrames = 60;
+        bool bQuitWhenDone = false;
+
+        TArray<FString> Positional;
+        FA1H_HeadlessHarness::ParseArgs(Args, Positional, bQuitWhenDone);
+
+        if (Positional.IsValidIndex(0))
+        {
+            MarionetteCount = FMath::Max(1, FCString::Atoi(*Positional[0]));
+        }
+        if (Positional.IsValidIndex(1))
+        {
+            SettleFrames = FMath::Max(1, FCString::Atoi(*Positional[1]));
+        }
+
+        FA1H_MarionetteMemoryReport::Start(World, MarionetteCount, SettleFrames, bQuitWhenDone);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs ReportCommand(
+        TEXT("A1H.MemoryReport.Marionettes"),
+        TEXT("Spawns N marionettes and reports the memory one costs, by category, against A1H.MemoryReport.BudgetKB. Writes to Saved/Profiling/A1H.\n")
+        TEXT("Run with -llm for the tracked totals. Usage: A1H.MemoryReport.Marionettes [Marionettes=100] [SettleFrames=60] [quit]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunReportCommand));
+}
+
+#pragma region Lifetime
+void FA1H_MarionetteMemoryReport::Start(UWorld* World, int32 MarionetteCount, int32 SettleFrames, bool bQuitWhenDone)
+{
+    FA1H_HeadlessHarness::Start(TUniquePtr<FA1H_HeadlessHarness>(new FA1H_MarionetteMemoryReport(World, MarionetteCount, SettleFrames, bQuitWhenDone)));
+}
+
+FA1H_MarionetteMemoryReport::FA1H_MarionetteMemoryReport(UWorld* InWorld, int32 InMarionetteCount, int32 InSettleFrames, bool bInQuitWhenDone)
+    : FA1H_HeadlessHarness(InWorld, TEXT("A1H memory report"), bInQuitWhenDone)
+    , MarionetteCount(InMarionetteCount)
+    , SettleFrames(InSettleFrames)
+{
+}
+
+bool FA1H_MarionetteMemoryReport::BeginRun()
+{
+    // The primer loads everything the marionettes share, so none of that ends up in the per-marionette numbers
+    if (Marionettes.Spawn(World.Get(), 1) == 0)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H memory report: couldn't spawn a marionette."));
+        return false;
+    }
+
+    UE_LOG(LogA1H, Log, TEXT("A1H memory report: %d marionettes, LLM %s."), MarionetteCount, ReadTrackedTags().IsEmpty() ? TEXT("off (run with -llm for tracked totals)") : TEXT("on"));
+    return true;
+}
+
+#pragma endregion
+
+#pragma region Measuring
+bool FA1H_MarionetteMemoryReport::TickRun(float DeltaTime)
+{
+    // LLM totals are updated once per frame, after this ticker has run. Everything below therefore collects garbage
+    // on the last settle frame and only reads the tags on the frame after.
+    ++FramesInStage;
+    if (FramesInStage < SettleFrames)
+    {
+        return true;
+    }
+    if (FramesInStage == SettleFrames)
+    {
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, /*bPerformFullPurge*/ true);
+        return true;
+    }
+
+    if (Stage == EStage::Priming)
+    {
+        BaselineTags = ReadTrackedTags();
+        NumMeasured = Marionettes.Spawn(World.Get(), MarionetteCount);
+        Stage = EStage::Settling;
+        FramesInStage = 0;
+        return true;
+    }
+
+    MeasureObjects();
+    MeasureTrackedTags();
+    if (!CheckBudget())
+    {
+        SetFailed();
+    }
+
+    Marionettes.DespawnAll();
+    return false;
+}
+
+TArray<int64> FA1H_MarionetteMemoryReport::ReadTrackedTags()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+    if (FLowLevelMemTracker::IsEnabled())
+    {
+        FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+        return {
+            Tracker.GetTagAmountForTracker(ELLMTracker::Default, ELLMTag::TrackedTotal),
+            Tracker.GetTagAmountForTracker(ELLMTracker::Default, ELLMTag::UObject),
+            Tracker.GetTagAmountForTracker(ELLMTracker::Default, ELLMTag::Animation),
+            Tracker.GetTagAmountForTracker(ELLMTracker::Default, ELLMTag::Physics),
+            Tracker.GetTagAmountForTracker(ELLMTracker::Default, LLM_TAG_NAME(A1H_Marionette), ELLMTagSet::None),
+            Tracker.GetTagAmountForTracker(ELLMTracker::Default, LLM_TAG_NAME(A1H_Animation), ELLMTagSet::None),
+        };
+    }
+#endif
+    return {};
+}
+
+void FA1H_MarionetteMemoryReport::MeasureObjects()
+{
+    using namespace A1HMemoryReport;
+
+    int64 Totals[NumObjectCategories] = {};
+
+    // The primer (index 0) isn't measured. Each object is counted once, in the first category that claims it.
+    for (int32 Index = 1; Index < Marionettes.Num(); ++Index)
+    {
+        TSet<const UObject*> Counted;
+        auto Add = [&Totals, &Counted](EObjectCategory Category, UObject* Object)
+        {
+            if (!Object)
+            {
+                return;
+            }
+
+            bool bAlreadyCounted = false;
+            Counted.Add(Object, &bAlreadyCounted);
+            if (!bAlreadyCounted)
+            {
+                Totals[Category] += GetObjectBytes(Object);
+            }
+        };
+
+        if (AA1H_MarionetteCharacter* Character = Marionettes.Characters[Index].Get())
+        {
+            Add(Actor, Character);
+            Add(Movement, Character->GetCharacterMovement());
+            Add(SpringArm, Character->FindComponentByClass<USpringArmComponent>());
+            Add(Camera, Character->FindComponentByClass<UCameraComponent>());
+
+            if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+            {
+                Add(SkeletalMesh, Mesh);
+                Add(AnimInstance, Mesh->GetAnimInstance());
+                Add(AnimInstance, Mesh->GetPostProcessInstance());
+                for (UAnimInstance* LinkedInstance : Mesh->GetLinkedAnimInstances())
+                {
+                    Add(AnimInstance, LinkedInstance);
+                }
+            }
+
+            // Capsule, strings and whatever the Blueprint adds
+            Character->ForEachComponent(false, [&Add](UActorComponent* Component) { Add(OtherComponents, Component); });
+        }
+
+        if (AA1H_MarionetteController* Controller = Marionettes.Controllers[Index].Get())
+        {
+            // Headless controllers have no local player, so this is the controller-side input state only.
+            // The Enhanced Input subsystem belongs to the local player, not to a marionette.
+            Add(Input, Controller->InputComponent);
+            Add(Input, Controller->PlayerInput);
+            Add(A1HMemoryReport::Controller, Controller);
+            Controller->ForEachComponent(false, [&Add](UActorComponent* Component) { Add(A1HMemoryReport::Controller, Component); });
+        }
+    }
+
+    ObjectRows.Reset();
+    double ObjectTotal = 0.0;
+    for (int32 Category = 0; Category < NumObjectCategories; ++Category)
+    {
+        const double BytesPerMarionette = NumMeasured > 0 ? static_cast<double>(Totals[Category]) / NumMeasured : 0.0;
+        ObjectRows.Add({ ObjectCategoryNames[Category], BytesPerMarionette });
+        ObjectTotal += BytesPerMarionette;
+    }
+    ObjectRows.Add({ TEXT("ObjectsTotal"), ObjectTotal });
+}
+
+void FA1H_MarionetteMemoryReport::MeasureTrackedTags()
+{
+    TrackedRows.Reset();
+
+    const TArray<int64> CurrentTags = ReadTrackedTags();
+    if (CurrentTags.IsEmpty() || CurrentTags.Num() != BaselineTags.Num() || NumMeasured == 0)
+    {
+        return;
+    }
+
+    for (int32 Index = 0; Index < CurrentTags.Num(); ++Index)
+    {
+        TrackedRows.Add({ A1HMemoryReport::TrackedTagNames[Index], static_cast<double>(CurrentTags[Index] - BaselineTags[Index]) / NumMeasured });
+    }
+}
+
+bool FA1H_MarionetteMemoryReport::CheckBudget()
+{
+    const double BudgetBytes = A1HMemoryReport::CVarBudgetKB.GetValueOnGameThread() * 1024.0;
+
+    // The LLM total sees everything, the object total only what the objects report
+    const FCategoryBytes& Checked = TrackedRows.IsEmpty() ? ObjectRows.Last() : TrackedRows[0];
+    const bool bWithinBudget = BudgetBytes <= 0.0 || Checked.BytesPerMarionette <= BudgetBytes;
+
+    UE_LOG(LogA1H, Log, TEXT("A1H memory report: per marionette, over %d marionettes"), NumMeasured);
+    for (const FCategoryBytes& Row : ObjectRows)
+    {
+        UE_LOG(LogA1H, Log, TEXT("  %-20s %10.1f KB"), *Row.Category, Row.BytesPerMarionette / 1024.0);
+    }
+    for (const FCategoryBytes& Row : TrackedRows)
+    {
+        UE_LOG(LogA1H, Log, TEXT("  %-20s %10.1f KB"), *Row.Category, Row.BytesPerMarionette / 1024.0);
+    }
+
+    if (BudgetBytes <= 0.0)
+    {
+        UE_LOG(LogA1H, Log, TEXT("A1H memory report: no budget set (A1H.MemoryReport.BudgetKB)."));
+    }
+    else if (bWithinBudget)
+    {
+        UE_LOG(LogA1H, Log, TEXT("A1H memory report: %s %.1f KB is within the %.1f KB budget."), *Checked.Category, Checked.BytesPerMarionette / 1024.0, BudgetBytes / 1024.0);
+    }
+    else
+    {
+        UE_LOG(LogA1H, Error, TEXT("A1H memory report: %s %.1f KB is over the %.1f KB budget."), *Checked.Category, Checked.BytesPerMarionette / 1024.0, BudgetBytes / 1024.0);
+    }
+
+    WriteResults(BudgetBytes, Checked.BytesPerMarionette, bWithinBudget);
+    return bWithinBudget;
+}
+
+#pragma endregion
+
+#pragma region Output
+void FA1H_MarionetteMemoryReport::WriteResults(double BudgetBytes, double MeasuredBytes, bool bWithinBudget) const
+{
+    FString Csv = TEXT("Category,BytesPerMarionette\n");
+    FString Categories;
+    auto AddRows = [&Csv, &Categories](const TArray<FCategoryBytes>& Rows)
+    {
+        for (const FCategoryBytes& Row : Rows)
+        {
+            Csv += FString::Printf(TEXT("%s,%.1f\n"), *Row.Category, Row.BytesPerMarionette);
+            Categories += FString::Printf(TEXT("%s    \"%s\": %.1f"), Categories.IsEmpty() ? TEXT("") : TEXT(",\n"), *Row.Category, Row.BytesPerMarionette);
+        }
+    };
+    AddRows(ObjectRows);
+    AddRows(TrackedRows);
+
+    FString Json = TEXT("{\n");
+    Json += FString::Printf(TEXT("  \"build\": \"%s\",\n"), FApp::GetBuildVersion());
+    Json += FString::Printf(TEXT("  \"map\": \"%s\",\n"), World.IsValid() ? *World->GetMapName() : TEXT(""));
+    Json += FString::Printf(TEXT("  \"marionettes\": %d,\n"), NumMeasured);
+    Json += FString::Printf(TEXT("  \"llm\": %s,\n"), TrackedRows.IsEmpty() ? TEXT("false") : TEXT("true"));
+    Json += FString::Printf(TEXT("  \"budget_bytes\": %.0f,\n"), BudgetBytes);
+    Json += FString::Printf(TEXT("  \"measured_bytes\": %.1f,\n"), MeasuredBytes);
+    Json += FString::Printf(TEXT("  \"within_budget\": %s,\n"), bWithinBudget ? TEXT("true") : TEXT("false"));
+    Json += FString::Printf(TEXT("  \"bytes_per_marionette\": {\n%s\n  }\n"), *Categories);
+    Json += TEXT("}\n");
+
+    WriteReport(TEXT("MarionetteMemory"), Csv, Json);
+}
+
+#pragma endregion
+
+#endif // !UE_BUILD_SHIPPING
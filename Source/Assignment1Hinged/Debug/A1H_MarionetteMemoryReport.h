@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/A1H_HeadlessHarness.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Headless memory report: what one marionette (character, controller and everything they own) costs.
+ * Spawns one primer marionette first so the shared assets (mesh, anim class, input assets) are loaded and
+ * excluded, takes a baseline, spawns N more and lets them settle before measuring.
+ *
+ * Two views of the same marionettes:
+ *  - Per object category (actor, movement, spring arm, camera, skeletal mesh, anim instance, other components,
+ *    controller, input), counted like "obj list": the object's own size and containers plus its exclusive resource size.
+ *  - With -llm, the Low Level Memory tracker's growth per marionette: everything tracked, and the A1H and engine
+ *    tags most of it lands in. This also catches what objects don't report (anim proxies, physics bodies, render state).
+ *
+ * The result is checked against A1H.MemoryReport.BudgetKB (per marionette, 0 = no budget), using the LLM total when
+ * LLM is running and the object total otherwise. Over budget logs an error and, with "quit", exits with code 1,
+ * so a CI run fails. Results go to Saved/Profiling/A1H as CSV and JSON.
+ *
+ * Usage (e.g. -nullrhi -unattended -llm -ExecCmds="A1H.MemoryReport.Marionettes 200 60 quit"):
+ *   A1H.MemoryReport.Marionettes [Marionettes=100] [SettleFrames=60] [quit]
+ */
+class FA1H_MarionetteMemoryReport : public FA1H_HeadlessHarness
+{
+public:
+	// Kicks off a report in World. Only one headless run can go at a time.
+	static void Start(UWorld* World, int32 MarionetteCount, int32 SettleFrames, bool bQuitWhenDone);
+
+private:
+	enum class EStage : uint8
+	{
+		Priming,        // Waiting for the primer marionette's assets
+		Settling,       // Waiting for the measured marionettes to finish BeginPlay and asset callbacks
+	};
+
+	// One row of the report
+	struct FCategoryBytes
+	{
+		FString Category;
+		double BytesPerMarionette = 0.0;
+	};
+
+	FA1H_MarionetteMemoryReport(UWorld* InWorld, int32 InMarionetteCount, int32 InSettleFrames, bool bInQuitWhenDone);
+
+	virtual bool BeginRun() override;
+	virtual bool TickRun(float DeltaTime) override;
+
+	// Reads the LLM tags we report on, in the same order every time. Empty when LLM isn't running.
+	static TArray<int64> ReadTrackedTags();
+
+	// Per-object category totals, averaged over the measured marionettes
+	void MeasureObjects();
+
+	// LLM growth since the baseline, per measured marionette
+	void MeasureTrackedTags();
+
+	// Compares against the budget and writes everything out. True if within budget.
+	bool CheckBudget();
+	void WriteResults(double BudgetBytes, double MeasuredBytes, bool bWithinBudget) const;
+
+	int32 MarionetteCount = 100;
+	int32 SettleFrames = 60;
+
+	EStage Stage = EStage::Priming;
+	int32 FramesInStage = 0;
+
+	// The primer is the first of Marionettes and isn't measured
+	int32 NumMeasured = 0;
+
+	TArray<int64> BaselineTags;
+	TArray<FCategoryBytes> ObjectRows;
+	TArray<FCategoryBytes> TrackedRows;
+};
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_NetSoakReport.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Assignment1Hinged.h"      // For the interaction RPC totals
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace A1HNetSoak
+{
+    static void RunNetSoakCommand(const TArray<FString>& Args, UWorld* World)
+    {
+        if (!World || World->GetNetMode() == NM_Client || World->GetNetMode() == NM_Standalone)
+        {
+            UE_LOG(LogA1H, Warning, TEXT("A1H.NetSoak: has to run on a server."));
+            return;
+        }
+
+        float DurationSeconds = 60.0f;
+        bool bQuitWhenDone = false;
+
+        TArray<FString> Positional;
+        FA1H_HeadlessHarness::ParseArgs(Args, Positional, bQuitWhenDone);
+        if (Positional.Num() > 0)
+        {
+            DurationSeconds = FMath::Max(1.0f, FCString::Atof(*Positional[0]));
+        }
+
+        FA1H_NetSoakReport::Start(World, DurationSeconds, bQuitWhenDone);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs NetSoakCommand(
+        TEXT("A1H.NetSoak"),
+        TEXT("Samples server bandwidth, interaction RPCs and frame time, then writes a report to Saved/Profiling/A1H.\n")
+        TEXT("Usage: A1H.NetSoak [Seconds=60] [quit]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunNetSoakCommand));
+}
+
+#pragma region Lifetime
+void FA1H_NetSoakReport::Start(UWorld* World, float DurationSeconds, bool bQuitWhenDone)
+{
+    if (FA1H_HeadlessHarness::Start(TUniquePtr<FA1H_HeadlessHarness>(new FA1H_NetSoakReport(World, DurationSeconds, bQuitWhenDone))))
+    {
+        UE_LOG(LogA1H, Log, TEXT("A1H net soak: sampling for %.0f seconds."), DurationSeconds);
+    }
+}
+
+FA1H_NetSoakReport::FA1H_NetSoakReport(UWorld* InWorld, float InDurationSeconds, bool bInQuitWhenDone)
+    : FA1H_HeadlessHarness(InWorld, TEXT("A1H net soak"), bInQuitWhenDone)
+    , DurationSeconds(InDurationSeconds)
+{
+    A1HStats::GetInteractRequestTotals(StartAcceptedRequests, StartRejectedRequests);
+    Samples.Reserve(FMath::CeilToInt32(DurationSeconds));
+}
+
+#pragma endregion
+
+#pragma region Sampling
+bool FA1H_NetSoakReport::TickRun(float DeltaTime)
+{
+    // DeltaTime is the real time between server frames, which is the server frame time we care about
+    FrameTimesMs.Add(DeltaTime * 1000.0);
+    ElapsedSeconds += DeltaTime;
+    WindowSeconds += DeltaTime;
+    ++WindowFrames;
+
+    if (WindowSeconds >= 1.0f)
+    {
+        TakeSample();
+    }
+
+    if (ElapsedSeconds < DurationSeconds)
+    {
+        return true;
+    }
+
+    WriteResults();
+    return false;
+}
+
+void FA1H_NetSoakReport::TakeSample()
+{
+    FSample& Sample = Samples.AddDefaulted_GetRef();
+    Sample.Time = ElapsedSeconds;
+    Sample.AvgFrameMs = WindowFrames > 0 ? WindowSeconds * 1000.0 / WindowFrames : 0.0;
+
+    // The net driver already keeps per second byte rates, we just snapshot them
+    if (const UNetDriver* NetDriver = World->GetNetDriver())
+    {
+        Sample.Clients = NetDriver->ClientConnections.Num();
+        Sample.InBytesPerSecond = NetDriver->InBytesPerSecond;
+        Sample.OutBytesPerSecond = NetDriver->OutBytesPerSecond;
+    }
+
+    WindowSeconds = 0.0f;
+    WindowFrames = 0;
+}
+
+#pragma endregion
+
+#pragma region Results
+void FA1H_NetSoakReport::WriteResults() const
+{
+    FString Csv = TEXT("Time,Clients,InBytesPerSecond,OutBytesPerSecond,AvgFrameMs\n");
+    int32 MaxClients = 0;
+    double TotalIn = 0.0;
+    double TotalOut = 0.0;
+    double TotalOutPerClient = 0.0;
+    int32 SamplesWithClients = 0;
+
+    for (const FSample& Sample : Samples)
+    {
+        Csv += FString::Printf(TEXT("%.2f,%d,%u,%u,%.4f\n"), Sample.Time, Sample.Clients, Sample.InBytesPerSecond, Sample.OutBytesPerSecond, Sample.AvgFrameMs);
+
+        MaxClients = FMath::Max(MaxClients, Sample.Clients);
+        TotalIn += Sample.InBytesPerSecond;
+        TotalOut += Sample.OutBytesPerSecond;
+        if (Sample.Clients > 0)
+        {
+            TotalOutPerClient += static_cast<double>(Sample.OutBytesPerSecond) / Sample.Clients;
+            ++SamplesWithClients;
+        }
+    }
+
+    double AvgFrameMs = 0.0;
+    double P95FrameMs = 0.0;
+    double MaxFrameMs = 0.0;
+    Summarize(FrameTimesMs, AvgFrameMs, P95FrameMs, MaxFrameMs);
+
+    uint64 AcceptedRequests = 0;
+    uint64 RejectedRequests = 0;
+    A1HStats::GetInteractRequestTotals(AcceptedRequests, RejectedRequests);
+    AcceptedRequests -= StartAcceptedRequests;
+    RejectedRequests -= StartRejectedRequests;
+
+    const int32 NumSamples = FMath::Max(Samples.Num(), 1);
+    const FString Json = FString::Printf(
+        TEXT("{\n  \"seconds\": %.2f,\n  \"max_clients\": %d,\n  \"avg_in_bytes_per_second\": %.1f,\n  \"avg_out_bytes_per_second\": %.1f,\n")
+        TEXT("  \"avg_out_bytes_per_second_per_client\": %.1f,\n  \"interact_requests\": %llu,\n  \"interact_requests_rejected\": %llu,\n")
+        TEXT("  \"avg_frame_ms\": %.4f,\n  \"p95_frame_ms\": %.4f,\n  \"max_frame_ms\": %.4f\n}\n"),
+        ElapsedSeconds, MaxClients, TotalIn / NumSamples, TotalOut / NumSamples,
+        SamplesWithClients > 0 ? TotalOutPerClient / SamplesWithClients : 0.0,
+        AcceptedRequests + RejectedRequests, RejectedRequests,
+        AvgFrameMs, P95FrameMs, MaxFrameMs);
+
+    UE_LOG(LogA1H, Log, TEXT("A1H net soak: %d clients max, %.1f KB/s out, %.2f ms avg frame."),
+        MaxClients, TotalOut / NumSamples / 1024.0, AvgFrameMs);
+    WriteReport(TEXT("NetSoak"), Csv, Json);
+}
+
+#pragma endregion
+
+#endif // !UE_BUILD_SHIPPING
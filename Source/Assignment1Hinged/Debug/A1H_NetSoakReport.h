@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/A1H_HeadlessHarness.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Server side half of the multiplayer soak test.
+ * Samples the server's net driver once a second (connected clients, bytes in/out) and every frame's
+ * game time, counts interaction RPCs, and after the requested duration writes a CSV of the per-second
+ * samples plus a JSON summary to Saved/Profiling/A1H.
+ *
+ * Localhost soak (one dedicated server, N bot clients replaying a recorded input session in a loop):
+ *   Server:  UnrealEditor Assignment1Hinged.uproject /Game/TestingMap -server -log -ExecCmds="A1H.NetSoak 300 quit"
+ *   Bot x N: UnrealEditor Assignment1Hinged.uproject 127.0.0.1 -game -nullrhi -nosound -A1HReplayOnPossess=Soak -A1HLoopReplay
+ * Record the bot session beforehand with A1HRecordInput / A1HStopRecordInput Soak.
+ *
+ * Usage: A1H.NetSoak [Seconds=60] [quit]
+ */
+class FA1H_NetSoakReport : public FA1H_HeadlessHarness
+{
+public:
+	// Starts sampling World's net driver. Only one headless run can go at a time.
+	static void Start(UWorld* World, float DurationSeconds, bool bQuitWhenDone);
+
+private:
+	// One second worth of traffic
+	struct FSample
+	{
+		float Time = 0.0f;
+		int32 Clients = 0;
+		uint32 InBytesPerSecond = 0;
+		uint32 OutBytesPerSecond = 0;
+		double AvgFrameMs = 0.0;
+	};
+
+	FA1H_NetSoakReport(UWorld* InWorld, float InDurationSeconds, bool bInQuitWhenDone);
+
+	virtual bool TickRun(float DeltaTime) override;
+
+	// Reads the net driver and closes the current one second window
+	void TakeSample();
+
+	void WriteResults() const;
+
+	float DurationSeconds = 60.0f;
+
+	float ElapsedSeconds = 0.0f;
+	float WindowSeconds = 0.0f;
+	int32 WindowFrames = 0;
+
+	// Interaction RPC totals when the report started, so only this run's requests are reported
+	uint64 StartAcceptedRequests = 0;
+	uint64 StartRejectedRequests = 0;
+
+	TArray<FSample> Samples;
+	TArray<double> FrameTimesMs;
+};
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_StreamingReplayReport.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Assignment1Hinged.h"                  // For LogA1H
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionRuntimeCell.h"
+#include "WorldPartition/WorldPartitionRuntimeHash.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+
+namespace A1HStreamingReplay
+{
+    static void RunStreamingReplayCommand(const TArray<FString>& Args, UWorld* World)
+    {
+        float SprintSpeed = 1200.0f;
+        double HitchMs = 50.0;
+        bool bQuitWhenDone = false;
+
+        TArray<FString> Positional;
+        FA1H_HeadlessHarness::ParseArgs(Args, Positional, bQuitWhenDone);
+
+        if (Positional.IsEmpty())
+        {
+            UE_LOG(LogA1H, Warning, TEXT("A1H.StreamingReplay: which recording? Usage: A1H.StreamingReplay <Recording> [SprintSpeed=1200] [HitchMs=50] [quit]"));
+            return;
+        }
+
+        if (Positional.Num() > 1)
+        {
+            SprintSpeed = FMath::Max(1.0f, FCString::Atof(*Positional[1]));
+        }
+
+        if (Positional.Num() > 2)
+        {
+            HitchMs = FMath::Max(1.0, FCString::Atod(*Positional[2]));
+        }
+
+        FA1H_StreamingReplayReport::Start(World, Positional[0], SprintSpeed, HitchMs, bQuitWhenDone);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs StreamingReplayCommand(
+        TEXT("A1H.StreamingReplay"),
+        TEXT("Replays an input recording at sprint speed and reports hitch frames and World Partition cell time-to-loaded to Saved/Profiling/A1H.\n")
+        TEXT("Usage: A1H.StreamingReplay <Recording> [SprintSpeed=1200] [HitchMs=50] [quit]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunStreamingReplayCommand));
+}
+
+#pragma region Lifetime
+void FA1H_StreamingReplayReport::Start(UWorld* World, const FString& RecordingName, float SprintSpeed, double HitchMs, bool bQuitWhenDone)
+{
+    FA1H_HeadlessHarness::Start(TUniquePtr<FA1H_HeadlessHarness>(new FA1H_StreamingReplayReport(World, RecordingName, SprintSpeed, HitchMs, bQuitWhenDone)));
+}
+
+FA1H_StreamingReplayReport::FA1H_StreamingReplayReport(UWorld* InWorld, const FString& InRecordingName, float InSprintSpeed, double InHitchMs, bool bInQuitWhenDone)
+    : FA1H_HeadlessHarness(InWorld, TEXT("A1H streaming replay"), bInQuitWhenDone)
+    , RecordingName(InRecordingName)
+    , SprintSpeed(InSprintSpeed)
+    , HitchMs(InHitchMs)
+{
+}
+
+bool FA1H_StreamingReplayReport::BeginRun()
+{
+    UWorld* ReplayWorld = World.Get();
+    if (!ReplayWorld->GetWorldPartition())
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H streaming replay: %s doesn't use World Partition."), *ReplayWorld->GetMapName());
+        return false;
+    }
+
+    AA1H_MarionetteController* PlayerController = ReplayWorld->GetFirstPlayerController<AA1H_MarionetteController>();
+    AA1H_MarionetteCharacter* Marionette = PlayerController ? PlayerController->GetPawn<AA1H_MarionetteCharacter>() : nullptr;
+    if (!Marionette)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H streaming replay: no local player driving a marionette."));
+        return false;
+    }
+
+    PlayerController->A1HReplayInput(RecordingName);
+    if (!PlayerController->IsReplayingInput())
+    {
+        return false;
+    }
+
+    // The recorded path, just taken at sprint pace so streaming has to keep up
+    Controller = PlayerController;
+    PreviousMaxWalkSpeed = Marionette->GetCharacterMovement()->MaxWalkSpeed;
+    Marionette->GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
+
+    StartTime = LastFrameTime = FPlatformTime::Seconds();
+    SampleCells(StartTime, true);
+
+    UE_LOG(LogA1H, Log, TEXT("A1H streaming replay: replaying %s at %.0f cm/s, hitches over %.0f ms."), *RecordingName, SprintSpeed, HitchMs);
+    return true;
+}
+
+void FA1H_StreamingReplayReport::RestoreSpeed() const
+{
+    const AA1H_MarionetteController* PlayerController = Controller.Get();
+    if (AA1H_MarionetteCharacter* Marionette = PlayerController ? PlayerController->GetPawn<AA1H_MarionetteCharacter>() : nullptr)
+    {
+        Marionette->GetCharacterMovement()->MaxWalkSpeed = PreviousMaxWalkSpeed;
+    }
+}
+
+#pragma endregion
+
+#pragma region Sampling
+bool FA1H_StreamingReplayReport::TickRun(float DeltaTime)
+{
+    // The replay runs at a fixed time step, so DeltaTime is always the same. Hitches only show up in real time.
+    const double Now = FPlatformTime::Seconds();
+    const double FrameMs = (Now - LastFrameTime) * 1000.0;
+    FrameTimesMs.Add(FrameMs);
+    Hitches += FrameMs > HitchMs ? 1 : 0;
+
+    SampleCells(Now, false);
+    LastFrameTime = Now;
+
+    const AA1H_MarionetteController* PlayerController = Controller.Get();
+    if (PlayerController && PlayerController->IsReplayingInput())
+    {
+        return true;
+    }
+
+    RestoreSpeed();
+    WriteResults();
+    return false;
+}
+
+void FA1H_StreamingReplayReport::SampleCells(double Now, bool bInitial)
+{
+    UWorldPartitionSubsystem* WorldPartitionSubsystem = World->GetSubsystem<UWorldPartitionSubsystem>();
+    if (!WorldPartitionSubsystem)
+    {
+        return;
+    }
+
+    WorldPartitionSubsystem->ForEachWorldPartition([this, Now, bInitial](UWorldPartition* WorldPartition)
+    {
+        if (!WorldPartition->RuntimeHash)
+        {
+            return true;
+        }
+
+        WorldPartition->RuntimeHash->ForEachStreamingCells([this, Now, bInitial](const UWorldPartitionRuntimeCell* Cell)
+        {
+            FCellState& State = Cells.FindOrAdd(Cell);
+            const bool bLoaded = Cell->GetCurrentState() != EWorldPartitionRuntimeCellState::Unloaded;
+
+            if (bInitial)
+            {
+                State.Name = Cell->GetName();
+                State.bLoaded = bLoaded;
+            }
+            else if (bLoaded && !State.bLoaded)
+            {
+                // Went from nothing to loaded inside one frame if we never saw it streaming, so that frame is the best we know
+                FCellLoad& Load = Loads.AddDefaulted_GetRef();
+                Load.Name = State.Name.IsEmpty() ? Cell->GetName() : State.Name;
+                Load.RequestedTime = (State.RequestedTime >= 0.0 ? State.RequestedTime : LastFrameTime) - StartTime;
+                Load.LoadedTime = Now - StartTime;
+
+                State.bLoaded = true;
+                State.RequestedTime = -1.0;
+            }
+            else if (!bLoaded)
+            {
+                State.bLoaded = false;
+                if (State.RequestedTime < 0.0 && Cell->GetStreamingStatus() != LEVEL_Unloaded)
+                {
+                    State.RequestedTime = Now;
+                }
+            }
+            return true;
+        });
+        return true;
+    });
+}
+
+#pragma endregion
+
+#pragma region Results
+void FA1H_StreamingReplayReport::WriteResults() const
+{
+    FString Csv = TEXT("Cell,RequestedSeconds,LoadedSeconds,TimeToLoadedMs\n");
+    TArray<double> TimesToLoadedMs;
+    for (const FCellLoad& Load : Loads)
+    {
+        const double TimeToLoadedMs = (Load.LoadedTime - Load.RequestedTime) * 1000.0;
+        TimesToLoadedMs.Add(TimeToLoadedMs);
+        Csv += FString::Printf(TEXT("%s,%.3f,%.3f,%.2f\n"), *Load.Name, Load.RequestedTime, Load.LoadedTime, TimeToLoadedMs);
+    }
+
+    // Anything still on its way in when the path ended
+    int32 StillLoading = 0;
+    for (const TPair<TObjectKey<UWorldPartitionRuntimeCell>, FCellState>& Cell : Cells)
+    {
+        StillLoading += (!Cell.Value.bLoaded && Cell.Value.RequestedTime >= 0.0) ? 1 : 0;
+    }
+
+    double AvgFrameMs = 0.0;
+    double P95FrameMs = 0.0;
+    double MaxFrameMs = 0.0;
+    Summarize(FrameTimesMs, AvgFrameMs, P95FrameMs, MaxFrameMs);
+
+    double AvgLoadMs = 0.0;
+    double P95LoadMs = 0.0;
+    double MaxLoadMs = 0.0;
+    Summarize(TimesToLoadedMs, AvgLoadMs, P95LoadMs, MaxLoadMs);
+
+    const FString Json = FString::Printf(
+        TEXT("{\n  \"recording\": \"%s\",\n  \"sprint_speed\": %.1f,\n  \"seconds\": %.2f,\n  \"frames\": %d,\n")
+        TEXT("  \"hitch_ms\": %.1f,\n  \"hitches\": %d,\n  \"avg_frame_ms\": %.4f,\n  \"p95_frame_ms\": %.4f,\n  \"max_frame_ms\": %.4f,\n")
+        TEXT("  \"cells_loaded\": %d,\n  \"cells_still_loading\": %d,\n  \"avg_time_to_loaded_ms\": %.2f,\n  \"p95_time_to_loaded_ms\": %.2f,\n  \"max_time_to_loaded_ms\": %.2f\n}\n"),
+        *RecordingName, SprintSpeed, LastFrameTime - StartTime, FrameTimesMs.Num(),
+        HitchMs, Hitches, AvgFrameMs, P95FrameMs, MaxFrameMs,
+        Loads.Num(), StillLoading, AvgLoadMs, P95LoadMs, MaxLoadMs);
+
+    UE_LOG(LogA1H, Log, TEXT("A1H streaming replay: %d hitches in %d frames, %d cells loaded (p95 %.0f ms to loaded), %d still loading."),
+        Hitches, FrameTimesMs.Num(), Loads.Num(), P95LoadMs, StillLoading);
+    WriteReport(TEXT("StreamingReplay"), Csv, Json);
+}
+
+#pragma endregion
+
+#endif // !UE_BUILD_SHIPPING
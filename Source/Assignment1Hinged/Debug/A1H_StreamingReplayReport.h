@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Debug/A1H_HeadlessHarness.h"
+#include "UObject/ObjectKey.h"
+
+#if !UE_BUILD_SHIPPING
+
+class AA1H_MarionetteController;
+class UWorldPartitionRuntimeCell;
+
+/**
+ * Streaming test for the predictive World Partition source.
+ * Replays a recorded input session (A1HRecordInput / A1HStopRecordInput) on the local player's marionette with its
+ * walk speed raised to sprint speed, and while the path is followed counts hitch frames (real frame time over HitchMs)
+ * and times every World Partition cell from the moment it starts streaming in until it's loaded.
+ * Cells already loaded when the run starts aren't timed until they unload and come back.
+ * Writes one CSV row per cell load plus a JSON summary to Saved/Profiling/A1H.
+ *
+ * Usage (e.g. -game -ExecCmds="A1H.StreamingReplay Sprint quit"):
+ *   A1H.StreamingReplay <Recording> [SprintSpeed=1200] [HitchMs=50] [quit]
+ */
+class FA1H_StreamingReplayReport : public FA1H_HeadlessHarness
+{
+public:
+	// Starts the replay on World's first local player. Only one headless run can go at a time.
+	static void Start(UWorld* World, const FString& RecordingName, float SprintSpeed, double HitchMs, bool bQuitWhenDone);
+
+private:
+	// Where one cell is in its current load
+	struct FCellState
+	{
+		FString Name;
+		double RequestedTime = -1.0;    // When it was first seen streaming in, -1 while it isn't
+		bool bLoaded = false;
+	};
+
+	// One finished load
+	struct FCellLoad
+	{
+		FString Name;
+		double RequestedTime = 0.0;
+		double LoadedTime = 0.0;
+	};
+
+	FA1H_StreamingReplayReport(UWorld* InWorld, const FString& InRecordingName, float InSprintSpeed, double InHitchMs, bool bInQuitWhenDone);
+
+	virtual bool BeginRun() override;
+	virtual bool TickRun(float DeltaTime) override;
+
+	// Walks every streaming cell and records the ones that started or finished loading since last frame
+	void SampleCells(double Now, bool bInitial);
+
+	void RestoreSpeed() const;
+	void WriteResults() const;
+
+	FString RecordingName;
+	float SprintSpeed = 1200.0f;
+	double HitchMs = 50.0;
+
+	TWeakObjectPtr<AA1H_MarionetteController> Controller;
+	float PreviousMaxWalkSpeed = 0.0f;
+
+	double StartTime = 0.0;
+	double LastFrameTime = 0.0;
+	int32 Hitches = 0;
+	TArray<double> FrameTimesMs;
+
+	TMap<TObjectKey<UWorldPartitionRuntimeCell>, FCellState> Cells;
+	TArray<FCellLoad> Loads;
+};
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_InstancedInteractableManager.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Interaction/A1H_InteractableSubsystem.h" // Every instance gets its own index entry
+
+DECLARE_CYCLE_STAT(TEXT("Instanced Interaction"), STAT_A1H_InstancedInteraction, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Interactable Instances"), STAT_A1H_InteractableInstances, STATGROUP_A1H);
+
+AA1H_InstancedInteractableManager::AA1H_InstancedInteractableManager()
+{
+    // Nothing to do per frame, interactions come in as calls
+    PrimaryActorTick.bCanEverTick = false;
+
+#pragma region Create Instances
+    Instances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Instances"));
+    RootComponent = Instances;
+    // The interaction trace runs on Visibility, so the instances have to block it (and get per-instance bodies)
+    Instances->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+    Instances->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
+    // Custom data 0: how often the instance has been interacted with
+    Instances->NumCustomDataFloats = 1;
+
+#pragma endregion
+}
+
+#pragma region Lifetime
+void AA1H_InstancedInteractableManager::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (const UStaticMesh* Mesh = Instances->GetStaticMesh())
+    {
+        InstanceRadius = Mesh->GetBounds().SphereRadius;
+    }
+
+    SyncInstanceData();
+    for (int32 InstanceIndex = 0; InstanceIndex < InteractionCounts.Num(); ++InstanceIndex)
+    {
+        IndexInstance(InstanceIndex);
+    }
+}
+
+void AA1H_InstancedInteractableManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UA1H_InteractableSubsystem* InteractableIndex = GetWorld()->GetSubsystem<UA1H_InteractableSubsystem>())
+    {
+        InteractableIndex->UnregisterInteractableInstances(this);
+    }
+    DEC_DWORD_STAT_BY(STAT_A1H_InteractableInstances, InteractionCounts.Num());
+
+    Super::EndPlay(EndPlayReason);
+}
+
+#pragma endregion
+
+#pragma region Instances
+int32 AA1H_InstancedInteractableManager::AddInteractableInstance(const FTransform& WorldTransform)
+{
+    const int32 InstanceIndex = Instances->AddInstance(WorldTransform, /*bWorldSpace*/ true);
+    SyncInstanceData();
+
+    // Instances added before BeginPlay get indexed there with everything else
+    if (HasActorBegunPlay())
+    {
+        IndexInstance(InstanceIndex);
+    }
+    return InstanceIndex;
+}
+
+void AA1H_InstancedInteractableManager::SetInstanceEnabled(int32 InstanceIndex, bool bEnabled)
+{
+    if (EnabledInstances.IsValidIndex(InstanceIndex))
+    {
+        EnabledInstances[InstanceIndex] = bEnabled;
+    }
+}
+
+bool AA1H_InstancedInteractableManager::IsInstanceEnabled(int32 InstanceIndex) const
+{
+    return EnabledInstances.IsValidIndex(InstanceIndex) && EnabledInstances[InstanceIndex];
+}
+
+int32 AA1H_InstancedInteractableManager::GetInstanceInteractionCount(int32 InstanceIndex) const
+{
+    return InteractionCounts.IsValidIndex(InstanceIndex) ? InteractionCounts[InstanceIndex] : 0;
+}
+
+void AA1H_InstancedInteractableManager::SyncInstanceData()
+{
+    const int32 NumInstances = Instances->GetInstanceCount();
+    const int32 NumAdded = NumInstances - InteractionCounts.Num();
+    if (NumAdded <= 0)
+    {
+        return;
+    }
+
+    LLM_SCOPE_BYTAG(A1H_Interaction);
+    InteractionCounts.AddZeroed(NumAdded);
+    EnabledInstances.Add(true, NumAdded);
+    while (LastInteractionTimes.Num() < NumInstances)
+    {
+        LastInteractionTimes.Add(-UE_BIG_NUMBER);
+    }
+    INC_DWORD_STAT_BY(STAT_A1H_InteractableInstances, NumAdded);
+}
+
+void AA1H_InstancedInteractableManager::IndexInstance(int32 InstanceIndex)
+{
+    UA1H_InteractableSubsystem* InteractableIndex = GetWorld()->GetSubsystem<UA1H_InteractableSubsystem>();
+    FTransform InstanceTransform;
+    if (!InteractableIndex || !Instances->GetInstanceTransform(InstanceIndex, InstanceTransform, /*bWorldSpace*/ true))
+    {
+        return;
+    }
+
+    InteractableIndex->RegisterInteractableInstance(this, InstanceIndex, InstanceTransform.GetLocation(),
+        InstanceRadius * InstanceTransform.GetMaximumAxisScale());
+}
+
+#pragma endregion
+
+#pragma region Interaction
+void AA1H_InstancedInteractableManager::Interact_Implementation(AActor* InteractorActor)
+{
+}
+
+void AA1H_InstancedInteractableManager::InteractInstance_Implementation(AActor* InteractorActor, int32 InstanceIndex)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InstancedInteraction);
+
+    if (!IsInstanceEnabled(InstanceIndex))
+    {
+        return;
+    }
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    if (Now - LastInteractionTimes[InstanceIndex] < InstanceCooldown)
+    {
+        return;
+    }
+
+    LastInteractionTimes[InstanceIndex] = Now;
+    const int32 Count = ++InteractionCounts[InstanceIndex];
+    Instances->SetCustomDataValue(InstanceIndex, 0, static_cast<float>(Count), /*bMarkRenderStateDirty*/ true);
+
+    OnInstanceInteracted.Broadcast(InstanceIndex, InteractorActor, Count);
+}
+
+#pragma endregion
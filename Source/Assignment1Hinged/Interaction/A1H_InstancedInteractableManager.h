@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Player/A1H_InteractionInterface.h"
+#include "A1H_InstancedInteractableManager.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FA1H_OnInstanceInteracted, int32, InstanceIndex, AActor*, InteractorActor, int32, InteractionCount);
+
+/**
+ * Lots of interactable props (e.g. interaction cubes) as one actor and one hierarchical instanced mesh.
+ * Paint or place the instances on the Instances component, or add them at runtime. Each instance is indexed
+ * separately in UA1H_InteractableSubsystem, and an interaction trace that hits one arrives here through
+ * InteractInstance with the hit's instance index - no actor, component or tick per prop.
+ * Per-instance state lives in flat arrays indexed like the instances. The interaction count is also written
+ * to per-instance custom data float 0, so the material can react without any Blueprint work.
+ * State is local to the machine that ran the interaction (the server, in networked games).
+ */
+UCLASS()
+class ASSIGNMENT1HINGED_API AA1H_InstancedInteractableManager : public AActor, public IA1H_InteractionInterface
+{
+	GENERATED_BODY()
+
+public:
+	AA1H_InstancedInteractableManager();
+
+protected:
+	// Sizes the per-instance arrays and indexes every instance
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#pragma region Components
+	// Instances: every interactable prop this actor stands in for
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UHierarchicalInstancedStaticMeshComponent* Instances;
+
+#pragma endregion
+
+public:
+#pragma region Instances
+	// Adds an interactable instance at a world transform and returns its index
+	UFUNCTION(BlueprintCallable, Category = "Interaction|Instanced")
+	int32 AddInteractableInstance(const FTransform& WorldTransform);
+
+	// Disabled instances stay visible but ignore interactions
+	UFUNCTION(BlueprintCallable, Category = "Interaction|Instanced")
+	void SetInstanceEnabled(int32 InstanceIndex, bool bEnabled);
+
+	UFUNCTION(BlueprintPure, Category = "Interaction|Instanced")
+	bool IsInstanceEnabled(int32 InstanceIndex) const;
+
+	// How often an instance has been interacted with
+	UFUNCTION(BlueprintPure, Category = "Interaction|Instanced")
+	int32 GetInstanceInteractionCount(int32 InstanceIndex) const;
+
+	UFUNCTION(BlueprintPure, Category = "Interaction|Instanced")
+	int32 GetNumInteractableInstances() const { return InteractionCounts.Num(); }
+
+	UHierarchicalInstancedStaticMeshComponent* GetInstances() const { return Instances; }
+
+#pragma endregion
+
+#pragma region Interaction
+	// Seconds an instance ignores further interactions after one (0 = never)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction|Instanced", meta = (ClampMin = "0.0"))
+	float InstanceCooldown = 0.0f;
+
+	// Fires for every interaction an instance accepted
+	UPROPERTY(BlueprintAssignable, Category = "Interaction|Instanced")
+	FA1H_OnInstanceInteracted OnInstanceInteracted;
+
+	// Hits without an instance (shouldn't happen, the mesh is all there is) don't do anything
+	virtual void Interact_Implementation(AActor* InteractorActor) override;
+
+	virtual void InteractInstance_Implementation(AActor* InteractorActor, int32 InstanceIndex) override;
+
+#pragma endregion
+
+private:
+	// Grows the per-instance arrays to the mesh's instance count
+	void SyncInstanceData();
+
+	// Adds an instance to the world's interactable index
+	void IndexInstance(int32 InstanceIndex);
+
+	// Per-instance state, indexed like the mesh instances
+	TArray<int32> InteractionCounts;
+	TArray<double> LastInteractionTimes;
+	TBitArray<> EnabledInstances;
+
+	// Bounding radius of one instance at scale 1, from the mesh
+	float InstanceRadius = 0.0f;
+};
@@ -0,0 +1,534 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_InteractableSubsystem.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "Engine/World.h"
+#include "EngineUtils.h"                        // For TActorIterator
+#include "Engine/Level.h"
+#include "Player/A1H_InteractionInterface.h"    // So we know what counts as an interactable
+#include "Interaction/A1H_InstancedInteractableManager.h" // Indexes its instances itself
+
+DECLARE_CYCLE_STAT(TEXT("Interactable Index Query"), STAT_A1H_InteractableIndexQuery, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Indexed Interactables"), STAT_A1H_IndexedInteractables, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Interactable Index Level Streaming"), STAT_A1H_InteractableIndexStreaming, STATGROUP_A1H);
+
+#pragma region Subsystem Lifetime
+void UA1H_InteractableSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    UWorld* World = GetWorld();
+    check(World);
+
+    // Catch interactables spawned at runtime and drop them again when they're destroyed
+    ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UA1H_InteractableSubsystem::HandleActorSpawned));
+    ActorDestroyedHandle = World->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UA1H_InteractableSubsystem::HandleActorDestroyed));
+
+    // Same again for actors arriving and leaving with streamed cells
+    LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UA1H_InteractableSubsystem::HandleLevelAddedToWorld);
+    LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UA1H_InteractableSubsystem::HandleLevelRemovedFromWorld);
+}
+
+void UA1H_InteractableSubsystem::Deinitialize()
+{
+    if (UWorld* World = GetWorld())
+    {
+        World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+        World->RemoveOnActorDestroyededHandler(ActorDestroyedHandle);
+    }
+    FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+    FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+    ResetIndex();
+
+    Super::Deinitialize();
+}
+
+void UA1H_InteractableSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Everything placed in the level is already loaded by now, so index it in one go
+    RegisterExistingActors();
+}
+
+bool UA1H_InteractableSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    // Only worlds that actually play need an index (no editor preview worlds)
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+#pragma endregion
+
+#pragma region Registration
+void UA1H_InteractableSubsystem::RegisterInteractable(AActor* Interactable)
+{
+    if (!IA1H_InteractionInterface::IsInteractable(Interactable))
+    {
+        return;
+    }
+
+    // Instanced interactables register each instance on their own in BeginPlay
+    if (Interactable->IsA<AA1H_InstancedInteractableManager>())
+    {
+        return;
+    }
+
+    // Already in there? Just refresh its position instead.
+    if (EntryLookup.Contains(Interactable))
+    {
+        UpdateInteractable(Interactable);
+        return;
+    }
+
+    // Only use colliding components for the bounds - that's what the occlusion trace will hit anyway
+    FVector Origin;
+    FVector Extent;
+    Interactable->GetActorBounds(true, Origin, Extent);
+    const float Radius = FMath::Max(Extent.Size(), 1.0f);
+
+    EntryLookup.Add(Interactable, AddEntry(Interactable, INDEX_NONE, Origin, Radius));
+    WatchTransform(Interactable);
+
+    // Only the server decides how often (and to whom) an interactable replicates.
+    // Never raise anything a designer already set lower.
+    if (Interactable->GetIsReplicated() && Interactable->HasAuthority() && GetWorld()->GetNetMode() != NM_Standalone)
+    {
+        Interactable->SetNetUpdateFrequency(FMath::Min(Interactable->GetNetUpdateFrequency(), InteractableNetUpdateFrequency));
+        Interactable->SetMinNetUpdateFrequency(FMath::Min(Interactable->GetMinNetUpdateFrequency(), Interactable->GetNetUpdateFrequency()));
+        Interactable->SetNetCullDistanceSquared(FMath::Min(Interactable->GetNetCullDistanceSquared(), FMath::Square(InteractableNetCullDistance)));
+    }
+}
+
+void UA1H_InteractableSubsystem::UnregisterInteractable(AActor* Interactable)
+{
+    int32 EntryIndex = INDEX_NONE;
+    if (EntryLookup.RemoveAndCopyValue(Interactable, EntryIndex))
+    {
+        UnwatchTransform(Interactable);
+        RemoveEntry(EntryIndex);
+        return;
+    }
+
+    // Destroyed (or streamed out) instanced interactables take their instances with them
+    UnregisterInteractableInstances(Interactable);
+}
+
+void UA1H_InteractableSubsystem::RegisterInteractableInstance(AActor* Owner, int32 InstanceIndex, const FVector& Location, float Radius)
+{
+    if (!Owner || InstanceIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    TMap<int32, int32>& Instances = InstanceLookup.FindOrAdd(Owner);
+    if (const int32* ExistingEntry = Instances.Find(InstanceIndex))
+    {
+        RemoveEntry(*ExistingEntry);
+    }
+
+    // RemoveEntry may have moved another instance of the same owner, so look the map up again
+    const int32 EntryIndex = AddEntry(Owner, InstanceIndex, Location, FMath::Max(Radius, 1.0f));
+    InstanceLookup.FindChecked(Owner).Add(InstanceIndex, EntryIndex);
+}
+
+void UA1H_InteractableSubsystem::UnregisterInteractableInstance(AActor* Owner, int32 InstanceIndex)
+{
+    TMap<int32, int32>* Instances = InstanceLookup.Find(Owner);
+    int32 EntryIndex = INDEX_NONE;
+    if (!Instances || !Instances->RemoveAndCopyValue(InstanceIndex, EntryIndex))
+    {
+        return;
+    }
+
+    if (Instances->IsEmpty())
+    {
+        InstanceLookup.Remove(Owner);
+    }
+    RemoveEntry(EntryIndex);
+}
+
+void UA1H_InteractableSubsystem::UnregisterInteractableInstances(AActor* Owner)
+{
+    const TMap<int32, int32>* Instances = InstanceLookup.Find(Owner);
+    if (!Instances)
+    {
+        return;
+    }
+
+    // Every removal can move another of our entries into the hole, so go by instance and look each one up as we go
+    TArray<int32> InstanceIndices;
+    Instances->GenerateKeyArray(InstanceIndices);
+    for (const int32 InstanceIndex : InstanceIndices)
+    {
+        UnregisterInteractableInstance(Owner, InstanceIndex);
+    }
+}
+
+void UA1H_InteractableSubsystem::UpdateInteractable(AActor* Interactable)
+{
+    const int32* EntryIndexPtr = EntryLookup.Find(Interactable);
+    if (!EntryIndexPtr)
+    {
+        RegisterInteractable(Interactable);
+        return;
+    }
+
+    const int32 EntryIndex = *EntryIndexPtr;
+    check(EntryInstances[EntryIndex] == INDEX_NONE);
+
+    FVector Origin;
+    FVector Extent;
+    Interactable->GetActorBounds(true, Origin, Extent);
+    const float OldRadius = EntryRadii[EntryIndex];
+    EntryLocations[EntryIndex] = Origin;
+    EntryRadii[EntryIndex] = FMath::Max(Extent.Size(), 1.0f);
+    if (EntryRadii[EntryIndex] >= MaxEntryRadius)
+    {
+        MaxEntryRadius = EntryRadii[EntryIndex];
+    }
+    else if (OldRadius >= MaxEntryRadius)
+    {
+        // The biggest one just got smaller, so something else may be the biggest now
+        RecomputeMaxEntryRadius();
+    }
+
+    // Only touch the buckets if it actually crossed into another cell
+    const FIntVector NewCell = GetCellCoord(Origin);
+    if (NewCell != EntryCells[EntryIndex])
+    {
+        RemoveFromCell(EntryIndex);
+        EntryCells[EntryIndex] = NewCell;
+        AddToCell(EntryIndex);
+    }
+}
+
+void UA1H_InteractableSubsystem::WatchTransform(AActor* Interactable)
+{
+    // Static and stationary roots can't move, so they never need re-bucketing
+    USceneComponent* Root = Interactable->GetRootComponent();
+    if (Root && Root->Mobility == EComponentMobility::Movable)
+    {
+        Root->TransformUpdated.AddUObject(this, &UA1H_InteractableSubsystem::HandleInteractableMoved);
+    }
+}
+
+void UA1H_InteractableSubsystem::UnwatchTransform(AActor* Interactable)
+{
+    if (USceneComponent* Root = Interactable ? Interactable->GetRootComponent() : nullptr)
+    {
+        Root->TransformUpdated.RemoveAll(this);
+    }
+}
+
+void UA1H_InteractableSubsystem::HandleInteractableMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+    // Fires for direct moves, for parents moving us along and for physics syncing simulated bodies back
+    if (AActor* Interactable = UpdatedComponent->GetOwner())
+    {
+        UpdateInteractable(Interactable);
+    }
+}
+
+#pragma endregion
+
+#pragma region Queries
+AActor* UA1H_InteractableSubsystem::FindInteractableAlongRay(const FVector& Start, const FVector& Direction, float MaxDistance, const AActor* IgnoredActor, float& OutDistance) const
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InteractableIndexQuery);
+
+    if (EntryActors.IsEmpty())
+    {
+        return nullptr;
+    }
+
+    // Box around the whole ray, grown so big interactables in neighbouring cells still count
+    const FVector End = Start + Direction * MaxDistance;
+    const FVector Padding(MaxEntryRadius);
+    const FIntVector MinCell = GetCellCoord(Start.ComponentMin(End) - Padding);
+    const FIntVector MaxCell = GetCellCoord(Start.ComponentMax(End) + Padding);
+
+    AActor* BestActor = nullptr;
+    float BestDistanceAlongRay = TNumericLimits<float>::Max();
+    float FurthestExit = 0.0f;
+
+    for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+    {
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+        {
+            for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+            {
+                const TArray<int32>* Bucket = Cells.Find(FIntVector(X, Y, Z));
+                if (!Bucket)
+                {
+                    continue;
+                }
+
+                for (const int32 EntryIndex : *Bucket)
+                {
+                    // Ray vs bounding sphere: closest point on the ray to the centre
+                    const FVector ToCentre = EntryLocations[EntryIndex] - Start;
+                    const float DistanceAlongRay = FMath::Clamp(FVector::DotProduct(ToCentre, Direction), 0.0f, MaxDistance);
+                    const float MissDistanceSquared = (ToCentre - Direction * DistanceAlongRay).SizeSquared();
+                    const float Radius = EntryRadii[EntryIndex];
+
+                    if (MissDistanceSquared > FMath::Square(Radius))
+                    {
+                        continue;
+                    }
+
+                    AActor* Candidate = EntryActors[EntryIndex].Get();
+                    if (!Candidate || Candidate == IgnoredActor)
+                    {
+                        continue;
+                    }
+
+                    // Where the ray leaves this bounding sphere. The ray can go through a sphere and miss the mesh inside,
+                    // so the occlusion trace has to get through every grazed sphere, not just the closest one.
+                    const float HalfChord = FMath::Sqrt(FMath::Max(FMath::Square(Radius) - MissDistanceSquared, 0.0f));
+                    FurthestExit = FMath::Max(FurthestExit, FMath::Min(DistanceAlongRay + HalfChord, MaxDistance));
+
+                    if (DistanceAlongRay < BestDistanceAlongRay)
+                    {
+                        BestActor = Candidate;
+                        BestDistanceAlongRay = DistanceAlongRay;
+                    }
+                }
+            }
+        }
+    }
+
+    if (BestActor)
+    {
+        OutDistance = FurthestExit;
+    }
+
+    return BestActor;
+}
+
+int32 UA1H_InteractableSubsystem::GatherInteractablesInSphere(const FVector& Center, float Radius, const AActor* IgnoredActor, TArray<AActor*>& OutActors, TArray<FVector>& OutLocations, TArray<int32>* OutInstances) const
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InteractableIndexQuery);
+
+    const int32 NumBefore = OutActors.Num();
+    if (EntryActors.IsEmpty())
+    {
+        return 0;
+    }
+
+    // Same padding trick as the ray query
+    const FVector Extent(Radius + MaxEntryRadius);
+    const FIntVector MinCell = GetCellCoord(Center - Extent);
+    const FIntVector MaxCell = GetCellCoord(Center + Extent);
+
+    for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+    {
+        for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+        {
+            for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+            {
+                const TArray<int32>* Bucket = Cells.Find(FIntVector(X, Y, Z));
+                if (!Bucket)
+                {
+                    continue;
+                }
+
+                for (const int32 EntryIndex : *Bucket)
+                {
+                    // Sphere vs bounding sphere
+                    if (FVector::DistSquared(Center, EntryLocations[EntryIndex]) > FMath::Square(Radius + EntryRadii[EntryIndex]))
+                    {
+                        continue;
+                    }
+
+                    AActor* Candidate = EntryActors[EntryIndex].Get();
+                    if (!Candidate || Candidate == IgnoredActor)
+                    {
+                        continue;
+                    }
+
+                    OutActors.Add(Candidate);
+                    OutLocations.Add(EntryLocations[EntryIndex]);
+                    if (OutInstances)
+                    {
+                        OutInstances->Add(EntryInstances[EntryIndex]);
+                    }
+                }
+            }
+        }
+    }
+
+    return OutActors.Num() - NumBefore;
+}
+
+#pragma endregion
+
+#pragma region Grid Helpers
+FIntVector UA1H_InteractableSubsystem::GetCellCoord(const FVector& Location) const
+{
+    return FIntVector(
+        FMath::FloorToInt32(Location.X / CellSize),
+        FMath::FloorToInt32(Location.Y / CellSize),
+        FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void UA1H_InteractableSubsystem::AddToCell(int32 EntryIndex)
+{
+    Cells.FindOrAdd(EntryCells[EntryIndex]).Add(EntryIndex);
+}
+
+void UA1H_InteractableSubsystem::RemoveFromCell(int32 EntryIndex)
+{
+    const FIntVector Cell = EntryCells[EntryIndex];
+    TArray<int32>& Bucket = Cells.FindChecked(Cell);
+    Bucket.RemoveSingleSwap(EntryIndex, EAllowShrinking::No);
+
+    // Empty cells just cost lookups, so drop them
+    if (Bucket.IsEmpty())
+    {
+        Cells.Remove(Cell);
+    }
+}
+
+int32 UA1H_InteractableSubsystem::AddEntry(AActor* Actor, int32 InstanceIndex, const FVector& Location, float Radius)
+{
+    LLM_SCOPE_BYTAG(A1H_Interaction);
+
+    const int32 EntryIndex = EntryActors.Add(Actor);
+    EntryLocations.Add(Location);
+    EntryRadii.Add(Radius);
+    EntryCells.Add(GetCellCoord(Location));
+    EntryInstances.Add(InstanceIndex);
+    AddToCell(EntryIndex);
+
+    MaxEntryRadius = FMath::Max(MaxEntryRadius, Radius);
+    INC_DWORD_STAT(STAT_A1H_IndexedInteractables);
+    return EntryIndex;
+}
+
+void UA1H_InteractableSubsystem::RemoveEntry(int32 EntryIndex)
+{
+    RemoveFromCell(EntryIndex);
+    const float RemovedRadius = EntryRadii[EntryIndex];
+
+    // Swap the last entry into the hole so the arrays stay packed
+    const int32 LastIndex = EntryActors.Num() - 1;
+    if (EntryIndex != LastIndex)
+    {
+        TArray<int32>& LastBucket = Cells.FindChecked(EntryCells[LastIndex]);
+        LastBucket[LastBucket.IndexOfByKey(LastIndex)] = EntryIndex;
+
+        // Even if it's on its way out, its lookup has to stay right until it's unregistered too
+        if (AActor* MovedActor = EntryActors[LastIndex].Get(true))
+        {
+            if (EntryInstances[LastIndex] == INDEX_NONE)
+            {
+                EntryLookup.Add(MovedActor, EntryIndex);
+            }
+            else if (TMap<int32, int32>* Instances = InstanceLookup.Find(MovedActor))
+            {
+                Instances->Add(EntryInstances[LastIndex], EntryIndex);
+            }
+        }
+    }
+
+    EntryActors.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+    EntryLocations.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+    EntryRadii.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+    EntryCells.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+    EntryInstances.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+    DEC_DWORD_STAT(STAT_A1H_IndexedInteractables);
+
+    // Only the biggest one leaving can shrink the search padding
+    if (RemovedRadius >= MaxEntryRadius)
+    {
+        RecomputeMaxEntryRadius();
+    }
+}
+
+void UA1H_InteractableSubsystem::RecomputeMaxEntryRadius()
+{
+    MaxEntryRadius = 0.0f;
+    for (const float Radius : EntryRadii)
+    {
+        MaxEntryRadius = FMath::Max(MaxEntryRadius, Radius);
+    }
+}
+
+void UA1H_InteractableSubsystem::ResetIndex()
+{
+    for (const TPair<TObjectKey<AActor>, int32>& Entry : EntryLookup)
+    {
+        UnwatchTransform(Entry.Key.ResolveObjectPtr());
+    }
+
+    EntryActors.Reset();
+    EntryLocations.Reset();
+    EntryRadii.Reset();
+    EntryCells.Reset();
+    EntryInstances.Reset();
+    EntryLookup.Reset();
+    InstanceLookup.Reset();
+    Cells.Reset();
+    MaxEntryRadius = 0.0f;
+    SET_DWORD_STAT(STAT_A1H_IndexedInteractables, 0);
+}
+
+void UA1H_InteractableSubsystem::RegisterExistingActors()
+{
+    for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+    {
+        RegisterInteractable(*It);
+    }
+}
+
+void UA1H_InteractableSubsystem::HandleActorSpawned(AActor* SpawnedActor)
+{
+    RegisterInteractable(SpawnedActor);
+}
+
+void UA1H_InteractableSubsystem::HandleActorDestroyed(AActor* DestroyedActor)
+{
+    UnregisterInteractable(DestroyedActor);
+}
+
+void UA1H_InteractableSubsystem::HandleLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+    // The delegate is global, so ignore every other world
+    if (World != GetWorld() || !Level)
+    {
+        return;
+    }
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InteractableIndexStreaming);
+
+    for (AActor* Actor : Level->Actors)
+    {
+        RegisterInteractable(Actor);
+    }
+}
+
+void UA1H_InteractableSubsystem::HandleLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+    if (World != GetWorld())
+    {
+        return;
+    }
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InteractableIndexStreaming);
+
+    // A null level means everything is going away at once
+    if (!Level)
+    {
+        ResetIndex();
+        return;
+    }
+
+    for (AActor* Actor : Level->Actors)
+    {
+        UnregisterInteractable(Actor);
+    }
+}
+
+#pragma endregion
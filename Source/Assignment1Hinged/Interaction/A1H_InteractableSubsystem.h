@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "A1H_InteractableSubsystem.generated.h"
+
+/**
+ * World-level spatial index of every actor implementing IA1H_InteractionInterface.
+ * Interactables are bucketed into a uniform grid so an interaction lookup only has to
+ * look at the handful of cells around the player instead of asking physics about the whole world.
+ * Actors are picked up automatically when they spawn (or are already in the level at BeginPlay),
+ * and can also register/unregister themselves by hand from Blueprint or C++.
+ */
+UCLASS(Config = Game)
+class ASSIGNMENT1HINGED_API UA1H_InteractableSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Subsystem Lifetime
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+#pragma endregion
+
+public:
+#pragma region Registration
+	// Adds an interactable to the grid. Actors that don't implement the interaction interface are ignored.
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void RegisterInteractable(AActor* Interactable);
+
+	// Removes an interactable from the grid (safe to call for actors that were never registered).
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void UnregisterInteractable(AActor* Interactable);
+
+	// Re-buckets an interactable after it has moved. Interactables with a movable root are kept up to date
+	// automatically (moved, attached to something that moves or simulating physics), so this is only needed by hand
+	// for ones whose bounds change some other way.
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	void UpdateInteractable(AActor* Interactable);
+
+	// Adds one instance of an instanced interactable (AA1H_InstancedInteractableManager) as its own entry.
+	// Those actors aren't indexed as a whole, their bounds would cover every instance.
+	void RegisterInteractableInstance(AActor* Owner, int32 InstanceIndex, const FVector& Location, float Radius);
+
+	// Removes one instance again (safe to call for instances that were never registered)
+	void UnregisterInteractableInstance(AActor* Owner, int32 InstanceIndex);
+
+	// Removes every instance Owner registered
+	void UnregisterInteractableInstances(AActor* Owner);
+
+	// How many interactables (whole actors and instances) are currently indexed
+	UFUNCTION(BlueprintPure, Category = "Interaction")
+	int32 GetNumInteractables() const { return EntryActors.Num(); }
+
+#pragma endregion
+
+#pragma region Queries
+	/**
+	 * Finds the closest indexed interactable whose bounds are crossed by the ray Start -> Start + Direction * MaxDistance.
+	 * This is just the broad phase - callers still trace against physics to make sure nothing is in the way.
+	 * @param Start          Where the ray begins.
+	 * @param Direction      Normalized ray direction.
+	 * @param MaxDistance    Reach of the ray.
+	 * @param IgnoredActor   Actor to skip (usually the one doing the interacting).
+	 * @param OutDistance    How far along the ray the last bounds it crosses end (at most MaxDistance). Tracing that far reaches
+	 *                       every candidate, even when the ray misses the closest one's mesh. Untouched if nothing is found.
+	 * @return The interactable, or nullptr if nothing is in reach.
+	 */
+	AActor* FindInteractableAlongRay(const FVector& Start, const FVector& Direction, float MaxDistance, const AActor* IgnoredActor, float& OutDistance) const;
+
+	/**
+	 * Gathers every indexed interactable whose bounds overlap the sphere. Broad phase only, like FindInteractableAlongRay.
+	 * @param Center         Centre of the sphere.
+	 * @param Radius         Radius of the sphere.
+	 * @param IgnoredActor   Actor to skip (usually the one doing the interacting).
+	 * @param OutActors      Interactables found, appended to.
+	 * @param OutLocations   Centre of each interactable, same order as OutActors.
+	 * @param OutInstances   Optional. Instance index of each one (INDEX_NONE for whole actors), same order as OutActors.
+	 * @return How many interactables were appended.
+	 */
+	int32 GatherInteractablesInSphere(const FVector& Center, float Radius, const AActor* IgnoredActor, TArray<AActor*>& OutActors, TArray<FVector>& OutLocations, TArray<int32>* OutInstances = nullptr) const;
+
+#pragma endregion
+
+#pragma region Network Settings
+	// Replicated interactables are capped to this send rate when they're indexed on the server.
+	// They hardly ever change on their own, and an interaction forces an update straight away.
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction|Network")
+	float InteractableNetUpdateFrequency = 2.0f;
+
+	// Replicated interactables further than this from a player aren't relevant to them
+	UPROPERTY(Config, EditAnywhere, Category = "Interaction|Network")
+	float InteractableNetCullDistance = 5000.0f;
+
+#pragma endregion
+
+private:
+#pragma region Grid Helpers
+	FIntVector GetCellCoord(const FVector& Location) const;
+
+	// Puts EntryIndex into the bucket for its cell
+	void AddToCell(int32 EntryIndex);
+
+	// Pulls EntryIndex out of the bucket for its cell
+	void RemoveFromCell(int32 EntryIndex);
+
+	// Appends an entry to the arrays and its cell, returns its index
+	int32 AddEntry(AActor* Actor, int32 InstanceIndex, const FVector& Location, float Radius);
+
+	// Takes EntryIndex out of everything, swapping the last entry into its place
+	void RemoveEntry(int32 EntryIndex);
+
+	// Finds the biggest radius again after the biggest entry shrank or went away
+	void RecomputeMaxEntryRadius();
+
+	// Empties the whole grid
+	void ResetIndex();
+
+	// Registers every interactable that's already sitting in the world
+	void RegisterExistingActors();
+
+	// Follows interactables with a movable root around, and stops again
+	void WatchTransform(AActor* Interactable);
+	void UnwatchTransform(AActor* Interactable);
+	void HandleInteractableMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	void HandleActorSpawned(AActor* SpawnedActor);
+	void HandleActorDestroyed(AActor* DestroyedActor);
+
+	// World Partition cells (and any other streamed level) load and unload their actors without
+	// spawning or destroying them, so those come and go here instead
+	void HandleLevelAddedToWorld(ULevel* Level, UWorld* World);
+	void HandleLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+
+#pragma endregion
+
+	// Edge length of one grid cell. Should be comfortably bigger than InteractionDistance
+	// so that a lookup only ever touches a couple of cells.
+	float CellSize = 500.0f;
+
+	// Entries are stored as flat parallel arrays so the query loop only walks the data it needs.
+	TArray<TWeakObjectPtr<AActor>> EntryActors;
+	TArray<FVector> EntryLocations;
+	TArray<float> EntryRadii;
+	TArray<FIntVector> EntryCells;
+	TArray<int32> EntryInstances;   // INDEX_NONE for whole actors
+
+	// Actor -> entry index, for quick unregister/update
+	TMap<TObjectKey<AActor>, int32> EntryLookup;
+
+	// Instanced actor -> (instance -> entry index)
+	TMap<TObjectKey<AActor>, TMap<int32, int32>> InstanceLookup;
+
+	// Cell -> entries inside that cell
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	// Largest bounding radius currently indexed. Queries grow their search area by this much
+	// so big interactables whose centre sits in a neighbouring cell are still found.
+	float MaxEntryRadius = 0.0f;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
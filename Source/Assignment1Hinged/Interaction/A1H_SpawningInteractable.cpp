@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_SpawningInteractable.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+#include "Pooling/A1H_ActorPoolSubsystem.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawning Interaction"), STAT_A1H_SpawningInteraction, STATGROUP_A1H);
+
+AA1H_SpawningInteractable::AA1H_SpawningInteractable()
+{
+    // Spawns are retired by a timer, nothing to do per frame
+    PrimaryActorTick.bCanEverTick = false;
+
+#pragma region Create Collision
+    CollisionComp = CreateDefaultSubobject<UBoxComponent>(TEXT("CollisionComp"));
+    RootComponent = CollisionComp;
+    CollisionComp->SetBoxExtent(FVector(50.0f));
+    // The interaction trace runs on Visibility
+    CollisionComp->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+    CollisionComp->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
+
+#pragma endregion
+}
+
+void AA1H_SpawningInteractable::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    GetWorldTimerManager().ClearTimer(RetireTimerHandle);
+    for (const FLiveSpawn& Spawn : LiveSpawns)
+    {
+        if (AActor* Actor = Spawn.Actor.Get())
+        {
+            Retire(Actor);
+        }
+    }
+    LiveSpawns.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+#pragma region Interaction
+void AA1H_SpawningInteractable::Interact_Implementation(AActor* InteractorActor)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_SpawningInteraction);
+
+    if (!SpawnedClass)
+    {
+        return;
+    }
+
+    const FTransform SpawnTransform(GetActorRotation(), GetActorTransform().TransformPosition(SpawnOffset));
+    APawn* InstigatorPawn = Cast<APawn>(InteractorActor);
+
+    AActor* Spawned = nullptr;
+    UA1H_ActorPoolSubsystem* ActorPool = bUseActorPool ? GetWorld()->GetSubsystem<UA1H_ActorPoolSubsystem>() : nullptr;
+    if (ActorPool)
+    {
+        Spawned = ActorPool->AcquireActor(SpawnedClass, SpawnTransform, this, InstigatorPawn);
+    }
+    else
+    {
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.Owner = this;
+        SpawnParams.Instigator = InstigatorPawn;
+        SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+        Spawned = GetWorld()->SpawnActor<AActor>(SpawnedClass, SpawnTransform, SpawnParams);
+    }
+
+    if (!Spawned)
+    {
+        return;
+    }
+
+    LiveSpawns.Add({ Spawned, GetWorld()->GetTimeSeconds() + SpawnedLifetime });
+    if (!GetWorldTimerManager().IsTimerActive(RetireTimerHandle))
+    {
+        GetWorldTimerManager().SetTimer(RetireTimerHandle, this, &AA1H_SpawningInteractable::RetireExpired, FMath::Max(SpawnedLifetime, UE_KINDA_SMALL_NUMBER), false);
+    }
+}
+
+void AA1H_SpawningInteractable::RetireExpired()
+{
+    const double Now = GetWorld()->GetTimeSeconds();
+
+    int32 NumExpired = 0;
+    while (NumExpired < LiveSpawns.Num() && LiveSpawns[NumExpired].RetireTime <= Now)
+    {
+        if (AActor* Actor = LiveSpawns[NumExpired].Actor.Get())
+        {
+            Retire(Actor);
+        }
+        ++NumExpired;
+    }
+    LiveSpawns.RemoveAt(0, NumExpired, EAllowShrinking::No);
+
+    if (!LiveSpawns.IsEmpty())
+    {
+        const float Delay = static_cast<float>(LiveSpawns[0].RetireTime - Now);
+        GetWorldTimerManager().SetTimer(RetireTimerHandle, this, &AA1H_SpawningInteractable::RetireExpired, FMath::Max(Delay, UE_KINDA_SMALL_NUMBER), false);
+    }
+}
+
+void AA1H_SpawningInteractable::Retire(AActor* Actor) const
+{
+    // Checked again here rather than remembered per spawn, so flipping bUseActorPool at runtime doesn't leak anything:
+    // the pool adopts actors it didn't hand out
+    if (UA1H_ActorPoolSubsystem* ActorPool = bUseActorPool ? GetWorld()->GetSubsystem<UA1H_ActorPoolSubsystem>() : nullptr)
+    {
+        ActorPool->ReleaseActor(Actor);
+    }
+    else
+    {
+        Actor->Destroy();
+    }
+}
+
+#pragma endregion
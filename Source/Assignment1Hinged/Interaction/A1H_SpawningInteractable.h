@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Player/A1H_InteractionInterface.h"
+#include "A1H_SpawningInteractable.generated.h"
+
+class UBoxComponent;
+
+/**
+ * Interactable that spawns a short-lived actor (a pickup, an effect, a replacement prop) every time it's
+ * interacted with, and gets rid of it again after SpawnedLifetime seconds.
+ * With bUseActorPool the actors come from and go back to UA1H_ActorPoolSubsystem instead of being spawned
+ * and destroyed, which is the pattern Blueprint interactables should copy. Turning it off gives the old
+ * spawn/destroy behaviour for comparison (A1H.Benchmark.ActorPool runs both).
+ */
+UCLASS()
+class ASSIGNMENT1HINGED_API AA1H_SpawningInteractable : public AActor, public IA1H_InteractionInterface
+{
+	GENERATED_BODY()
+
+public:
+	AA1H_SpawningInteractable();
+
+protected:
+	// Hands back (or destroys) everything still alive
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#pragma region Components
+	// CollisionComp: what the interaction trace hits (blocks Visibility)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UBoxComponent* CollisionComp;
+
+#pragma endregion
+
+public:
+#pragma region Spawning
+	// Spawned on every interaction
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction|Spawning")
+	TSubclassOf<AActor> SpawnedClass;
+
+	// Where it's spawned, relative to this actor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction|Spawning")
+	FVector SpawnOffset = FVector(0.0f, 0.0f, 100.0f);
+
+	// Seconds each spawned actor stays around
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction|Spawning", meta = (ClampMin = "0.0"))
+	float SpawnedLifetime = 2.0f;
+
+	// Recycle spawned actors through the world's actor pool instead of spawning and destroying them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction|Spawning")
+	bool bUseActorPool = true;
+
+	virtual void Interact_Implementation(AActor* InteractorActor) override;
+
+	int32 GetNumLiveSpawns() const { return LiveSpawns.Num(); }
+
+#pragma endregion
+
+private:
+	struct FLiveSpawn
+	{
+		TWeakObjectPtr<AActor> Actor;
+		double RetireTime = 0.0;
+	};
+
+	// Retires everything whose lifetime is up and re-arms the timer for the next one
+	void RetireExpired();
+
+	// Back to the pool, or destroyed
+	void Retire(AActor* Actor) const;
+
+	// Oldest first. Every spawn lives equally long, so this is also retirement order.
+	TArray<FLiveSpawn> LiveSpawns;
+
+	// One timer for all of them, always set for the oldest
+	FTimerHandle RetireTimerHandle;
+};
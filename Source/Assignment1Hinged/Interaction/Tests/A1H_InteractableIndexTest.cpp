@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Interaction/A1H_InteractableSubsystem.h"
+#include "Interaction/A1H_SpawningInteractable.h"
+#include "Math/RandomStream.h"
+#include "Player/A1H_InteractionInterface.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace A1HInteractableIndexTest
+{
+    // Interactables in the world for each pass
+    static const int32 Counts[] = { 100, 1000, 10000 };
+
+    // Interaction checks per pass, each one done both ways
+    constexpr int32 Queries = 2000;
+
+    // AA1H_MarionetteCharacter's default reach
+    constexpr float InteractionDistance = 350.0f;
+
+    // Average distance between interactables. The level grows with the count, like a bigger map would.
+    constexpr float Spacing = 400.0f;
+
+    struct FPassResult
+    {
+        double TraceOnlyUs = 0.0;
+        double IndexUs = 0.0;
+        int32 TraceOnlyHits = 0;
+        int32 IndexHits = 0;
+        int32 Disagreements = 0;
+    };
+
+    // Both paths over the same rays, in a fresh world with Count interactables scattered through it
+    static FPassResult RunPass(FAutomationTestBase& Test, int32 Count)
+    {
+        FPassResult Result;
+
+        // Only needs physics and the world subsystems, so no game mode or BeginPlay
+        UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("A1H_InteractableIndexTest"));
+        UA1H_InteractableSubsystem* Index = World->GetSubsystem<UA1H_InteractableSubsystem>();
+        if (Test.TestNotNull(TEXT("Interactable index"), Index))
+        {
+            const float HalfSize = 0.5f * Spacing * FMath::Pow(static_cast<float>(Count), 1.0f / 3.0f);
+            const FBox Volume(FVector(-HalfSize), FVector(HalfSize));
+            FRandomStream Random(Count);
+
+            FActorSpawnParameters SpawnParams;
+            SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+            for (int32 Spawned = 0; Spawned < Count; ++Spawned)
+            {
+                World->SpawnActor<AA1H_SpawningInteractable>(AA1H_SpawningInteractable::StaticClass(), Random.RandPointInBox(Volume), FRotator::ZeroRotator, SpawnParams);
+            }
+            Test.TestEqual(TEXT("Indexed interactables"), Index->GetNumInteractables(), Count);
+
+            // Let physics pick the new bodies up before anything traces against them
+            World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+
+            TArray<FVector> Starts;
+            TArray<FVector> Directions;
+            for (int32 Query = 0; Query < Queries; ++Query)
+            {
+                Starts.Add(Random.RandPointInBox(Volume));
+                Directions.Add(Random.GetUnitVector());
+            }
+
+            TArray<AActor*> TraceOnlyFound;
+            TArray<AActor*> IndexFound;
+            TraceOnlyFound.SetNumZeroed(Queries);
+            IndexFound.SetNumZeroed(Queries);
+            const FCollisionQueryParams QueryParams(TEXT("A1H_InteractableIndexTest"));
+
+            // What PerformInteractionCheck did before the index: trace the full reach, then ask what was hit
+            uint64 StartCycles = FPlatformTime::Cycles64();
+            for (int32 Query = 0; Query < Queries; ++Query)
+            {
+                FHitResult Hit;
+                const FVector End = Starts[Query] + Directions[Query] * InteractionDistance;
+                if (World->LineTraceSingleByChannel(Hit, Starts[Query], End, ECC_Visibility, QueryParams) && IA1H_InteractionInterface::IsInteractable(Hit.GetActor()))
+                {
+                    TraceOnlyFound[Query] = Hit.GetActor();
+                }
+            }
+            Result.TraceOnlyUs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0 / Queries;
+
+            // What RunInteractionQuery does now: ask the index, and only trace (as far as the candidates' bounds reach) if it found something
+            StartCycles = FPlatformTime::Cycles64();
+            for (int32 Query = 0; Query < Queries; ++Query)
+            {
+                float DistanceToCandidate = InteractionDistance;
+                if (!Index->FindInteractableAlongRay(Starts[Query], Directions[Query], InteractionDistance, nullptr, DistanceToCandidate))
+                {
+                    continue;
+                }
+
+                FHitResult Hit;
+                const FVector End = Starts[Query] + Directions[Query] * DistanceToCandidate;
+                if (World->LineTraceSingleByChannel(Hit, Starts[Query], End, ECC_Visibility, QueryParams) && IA1H_InteractionInterface::IsInteractable(Hit.GetActor()))
+                {
+                    IndexFound[Query] = Hit.GetActor();
+                }
+            }
+            Result.IndexUs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0 / Queries;
+
+            // The index is only a shortcut, so every query has to end up with what the full trace found,
+            // including the ones where the index path found nothing (a missed interactable is the easy mistake to make)
+            for (int32 Query = 0; Query < Queries; ++Query)
+            {
+                Result.TraceOnlyHits += TraceOnlyFound[Query] ? 1 : 0;
+                Result.IndexHits += IndexFound[Query] ? 1 : 0;
+                Result.Disagreements += IndexFound[Query] != TraceOnlyFound[Query] ? 1 : 0;
+            }
+        }
+
+        World->DestroyWorld(false);
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+        return Result;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FA1H_InteractableIndexVsTraceTest, "A1H.Interaction.IndexVsTraceOnly",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FA1H_InteractableIndexVsTraceTest::RunTest(const FString& Parameters)
+{
+    using namespace A1HInteractableIndexTest;
+
+    for (const int32 Count : Counts)
+    {
+        const FPassResult Result = RunPass(*this, Count);
+
+        AddInfo(FString::Printf(TEXT("%6d interactables: trace-only %.2f us/check (%d hits), index %.2f us/check (%d hits), x%.1f"),
+            Count, Result.TraceOnlyUs, Result.TraceOnlyHits, Result.IndexUs, Result.IndexHits,
+            Result.IndexUs > 0.0 ? Result.TraceOnlyUs / Result.IndexUs : 0.0));
+
+        TestEqual(FString::Printf(TEXT("Checks where the index and the full trace found different things (%d interactables)"), Count), Result.Disagreements, 0);
+        TestEqual(FString::Printf(TEXT("Index hits vs full trace hits (%d interactables)"), Count), Result.IndexHits, Result.TraceOnlyHits);
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
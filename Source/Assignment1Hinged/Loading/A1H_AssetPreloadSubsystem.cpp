@@ -0,0 +1,248 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_AssetPreloadSubsystem.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"             // For the PreLoadMap/PostLoadMapWithWorld delegates
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Preload Assets In Flight"), STAT_A1H_PreloadAssetsInFlight, STATGROUP_A1H);
+
+#pragma region Subsystem Lifetime
+void UA1H_AssetPreloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UA1H_AssetPreloadSubsystem::HandlePreLoadMap);
+    PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UA1H_AssetPreloadSubsystem::HandlePostLoadMap);
+
+    // The very first map may already be on its way, so treat init as a map load start too
+    MapLoadStartTime = FPlatformTime::Seconds();
+    for (const FSoftObjectPath& Path : PreloadAssets)
+    {
+        StartLoad(Path, TEXT("Preload"));
+    }
+}
+
+void UA1H_AssetPreloadSubsystem::Deinitialize()
+{
+    FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+    FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+    for (TPair<FSoftObjectPath, FAssetRecord>& Pair : Records)
+    {
+        if (Pair.Value.Handle.IsValid())
+        {
+            Pair.Value.Handle->CancelHandle();
+        }
+    }
+    Records.Reset();
+    Waiters.Reset();
+    SET_DWORD_STAT(STAT_A1H_PreloadAssetsInFlight, 0);
+
+    Super::Deinitialize();
+}
+
+void UA1H_AssetPreloadSubsystem::HandlePreLoadMap(const FString& MapName)
+{
+    // A new startup to time. Anything still loaded from the last map shows up as already there.
+    LoadingMapName = MapName;
+    MapLoadStartTime = FPlatformTime::Seconds();
+    MapLoadedTime = -1.0;
+    bReportWritten = false;
+
+    // Get these streaming while the map itself loads
+    for (const FSoftObjectPath& Path : PreloadAssets)
+    {
+        StartLoad(Path, TEXT("Preload"));
+    }
+}
+
+void UA1H_AssetPreloadSubsystem::HandlePostLoadMap(UWorld* LoadedWorld)
+{
+    MapLoadedTime = FPlatformTime::Seconds();
+}
+
+#pragma endregion
+
+#pragma region Loading
+void UA1H_AssetPreloadSubsystem::RequestAssets(const TArray<FSoftObjectPath>& Paths, const FString& Requester, FSimpleDelegate OnLoaded)
+{
+    FWaiter& Waiter = Waiters.AddDefaulted_GetRef();
+    Waiter.OnLoaded = MoveTemp(OnLoaded);
+    for (const FSoftObjectPath& Path : Paths)
+    {
+        if (Path.IsValid())
+        {
+            Waiter.Paths.Add(Path);
+        }
+    }
+
+    // Copy, the waiter array can move if a load finishes synchronously and runs another request
+    const TArray<FSoftObjectPath> PathsToStart = Waiter.Paths;
+    for (const FSoftObjectPath& Path : PathsToStart)
+    {
+        StartLoad(Path, Requester);
+    }
+
+    FlushWaiters();
+}
+
+bool UA1H_AssetPreloadSubsystem::IsAssetReady(const FSoftObjectPath& Path) const
+{
+    const FAssetRecord* Record = Records.Find(Path);
+    return Record && Record->LoadedTime >= 0.0;
+}
+
+void UA1H_AssetPreloadSubsystem::StartLoad(const FSoftObjectPath& Path, const FString& Requester)
+{
+    if (!Path.IsValid())
+    {
+        return;
+    }
+
+    // Loading or loaded already. A failed one is dropped and tried again, it may have been a one-off.
+    if (const FAssetRecord* ExistingRecord = Records.Find(Path))
+    {
+        if (!ExistingRecord->bFailed)
+        {
+            return;
+        }
+        Records.Remove(Path);
+    }
+
+    FAssetRecord& Record = Records.Add(Path);
+    Record.Requester = Requester;
+    Record.RequestTime = FPlatformTime::Seconds();
+
+    // Always through the streamable manager, even when the asset is already in memory (it completes straight away then).
+    // Its handle is what keeps the asset resident; whatever else references it now may be gone after the next travel.
+    INC_DWORD_STAT(STAT_A1H_PreloadAssetsInFlight);
+
+    FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+    TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(
+        Path,
+        FStreamableDelegate::CreateUObject(this, &UA1H_AssetPreloadSubsystem::HandleAssetLoaded, Path),
+        FStreamableManager::AsyncLoadHighPriority);
+
+    // The callback can run inside RequestAsyncLoad, so look the record up again instead of holding on to it
+    if (FAssetRecord* StartedRecord = Records.Find(Path))
+    {
+        StartedRecord->Handle = Handle;
+
+        // No handle means the path couldn't even be requested. Count it as done so nobody hangs on it.
+        if (!Handle.IsValid() && StartedRecord->LoadedTime < 0.0)
+        {
+            HandleAssetLoaded(Path);
+        }
+    }
+}
+
+void UA1H_AssetPreloadSubsystem::HandleAssetLoaded(FSoftObjectPath Path)
+{
+    FAssetRecord* Record = Records.Find(Path);
+    if (!Record || Record->LoadedTime >= 0.0)
+    {
+        return;
+    }
+
+    Record->LoadedTime = FPlatformTime::Seconds();
+    Record->bFailed = Path.ResolveObject() == nullptr;
+    DEC_DWORD_STAT(STAT_A1H_PreloadAssetsInFlight);
+
+    if (Record->bFailed)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H preload: failed to load %s"), *Path.ToString());
+    }
+
+    FlushWaiters();
+}
+
+void UA1H_AssetPreloadSubsystem::FlushWaiters()
+{
+    // Pull the ready ones out first - their callbacks are allowed to request more assets
+    TArray<FSimpleDelegate, TInlineAllocator<4>> ReadyCallbacks;
+    for (int32 Index = Waiters.Num() - 1; Index >= 0; --Index)
+    {
+        const bool bAllReady = !Waiters[Index].Paths.ContainsByPredicate([this](const FSoftObjectPath& Path) { return !IsAssetReady(Path); });
+        if (bAllReady)
+        {
+            ReadyCallbacks.Add(MoveTemp(Waiters[Index].OnLoaded));
+            Waiters.RemoveAt(Index);
+        }
+    }
+
+    // Reverse again so callbacks run in request order
+    for (int32 Index = ReadyCallbacks.Num() - 1; Index >= 0; --Index)
+    {
+        ReadyCallbacks[Index].ExecuteIfBound();
+    }
+}
+
+#pragma endregion
+
+#pragma region Startup Report
+void UA1H_AssetPreloadSubsystem::MarkControllable()
+{
+    if (bReportWritten)
+    {
+        return;
+    }
+
+    bReportWritten = true;
+    WriteReport(FPlatformTime::Seconds());
+}
+
+void UA1H_AssetPreloadSubsystem::WriteReport(double ControllableTime) const
+{
+    auto ToMs = [this](double Time) { return (Time - MapLoadStartTime) * 1000.0; };
+
+    UE_LOG(LogA1H, Log, TEXT("A1H startup report for %s: map loaded at %.1f ms, controllable at %.1f ms"),
+        LoadingMapName.IsEmpty() ? TEXT("<first map>") : *LoadingMapName,
+        MapLoadedTime >= 0.0 ? ToMs(MapLoadedTime) : -1.0, ToMs(ControllableTime));
+
+    FString Csv = TEXT("Asset,Requester,RequestedMs,LoadedMs,LoadMs,Failed\n");
+
+    // Slowest first, that's what anyone reading this is looking for
+    TArray<const TPair<FSoftObjectPath, FAssetRecord>*> SortedRecords;
+    for (const TPair<FSoftObjectPath, FAssetRecord>& Pair : Records)
+    {
+        SortedRecords.Add(&Pair);
+    }
+    SortedRecords.Sort([](const TPair<FSoftObjectPath, FAssetRecord>& A, const TPair<FSoftObjectPath, FAssetRecord>& B)
+    {
+        return (A.Value.LoadedTime - A.Value.RequestTime) > (B.Value.LoadedTime - B.Value.RequestTime);
+    });
+
+    for (const TPair<FSoftObjectPath, FAssetRecord>* Pair : SortedRecords)
+    {
+        const FAssetRecord& Record = Pair->Value;
+
+        // Loaded for an earlier map, so it cost this startup nothing
+        const bool bCarriedOver = Record.LoadedTime >= 0.0 && Record.LoadedTime < MapLoadStartTime;
+        const double RequestedMs = bCarriedOver ? 0.0 : ToMs(Record.RequestTime);
+        const double LoadedMs = Record.LoadedTime < 0.0 ? -1.0 : (bCarriedOver ? 0.0 : ToMs(Record.LoadedTime));
+        const double LoadMs = Record.LoadedTime < 0.0 ? -1.0 : (bCarriedOver ? 0.0 : (Record.LoadedTime - Record.RequestTime) * 1000.0);
+
+        UE_LOG(LogA1H, Log, TEXT("  %-70s %-12s requested %8.1f ms  loaded %8.1f ms  (%.1f ms)%s"),
+            *Pair->Key.ToString(), *Record.Requester, RequestedMs, LoadedMs, LoadMs, Record.bFailed ? TEXT("  FAILED") : TEXT(""));
+
+        Csv += FString::Printf(TEXT("%s,%s,%.2f,%.2f,%.2f,%d\n"),
+            *Pair->Key.ToString(), *Record.Requester, RequestedMs, LoadedMs, LoadMs, Record.bFailed ? 1 : 0);
+    }
+
+    Csv += FString::Printf(TEXT("<map loaded>,,0.00,%.2f,,0\n"), MapLoadedTime >= 0.0 ? ToMs(MapLoadedTime) : -1.0);
+    Csv += FString::Printf(TEXT("<controllable>,,0.00,%.2f,,0\n"), ToMs(ControllableTime));
+
+    const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("A1H"), FString::Printf(TEXT("StartupReport-%s.csv"), *FDateTime::Now().ToString()));
+    FFileHelper::SaveStringToFile(Csv, *CsvPath);
+    UE_LOG(LogA1H, Log, TEXT("A1H startup report written to %s"), *CsvPath);
+}
+
+#pragma endregion
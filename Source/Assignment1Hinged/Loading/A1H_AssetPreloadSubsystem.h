@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/SoftObjectPath.h"
+#include "A1H_AssetPreloadSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Async preloading of the assets the marionette needs before it can be controlled.
+ * The PreloadAssets list from DefaultGame.ini starts streaming as soon as a map starts loading.
+ * The controller and character ask for their own (soft) assets when they begin play and get called back
+ * once everything is in memory - assets already in flight from the preload are simply joined.
+ * Once the controller reports the first controllable frame, a per-asset startup timing report is
+ * logged and written to Saved/Profiling/A1H.
+ * Every asset is held by its streamable handle, so loaded assets stay alive for the lifetime of the game instance.
+ */
+UCLASS(Config = Game)
+class ASSIGNMENT1HINGED_API UA1H_AssetPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Subsystem Lifetime
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+#pragma endregion
+
+#pragma region Loading
+	// Starts (or joins) async loads of Paths and calls OnLoaded once all of them are in memory.
+	// Calls straight back if they already are. Requester only shows up in the report.
+	void RequestAssets(const TArray<FSoftObjectPath>& Paths, const FString& Requester, FSimpleDelegate OnLoaded);
+
+	// True once the asset has finished loading (or failed to, so nobody waits forever). A failed asset is tried again
+	// the next time it's requested.
+	bool IsAssetReady(const FSoftObjectPath& Path) const;
+
+#pragma endregion
+
+#pragma region Startup Report
+	// Called by the controller on the first frame the player can actually drive the marionette.
+	// Only the first call after each map load produces a report.
+	void MarkControllable();
+
+#pragma endregion
+
+	// Started on every map load, before anything asks for them (controller/character Blueprints, input assets, ...)
+	UPROPERTY(Config)
+	TArray<FSoftObjectPath> PreloadAssets;
+
+private:
+	struct FAssetRecord
+	{
+		FString Requester;
+		double RequestTime = 0.0;
+		double LoadedTime = -1.0;
+		bool bFailed = false;
+		TSharedPtr<FStreamableHandle> Handle;
+	};
+
+	struct FWaiter
+	{
+		TArray<FSoftObjectPath> Paths;
+		FSimpleDelegate OnLoaded;
+	};
+
+	void HandlePreLoadMap(const FString& MapName);
+	void HandlePostLoadMap(UWorld* LoadedWorld);
+
+	// Kicks off a single asset, one handle each so every asset gets its own timing
+	void StartLoad(const FSoftObjectPath& Path, const FString& Requester);
+	void HandleAssetLoaded(FSoftObjectPath Path);
+
+	// Runs every waiter whose assets are all ready
+	void FlushWaiters();
+
+	void WriteReport(double ControllableTime) const;
+
+	TMap<FSoftObjectPath, FAssetRecord> Records;
+	TArray<FWaiter> Waiters;
+
+	FString LoadingMapName;
+	double MapLoadStartTime = 0.0;
+	double MapLoadedTime = -1.0;
+	bool bReportWritten = false;
+
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle PostLoadMapHandle;
+};
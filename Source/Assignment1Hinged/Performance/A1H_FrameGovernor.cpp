@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_FrameGovernor.h"
+
+void FA1H_FrameGovernor::Reset(const FA1H_FrameGovernorSettings& InSettings, int32 InNumLevels, int32 StartLevel)
+{
+    Settings = InSettings;
+    NumLevels = FMath::Max(InNumLevels, 1);
+    Level = FMath::Clamp(StartLevel, 0, NumLevels - 1);
+
+    Smoothed = FA1H_FrameTimings();
+    bHasSamples = false;
+    Bound = EA1H_FrameBound::None;
+    OverBudgetSeconds = 0.0f;
+    UnderBudgetSeconds = 0.0f;
+
+    // Allowed to react straight away after a reset
+    SecondsSinceChange = Settings.Cooldown;
+}
+
+int32 FA1H_FrameGovernor::Tick(const FA1H_FrameTimings& Timings, float DeltaSeconds)
+{
+    DeltaSeconds = FMath::Max(DeltaSeconds, 0.0f);
+
+    // Exponential moving average, frame rate independent
+    if (!bHasSamples)
+    {
+        Smoothed = Timings;
+        bHasSamples = true;
+    }
+    else
+    {
+        const float Alpha = Settings.SmoothingTime > 0.0f ? 1.0f - FMath::Exp(-DeltaSeconds / Settings.SmoothingTime) : 1.0f;
+        Smoothed.FrameMs = FMath::Lerp(Smoothed.FrameMs, Timings.FrameMs, Alpha);
+        Smoothed.GameThreadMs = FMath::Lerp(Smoothed.GameThreadMs, Timings.GameThreadMs, Alpha);
+        Smoothed.RenderThreadMs = FMath::Lerp(Smoothed.RenderThreadMs, Timings.RenderThreadMs, Alpha);
+        Smoothed.GpuMs = FMath::Lerp(Smoothed.GpuMs, Timings.GpuMs, Alpha);
+    }
+
+    SecondsSinceChange += DeltaSeconds;
+    Bound = ComputeBound();
+
+    // Over budget only counts when rendering is the problem. Dropping shadows won't fix a slow game thread.
+    const bool bOverBudget = Bound == EA1H_FrameBound::RenderThread || Bound == EA1H_FrameBound::Gpu;
+
+    // Under budget needs headroom on the whole frame and on the rendering side
+    const float UpshiftLimitMs = Settings.TargetFrameMs * (1.0f - Settings.UpshiftMargin);
+    const bool bUnderBudget = Smoothed.FrameMs < UpshiftLimitMs && FMath::Max(Smoothed.RenderThreadMs, Smoothed.GpuMs) < UpshiftLimitMs;
+
+    OverBudgetSeconds = bOverBudget ? OverBudgetSeconds + DeltaSeconds : 0.0f;
+    UnderBudgetSeconds = bUnderBudget ? UnderBudgetSeconds + DeltaSeconds : 0.0f;
+
+    if (SecondsSinceChange < Settings.Cooldown)
+    {
+        return Level;
+    }
+
+    int32 NewLevel = Level;
+    if (OverBudgetSeconds >= Settings.DownshiftDelay && Level < NumLevels - 1)
+    {
+        NewLevel = Level + 1;
+    }
+    else if (UnderBudgetSeconds >= Settings.UpshiftDelay && Level > 0)
+    {
+        NewLevel = Level - 1;
+    }
+
+    if (NewLevel != Level)
+    {
+        Level = NewLevel;
+        OverBudgetSeconds = 0.0f;
+        UnderBudgetSeconds = 0.0f;
+        SecondsSinceChange = 0.0f;
+    }
+
+    return Level;
+}
+
+EA1H_FrameBound FA1H_FrameGovernor::ComputeBound() const
+{
+    if (Smoothed.FrameMs <= Settings.TargetFrameMs * (1.0f + Settings.DownshiftMargin))
+    {
+        return EA1H_FrameBound::None;
+    }
+
+    // Whichever stage takes longest is the one the frame waits on
+    if (Smoothed.GameThreadMs >= Smoothed.RenderThreadMs && Smoothed.GameThreadMs >= Smoothed.GpuMs)
+    {
+        return EA1H_FrameBound::GameThread;
+    }
+    return Smoothed.GpuMs >= Smoothed.RenderThreadMs ? EA1H_FrameBound::Gpu : EA1H_FrameBound::RenderThread;
+}
+
+const TCHAR* FA1H_FrameGovernor::LexBound(EA1H_FrameBound InBound)
+{
+    switch (InBound)
+    {
+    case EA1H_FrameBound::GameThread:   return TEXT("GameThread");
+    case EA1H_FrameBound::RenderThread: return TEXT("RenderThread");
+    case EA1H_FrameBound::Gpu:          return TEXT("GPU");
+    default:                            return TEXT("None");
+    }
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One frame's worth of timings, in milliseconds
+struct FA1H_FrameTimings
+{
+	float FrameMs = 0.0f;
+	float GameThreadMs = 0.0f;
+	float RenderThreadMs = 0.0f;
+	float GpuMs = 0.0f;
+};
+
+// What's holding the frame back, judged from the smoothed timings
+enum class EA1H_FrameBound : uint8
+{
+	None,           // Within budget
+	GameThread,     // Rendering changes won't help
+	RenderThread,
+	Gpu
+};
+
+struct FA1H_FrameGovernorSettings
+{
+	// Frame time to hold
+	float TargetFrameMs = 1000.0f / 60.0f;
+
+	// Step down (cheaper) once the smoothed frame is this fraction over target...
+	float DownshiftMargin = 0.05f;
+
+	// ...for this long
+	float DownshiftDelay = 1.0f;
+
+	// Step back up once the smoothed frame has this fraction of headroom...
+	float UpshiftMargin = 0.2f;
+
+	// ...for this long. Longer than the downshift delay, going over budget is worse than running cheap a bit longer.
+	float UpshiftDelay = 4.0f;
+
+	// No further steps this long after a change, so the new level's timings can settle into the average
+	float Cooldown = 2.0f;
+
+	// Time constant of the exponential moving average over the timings
+	float SmoothingTime = 0.5f;
+};
+
+/**
+ * Decides which rung of a quality ladder to run at, given frame timings.
+ * Level 0 is the best quality, NumLevels - 1 the cheapest. Knows nothing about the engine or what a level
+ * actually changes (that's UA1H_FrameGovernorSubsystem's job), so it can be driven with synthetic timings,
+ * e.g. from A1H.FrameGovernor.Simulate in a -nullrhi run.
+ * Hysteresis comes from separate over/under thresholds, separate delays and a cooldown after every step.
+ */
+class ASSIGNMENT1HINGED_API FA1H_FrameGovernor
+{
+public:
+	// Starts over at StartLevel with fresh averages
+	void Reset(const FA1H_FrameGovernorSettings& InSettings, int32 InNumLevels, int32 StartLevel = 0);
+
+	// Feeds one frame and returns the level to run at from now on
+	int32 Tick(const FA1H_FrameTimings& Timings, float DeltaSeconds);
+
+	int32 GetLevel() const { return Level; }
+	int32 GetNumLevels() const { return NumLevels; }
+	EA1H_FrameBound GetBound() const { return Bound; }
+	const FA1H_FrameTimings& GetSmoothedTimings() const { return Smoothed; }
+
+	static const TCHAR* LexBound(EA1H_FrameBound InBound);
+
+private:
+	// Classifies Smoothed against the target
+	EA1H_FrameBound ComputeBound() const;
+
+	FA1H_FrameGovernorSettings Settings;
+	int32 NumLevels = 1;
+	int32 Level = 0;
+
+	FA1H_FrameTimings Smoothed;
+	bool bHasSamples = false;
+
+	EA1H_FrameBound Bound = EA1H_FrameBound::None;
+
+	// How long we've been continuously over/under budget, and since the last step
+	float OverBudgetSeconds = 0.0f;
+	float UnderBudgetSeconds = 0.0f;
+	float SecondsSinceChange = 0.0f;
+};
@@ -0,0 +1,261 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_FrameGovernorSubsystem.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "RenderCore.h"                         // For GGameThreadTime/GRenderThreadTime
+#include "RHI.h"                                // For RHIGetGPUFrameCycles
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Governor Level"), STAT_A1H_GovernorLevel, STATGROUP_A1H);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Smoothed Frame (ms)"), STAT_A1H_GovernorSmoothedFrameMs, STATGROUP_A1H);
+
+#pragma region Subsystem Lifetime
+bool UA1H_FrameGovernorSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    // Nothing to govern without a renderer, and PIE would fight the editor viewport for the same settings
+    return Super::ShouldCreateSubsystem(Outer) && bEnabled && FApp::CanEverRender() && (!GIsEditor || bRunInEditor);
+}
+
+void UA1H_FrameGovernorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    if (Levels.IsEmpty())
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H frame governor: no Levels configured, nothing to do."));
+        return;
+    }
+
+    // Start from whatever the player's scalability settings already are. Nothing is written until the governor
+    // decides to step, so the saved settings aren't overridden before anything has been measured.
+    AppliedLevel = FindCurrentLevel();
+    Governor.Reset(MakeGovernorSettings(), Levels.Num(), AppliedLevel);
+    SET_DWORD_STAT(STAT_A1H_GovernorLevel, AppliedLevel);
+    UE_LOG(LogA1H, Log, TEXT("A1H frame governor: starting at %s"), *Levels[AppliedLevel].Name);
+
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UA1H_FrameGovernorSubsystem::Tick));
+}
+
+void UA1H_FrameGovernorSubsystem::Deinitialize()
+{
+    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    RestoreConsoleVariables();
+    AppliedLevel = INDEX_NONE;
+    SET_DWORD_STAT(STAT_A1H_GovernorLevel, 0);
+
+    Super::Deinitialize();
+}
+
+FA1H_FrameGovernorSettings UA1H_FrameGovernorSubsystem::MakeGovernorSettings() const
+{
+    FA1H_FrameGovernorSettings Settings;
+    Settings.TargetFrameMs = TargetFrameMs;
+    Settings.DownshiftMargin = DownshiftMargin;
+    Settings.DownshiftDelay = DownshiftDelay;
+    Settings.UpshiftMargin = UpshiftMargin;
+    Settings.UpshiftDelay = UpshiftDelay;
+    Settings.Cooldown = Cooldown;
+    Settings.SmoothingTime = SmoothingTime;
+    return Settings;
+}
+
+#pragma endregion
+
+#pragma region Governing
+bool UA1H_FrameGovernorSubsystem::Tick(float DeltaTime)
+{
+    // Thread times exclude waiting, so a frame rate cap or vsync doesn't look like being over budget.
+    // The frame is only as fast as its slowest stage.
+    FA1H_FrameTimings Timings;
+    Timings.GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+    Timings.RenderThreadMs = FPlatformTime::ToMilliseconds(GRenderThreadTime);
+    Timings.GpuMs = FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles());
+    Timings.FrameMs = FMath::Max3(Timings.GameThreadMs, Timings.RenderThreadMs, Timings.GpuMs);
+
+    const int32 NewLevel = Governor.Tick(Timings, DeltaTime);
+    if (NewLevel != AppliedLevel)
+    {
+        const FA1H_FrameTimings& Smoothed = Governor.GetSmoothedTimings();
+        UE_LOG(LogA1H, Log, TEXT("A1H frame governor: %s -> %s (frame %.2f ms, game %.2f, render %.2f, GPU %.2f, bound: %s)"),
+            Levels.IsValidIndex(AppliedLevel) ? *Levels[AppliedLevel].Name : TEXT("<none>"), *Levels[NewLevel].Name,
+            Smoothed.FrameMs, Smoothed.GameThreadMs, Smoothed.RenderThreadMs, Smoothed.GpuMs, FA1H_FrameGovernor::LexBound(Governor.GetBound()));
+
+        ApplyLevel(NewLevel);
+    }
+
+    SET_FLOAT_STAT(STAT_A1H_GovernorSmoothedFrameMs, Governor.GetSmoothedTimings().FrameMs);
+    CSV_CUSTOM_STAT(A1H, GovernorLevel, AppliedLevel, ECsvCustomStatOp::Set);
+    return true;
+}
+
+int32 UA1H_FrameGovernorSubsystem::FindCurrentLevel() const
+{
+    IConsoleManager& ConsoleManager = IConsoleManager::Get();
+    auto GetInt = [&ConsoleManager](const TCHAR* Name, int32 Default)
+    {
+        const IConsoleVariable* Variable = ConsoleManager.FindConsoleVariable(Name);
+        return Variable ? Variable->GetInt() : Default;
+    };
+
+    // 0 or less means the engine picks, treat that as full resolution
+    const IConsoleVariable* ScreenPercentageVariable = ConsoleManager.FindConsoleVariable(TEXT("r.ScreenPercentage"));
+    const float ScreenPercentage = ScreenPercentageVariable && ScreenPercentageVariable->GetFloat() > 0.0f ? ScreenPercentageVariable->GetFloat() : 100.0f;
+    const int32 ShadowQuality = GetInt(TEXT("sg.ShadowQuality"), 3);
+    const int32 GlobalIlluminationQuality = GetInt(TEXT("sg.GlobalIlluminationQuality"), 3);
+    const int32 ReflectionQuality = GetInt(TEXT("sg.ReflectionQuality"), 3);
+
+    // Only the settings a level actually sets count. Free form ConsoleVariables can't be ranked, so they don't.
+    for (int32 LevelIndex = 0; LevelIndex < Levels.Num(); ++LevelIndex)
+    {
+        const FA1H_GovernorLevel& Level = Levels[LevelIndex];
+        if (Level.ScreenPercentage <= ScreenPercentage
+            && Level.ShadowQuality <= ShadowQuality
+            && Level.GlobalIlluminationQuality <= GlobalIlluminationQuality
+            && Level.ReflectionQuality <= ReflectionQuality)
+        {
+            return LevelIndex;
+        }
+    }
+    return Levels.Num() - 1;
+}
+
+void UA1H_FrameGovernorSubsystem::ApplyLevel(int32 LevelIndex)
+{
+    if (!Levels.IsValidIndex(LevelIndex))
+    {
+        return;
+    }
+
+    const FA1H_GovernorLevel& Level = Levels[LevelIndex];
+    if (Level.ScreenPercentage > 0.0f)
+    {
+        SetConsoleVariable(TEXT("r.ScreenPercentage"), FString::SanitizeFloat(Level.ScreenPercentage));
+    }
+    if (Level.ShadowQuality >= 0)
+    {
+        SetConsoleVariable(TEXT("sg.ShadowQuality"), FString::FromInt(Level.ShadowQuality));
+    }
+    if (Level.GlobalIlluminationQuality >= 0)
+    {
+        SetConsoleVariable(TEXT("sg.GlobalIlluminationQuality"), FString::FromInt(Level.GlobalIlluminationQuality));
+    }
+    if (Level.ReflectionQuality >= 0)
+    {
+        SetConsoleVariable(TEXT("sg.ReflectionQuality"), FString::FromInt(Level.ReflectionQuality));
+    }
+
+    for (const FString& Entry : Level.ConsoleVariables)
+    {
+        FString Name;
+        FString Value;
+        if (Entry.Split(TEXT("="), &Name, &Value))
+        {
+            SetConsoleVariable(Name.TrimStartAndEnd(), Value.TrimStartAndEnd());
+        }
+    }
+
+    AppliedLevel = LevelIndex;
+    SET_DWORD_STAT(STAT_A1H_GovernorLevel, LevelIndex);
+}
+
+void UA1H_FrameGovernorSubsystem::SetConsoleVariable(const FString& Name, const FString& Value)
+{
+    IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(*Name);
+    if (!Variable)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H frame governor: unknown console variable '%s'"), *Name);
+        return;
+    }
+
+    if (!OriginalValues.Contains(Name))
+    {
+        OriginalValues.Add(Name, Variable->GetString());
+    }
+
+    // Set by code outranks scalability and the user settings, so nothing else flips it back behind our back
+    Variable->Set(*Value, ECVF_SetByCode);
+}
+
+void UA1H_FrameGovernorSubsystem::RestoreConsoleVariables()
+{
+    for (const TPair<FString, FString>& Pair : OriginalValues)
+    {
+        if (IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(*Pair.Key))
+        {
+            Variable->Set(*Pair.Value, ECVF_SetByCode);
+        }
+    }
+    OriginalValues.Reset();
+}
+
+#pragma endregion
+
+#pragma region Simulation
+#if !UE_BUILD_SHIPPING
+namespace A1HFrameGovernor
+{
+    // Runs the configured governor against made up timings and logs every step it takes. Doesn't touch any
+    // settings, so it works headless (-nullrhi) as a quick check of the ladder and the hysteresis settings.
+    // GPU cost is modelled as scaling with the number of pixels, i.e. ScreenPercentage squared.
+    static void RunSimulateCommand(const TArray<FString>& Args)
+    {
+        const UA1H_FrameGovernorSubsystem* Config = GetDefault<UA1H_FrameGovernorSubsystem>();
+        if (Config->Levels.IsEmpty())
+        {
+            UE_LOG(LogA1H, Warning, TEXT("A1H.FrameGovernor.Simulate: no Levels configured."));
+            return;
+        }
+
+        const float TopLevelGpuMs = Args.IsValidIndex(0) ? FCString::Atof(*Args[0]) : 25.0f;
+        const float GameThreadMs = Args.IsValidIndex(1) ? FCString::Atof(*Args[1]) : 8.0f;
+        const float Seconds = Args.IsValidIndex(2) ? FMath::Max(FCString::Atof(*Args[2]), 1.0f) : 30.0f;
+        constexpr float StepSeconds = 1.0f / 60.0f;
+
+        // Effective screen percentage per level (-1 inherits from the level above)
+        TArray<float> ScreenPercentages;
+        float Current = 100.0f;
+        for (const FA1H_GovernorLevel& Level : Config->Levels)
+        {
+            Current = Level.ScreenPercentage > 0.0f ? Level.ScreenPercentage : Current;
+            ScreenPercentages.Add(Current);
+        }
+
+        FA1H_FrameGovernor Governor;
+        Governor.Reset(Config->MakeGovernorSettings(), Config->Levels.Num(), 0);
+
+        UE_LOG(LogA1H, Log, TEXT("A1H.FrameGovernor.Simulate: GPU %.2f ms at %s, game thread %.2f ms, %.0f s, target %.2f ms"),
+            TopLevelGpuMs, *Config->Levels[0].Name, GameThreadMs, Seconds, Config->TargetFrameMs);
+
+        int32 Level = 0;
+        for (float Time = 0.0f; Time < Seconds; Time += StepSeconds)
+        {
+            FA1H_FrameTimings Timings;
+            Timings.GameThreadMs = GameThreadMs;
+            Timings.RenderThreadMs = GameThreadMs;
+            Timings.GpuMs = TopLevelGpuMs * FMath::Square(ScreenPercentages[Level] / ScreenPercentages[0]);
+            Timings.FrameMs = FMath::Max3(Timings.GameThreadMs, Timings.RenderThreadMs, Timings.GpuMs);
+
+            const int32 NewLevel = Governor.Tick(Timings, StepSeconds);
+            if (NewLevel != Level)
+            {
+                UE_LOG(LogA1H, Log, TEXT("  %6.2f s: %s -> %s (smoothed frame %.2f ms, bound: %s)"),
+                    Time, *Config->Levels[Level].Name, *Config->Levels[NewLevel].Name,
+                    Governor.GetSmoothedTimings().FrameMs, FA1H_FrameGovernor::LexBound(Governor.GetBound()));
+                Level = NewLevel;
+            }
+        }
+
+        UE_LOG(LogA1H, Log, TEXT("A1H.FrameGovernor.Simulate: settled on %s"), *Config->Levels[Level].Name);
+    }
+
+    static FAutoConsoleCommand SimulateCommand(
+        TEXT("A1H.FrameGovernor.Simulate"),
+        TEXT("Feeds the frame governor synthetic timings and logs the levels it picks. Changes no settings.\n")
+        TEXT("Usage: A1H.FrameGovernor.Simulate [TopLevelGpuMs=25] [GameThreadMs=8] [Seconds=30]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunSimulateCommand));
+}
+#endif
+
+#pragma endregion
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Performance/A1H_FrameGovernor.h"
+#include "A1H_FrameGovernorSubsystem.generated.h"
+
+/**
+ * One rung of the governor's quality ladder. -1 leaves a setting alone.
+ */
+USTRUCT()
+struct FA1H_GovernorLevel
+{
+	GENERATED_BODY()
+
+	// Shows up in the log and CSV captures
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	FString Name;
+
+	// r.ScreenPercentage
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float ScreenPercentage = -1.0f;
+
+	// Scalability groups (sg.*), 0 = Low .. 3 = Epic
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	int32 ShadowQuality = -1;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	int32 GlobalIlluminationQuality = -1;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	int32 ReflectionQuality = -1;
+
+	// Anything else, as "Name=Value" (ray tracing toggles, virtual shadow maps, ...). Only runtime-changeable variables make sense here.
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	TArray<FString> ConsoleVariables;
+};
+
+/**
+ * Holds a target frame time by stepping through a quality ladder from DefaultGame.ini.
+ * Feeds frame, game thread, render thread and GPU timings into FA1H_FrameGovernor every frame and applies
+ * whatever level it settles on. Steps only ever go one rung at a time, and only for render/GPU bound frames.
+ * Starts on the rung that matches the current scalability settings without writing anything, so the player's
+ * saved settings stand until the governor actually has to step.
+ * Every console variable it touches is put back when the game instance shuts down.
+ */
+UCLASS(Config = Game)
+class ASSIGNMENT1HINGED_API UA1H_FrameGovernorSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Subsystem Lifetime
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+#pragma endregion
+
+	// Level currently applied (0 = top of the ladder)
+	int32 GetCurrentLevel() const { return Governor.GetLevel(); }
+
+	// Governor settings as configured, for tools that want to run their own copy
+	FA1H_FrameGovernorSettings MakeGovernorSettings() const;
+
+#pragma region Governor Settings
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	bool bEnabled = true;
+
+	// Also govern PIE sessions. Off by default, the editor viewport shares the same console variables.
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	bool bRunInEditor = false;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float TargetFrameMs = 1000.0f / 60.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float DownshiftMargin = 0.05f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float DownshiftDelay = 1.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float UpshiftMargin = 0.2f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float UpshiftDelay = 4.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float Cooldown = 2.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	float SmoothingTime = 0.5f;
+
+	// Best quality first
+	UPROPERTY(Config, EditAnywhere, Category = "Governor")
+	TArray<FA1H_GovernorLevel> Levels;
+
+#pragma endregion
+
+private:
+	bool Tick(float DeltaTime);
+
+	// Best level that doesn't go above the current scalability settings (the last one if they're all above)
+	int32 FindCurrentLevel() const;
+
+	// Pushes a level's settings into the console variables
+	void ApplyLevel(int32 LevelIndex);
+
+	// Sets a console variable, remembering its original value the first time
+	void SetConsoleVariable(const FString& Name, const FString& Value);
+
+	// Puts back everything SetConsoleVariable changed
+	void RestoreConsoleVariables();
+
+	FA1H_FrameGovernor Governor;
+	int32 AppliedLevel = INDEX_NONE;
+
+	TMap<FString, FString> OriginalValues;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
@@ -0,0 +1,400 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_InputLatencySubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Player/A1H_MarionetteCharacter.h"
+#include "Player/A1H_MarionetteController.h"
+#include "RenderingThread.h"                    // For ENQUEUE_RENDER_COMMAND
+
+DECLARE_CYCLE_STAT(TEXT("Input Latency Tracking"), STAT_A1H_InputLatencyTracking, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Input Latency Pending Samples"), STAT_A1H_InputLatencyPending, STATGROUP_A1H);
+
+namespace A1HInputLatency
+{
+    // An input the marionette hasn't reacted to after this long is dropped (walking into a wall, looking while paused, ...)
+    constexpr double MaxPendingSeconds = 0.5;
+
+    // Stick movement smaller than this doesn't count as a new move input
+    constexpr float MoveChangeTolerance = 0.1f;
+
+    // How much velocity (cm/s) or rotation (degrees) has to change to count as a reaction
+    constexpr float VelocityTolerance = 1.0f;
+    constexpr float RotationTolerance = 0.001f;
+
+    static const TCHAR* LexInput(EA1H_LatencyInput Input)
+    {
+        switch (Input)
+        {
+        case EA1H_LatencyInput::Move:   return TEXT("Move");
+        case EA1H_LatencyInput::Look:   return TEXT("Look");
+        case EA1H_LatencyInput::Jump:   return TEXT("Jump");
+        default:                        return TEXT("Unknown");
+        }
+    }
+
+    static const TCHAR* LexStage(EA1H_LatencyStage Stage)
+    {
+        return Stage == EA1H_LatencyStage::Motion ? TEXT("InputToMotion") : TEXT("InputToRender");
+    }
+}
+
+#pragma region Subsystem Lifetime
+bool UA1H_InputLatencySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    // The markers compile out of Shipping, so there'd be nothing to collect
+    return A1H_WITH_PROFILING && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UA1H_InputLatencySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    LLM_SCOPE_BYTAG(A1H_Tools);
+    RenderedQueue = MakeShared<FRenderedQueue, ESPMode::ThreadSafe>();
+    ResetHistograms();
+}
+
+void UA1H_InputLatencySubsystem::Deinitialize()
+{
+    PendingSamples.Reset();
+    LastMoveValues.Reset();
+    RenderedQueue.Reset();
+    SET_DWORD_STAT(STAT_A1H_InputLatencyPending, 0);
+
+    Super::Deinitialize();
+}
+
+void UA1H_InputLatencySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InputLatencyTracking);
+
+    // World subsystems tick after the actors, so movement and PlayerTick have run for this frame
+    const uint64 NowCycles = FPlatformTime::Cycles64();
+    for (int32 Index = PendingSamples.Num() - 1; Index >= 0; --Index)
+    {
+        const FPendingSample& Sample = PendingSamples[Index];
+        const AA1H_MarionetteController* Controller = Sample.Controller.Get();
+        const AA1H_MarionetteCharacter* Character = Controller ? Cast<AA1H_MarionetteCharacter>(Controller->GetPawn()) : nullptr;
+        if (!Character)
+        {
+            PendingSamples.RemoveAtSwap(Index);
+            continue;
+        }
+
+        if (HasReacted(Sample, *Character))
+        {
+            TRACE_CPUPROFILER_EVENT_SCOPE_STR("A1H Latency Motion");
+
+            GetHistogram(Sample.Input, EA1H_LatencyStage::Motion).Add(FPlatformTime::ToMilliseconds64(NowCycles - Sample.InputCycles));
+
+            // The frame with the reaction in it is queued up behind this, so time when the render thread gets to it
+            ENQUEUE_RENDER_COMMAND(A1H_InputLatencyMarker)(
+                [Queue = RenderedQueue, Input = Sample.Input, InputCycles = Sample.InputCycles](FRHICommandListImmediate& RHICmdList)
+                {
+                    TRACE_CPUPROFILER_EVENT_SCOPE_STR("A1H Latency Render");
+                    Queue->Enqueue({ Input, InputCycles, FPlatformTime::Cycles64() });
+                });
+
+            PendingSamples.RemoveAtSwap(Index);
+        }
+        else if (FPlatformTime::ToSeconds64(NowCycles - Sample.InputCycles) > A1HInputLatency::MaxPendingSeconds)
+        {
+            ++TimedOutSamples;
+            PendingSamples.RemoveAtSwap(Index);
+        }
+    }
+
+    FRenderedSample Rendered;
+    while (RenderedQueue->Dequeue(Rendered))
+    {
+        GetHistogram(Rendered.Input, EA1H_LatencyStage::Render).Add(FPlatformTime::ToMilliseconds64(Rendered.RenderCycles - Rendered.InputCycles));
+    }
+
+    // Controllers that went away
+    for (auto It = LastMoveValues.CreateIterator(); It; ++It)
+    {
+        if (!It->Key.IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    SET_DWORD_STAT(STAT_A1H_InputLatencyPending, PendingSamples.Num());
+}
+
+TStatId UA1H_InputLatencySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UA1H_InputLatencySubsystem, STATGROUP_Tickables);
+}
+
+bool UA1H_InputLatencySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+#pragma endregion
+
+#pragma region Markers
+void UA1H_InputLatencySubsystem::MarkInput(AA1H_MarionetteController* Controller, EA1H_LatencyInput Input, const FVector2D& Value)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE_STR("A1H Latency Input");
+
+    UWorld* World = Controller ? Controller->GetWorld() : nullptr;
+    if (UA1H_InputLatencySubsystem* Latency = World ? World->GetSubsystem<UA1H_InputLatencySubsystem>() : nullptr)
+    {
+        Latency->AddInput(Controller, Input, Value);
+    }
+}
+
+void UA1H_InputLatencySubsystem::AddInput(AA1H_MarionetteController* Controller, EA1H_LatencyInput Input, const FVector2D& Value)
+{
+    // Move is triggered every frame the stick is held, holding it steady only counts once
+    if (Input == EA1H_LatencyInput::Move)
+    {
+        FVector2D& LastValue = LastMoveValues.FindOrAdd(Controller, FVector2D(UE_BIG_NUMBER));
+        const bool bChanged = !Value.Equals(LastValue, A1HInputLatency::MoveChangeTolerance);
+        LastValue = Value;
+        if (!bChanged)
+        {
+            return;
+        }
+    }
+
+    // Only the first input since the last reaction, otherwise every frame of a held input would be "waiting"
+    const bool bAlreadyPending = PendingSamples.ContainsByPredicate([Controller, Input](const FPendingSample& Sample)
+    {
+        return Sample.Input == Input && Sample.Controller.Get() == Controller;
+    });
+    const AA1H_MarionetteCharacter* Character = Cast<AA1H_MarionetteCharacter>(Controller->GetPawn());
+    if (bAlreadyPending || !Character)
+    {
+        return;
+    }
+
+    FPendingSample& Sample = PendingSamples.AddDefaulted_GetRef();
+    Sample.Controller = Controller;
+    Sample.Input = Input;
+    Sample.InputCycles = FPlatformTime::Cycles64();
+    Sample.Velocity = Character->GetVelocity();
+    Sample.ControlRotation = Controller->GetControlRotation();
+}
+
+bool UA1H_InputLatencySubsystem::HasReacted(const FPendingSample& Sample, const AA1H_MarionetteCharacter& Character)
+{
+    switch (Sample.Input)
+    {
+    case EA1H_LatencyInput::Move:
+        return !Character.GetVelocity().Equals(Sample.Velocity, A1HInputLatency::VelocityTolerance);
+
+    case EA1H_LatencyInput::Look:
+        return !Character.GetControlRotation().Equals(Sample.ControlRotation, A1HInputLatency::RotationTolerance);
+
+    case EA1H_LatencyInput::Jump:
+        return Character.GetVelocity().Z > Sample.Velocity.Z + A1HInputLatency::VelocityTolerance;
+
+    default:
+        return true;
+    }
+}
+
+#pragma endregion
+
+#pragma region Histograms
+void UA1H_InputLatencySubsystem::FHistogram::Add(float Ms)
+{
+    const int32 Bucket = FMath::Clamp(FMath::FloorToInt32(Ms / BucketMs), 0, NumBuckets - 1);
+    ++Buckets[Bucket];
+
+    MinMs = Count == 0 ? Ms : FMath::Min(MinMs, Ms);
+    MaxMs = Count == 0 ? Ms : FMath::Max(MaxMs, Ms);
+    SumMs += Ms;
+    ++Count;
+}
+
+float UA1H_InputLatencySubsystem::FHistogram::Percentile(float Percent) const
+{
+    if (Count == 0)
+    {
+        return -1.0f;
+    }
+
+    // Nearest rank, reported as the middle of its bucket (but never outside what we actually saw)
+    const uint64 Rank = FMath::Max<uint64>(1, static_cast<uint64>(FMath::CeilToDouble(FMath::Clamp(Percent, 0.0f, 100.0f) / 100.0 * Count)));
+    uint64 Seen = 0;
+    for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+    {
+        Seen += Buckets[Bucket];
+        if (Seen >= Rank)
+        {
+            return FMath::Clamp((Bucket + 0.5f) * BucketMs, MinMs, MaxMs);
+        }
+    }
+    return MaxMs;
+}
+
+void UA1H_InputLatencySubsystem::FHistogram::Reset()
+{
+    Buckets.SetNumZeroed(NumBuckets);
+    FMemory::Memzero(Buckets.GetData(), Buckets.Num() * sizeof(uint32));
+    Count = 0;
+    SumMs = 0.0;
+    MinMs = 0.0f;
+    MaxMs = 0.0f;
+}
+
+UA1H_InputLatencySubsystem::FHistogram& UA1H_InputLatencySubsystem::GetHistogram(EA1H_LatencyInput Input, EA1H_LatencyStage Stage)
+{
+    return Histograms[static_cast<int32>(Input)][static_cast<int32>(Stage)];
+}
+
+const UA1H_InputLatencySubsystem::FHistogram& UA1H_InputLatencySubsystem::GetHistogram(EA1H_LatencyInput Input, EA1H_LatencyStage Stage) const
+{
+    return Histograms[static_cast<int32>(Input)][static_cast<int32>(Stage)];
+}
+
+float UA1H_InputLatencySubsystem::GetPercentileMs(EA1H_LatencyInput Input, EA1H_LatencyStage Stage, float Percentile) const
+{
+    return GetHistogram(Input, Stage).Percentile(Percentile);
+}
+
+uint64 UA1H_InputLatencySubsystem::GetSampleCount(EA1H_LatencyInput Input, EA1H_LatencyStage Stage) const
+{
+    return GetHistogram(Input, Stage).Count;
+}
+
+void UA1H_InputLatencySubsystem::ResetHistograms()
+{
+    for (int32 Input = 0; Input < static_cast<int32>(EA1H_LatencyInput::Count); ++Input)
+    {
+        for (int32 Stage = 0; Stage < static_cast<int32>(EA1H_LatencyStage::Count); ++Stage)
+        {
+            Histograms[Input][Stage].Reset();
+        }
+    }
+
+    PendingSamples.Reset();
+    TimedOutSamples = 0;
+}
+
+#pragma endregion
+
+#pragma region Reporting
+void UA1H_InputLatencySubsystem::LogReport() const
+{
+    using namespace A1HInputLatency;
+
+    UE_LOG(LogA1H, Log, TEXT("A1H input latency (%llu inputs timed out without a reaction):"), TimedOutSamples);
+    for (int32 Input = 0; Input < static_cast<int32>(EA1H_LatencyInput::Count); ++Input)
+    {
+        for (int32 Stage = 0; Stage < static_cast<int32>(EA1H_LatencyStage::Count); ++Stage)
+        {
+            const FHistogram& Histogram = Histograms[Input][Stage];
+            UE_LOG(LogA1H, Log, TEXT("  %-5s %-14s n=%-7llu p50 %7.2f ms  p95 %7.2f ms  p99 %7.2f ms  max %7.2f ms"),
+                LexInput(static_cast<EA1H_LatencyInput>(Input)), LexStage(static_cast<EA1H_LatencyStage>(Stage)), Histogram.Count,
+                Histogram.Percentile(50.0f), Histogram.Percentile(95.0f), Histogram.Percentile(99.0f), Histogram.MaxMs);
+        }
+    }
+}
+
+void UA1H_InputLatencySubsystem::DumpToCsv(const FString& Name) const
+{
+    using namespace A1HInputLatency;
+
+    const FString OutputDir = FPaths::Combine(FPaths::ProfilingDir(), TEXT("A1H"));
+    const FString BaseName = FString::Printf(TEXT("Latency-%s-%s"), Name.IsEmpty() ? TEXT("Session") : *Name, *FDateTime::Now().ToString());
+
+    FString Summary = TEXT("Input,Stage,Count,MinMs,MeanMs,P50Ms,P95Ms,P99Ms,MaxMs\n");
+    FString Buckets = TEXT("Input,Stage,BucketStartMs,Count\n");
+    for (int32 Input = 0; Input < static_cast<int32>(EA1H_LatencyInput::Count); ++Input)
+    {
+        for (int32 Stage = 0; Stage < static_cast<int32>(EA1H_LatencyStage::Count); ++Stage)
+        {
+            const FHistogram& Histogram = Histograms[Input][Stage];
+            const TCHAR* InputName = LexInput(static_cast<EA1H_LatencyInput>(Input));
+            const TCHAR* StageName = LexStage(static_cast<EA1H_LatencyStage>(Stage));
+
+            Summary += FString::Printf(TEXT("%s,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"), InputName, StageName, Histogram.Count,
+                Histogram.MinMs, Histogram.Count > 0 ? Histogram.SumMs / Histogram.Count : 0.0,
+                Histogram.Percentile(50.0f), Histogram.Percentile(95.0f), Histogram.Percentile(99.0f), Histogram.MaxMs);
+
+            // Empty buckets left out, there are thousands of them
+            for (int32 Bucket = 0; Bucket < Histogram.Buckets.Num(); ++Bucket)
+            {
+                if (Histogram.Buckets[Bucket] > 0)
+                {
+                    Buckets += FString::Printf(TEXT("%s,%s,%.1f,%u\n"), InputName, StageName, Bucket * FHistogram::BucketMs, Histogram.Buckets[Bucket]);
+                }
+            }
+        }
+    }
+
+    const FString SummaryPath = FPaths::Combine(OutputDir, BaseName + TEXT(".csv"));
+    const FString BucketsPath = FPaths::Combine(OutputDir, BaseName + TEXT("-Histogram.csv"));
+    FFileHelper::SaveStringToFile(Summary, *SummaryPath);
+    FFileHelper::SaveStringToFile(Buckets, *BucketsPath);
+
+    UE_LOG(LogA1H, Log, TEXT("A1H input latency written to %s and %s"), *SummaryPath, *BucketsPath);
+}
+
+#pragma endregion
+
+#pragma region Console
+#if A1H_WITH_PROFILING
+namespace A1HInputLatency
+{
+    static UA1H_InputLatencySubsystem* FindSubsystem(UWorld* World, const TCHAR* Command)
+    {
+        UA1H_InputLatencySubsystem* Latency = World ? World->GetSubsystem<UA1H_InputLatencySubsystem>() : nullptr;
+        if (!Latency)
+        {
+            UE_LOG(LogA1H, Warning, TEXT("%s: no input latency tracking in this world."), Command);
+        }
+        return Latency;
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs ReportCommand(
+        TEXT("A1H.Latency.Report"),
+        TEXT("Logs input-to-motion and input-to-render latency percentiles for move, look and jump."),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (const UA1H_InputLatencySubsystem* Latency = FindSubsystem(World, TEXT("A1H.Latency.Report")))
+            {
+                Latency->LogReport();
+            }
+        }));
+
+    static FAutoConsoleCommandWithWorldAndArgs DumpCommand(
+        TEXT("A1H.Latency.Dump"),
+        TEXT("Writes the latency summary and histograms to Saved/Profiling/A1H.\n")
+        TEXT("Usage: A1H.Latency.Dump [Name=Session]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (const UA1H_InputLatencySubsystem* Latency = FindSubsystem(World, TEXT("A1H.Latency.Dump")))
+            {
+                Latency->DumpToCsv(Args.IsValidIndex(0) ? Args[0] : FString());
+            }
+        }));
+
+    static FAutoConsoleCommandWithWorldAndArgs ResetCommand(
+        TEXT("A1H.Latency.Reset"),
+        TEXT("Clears every latency histogram."),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (UA1H_InputLatencySubsystem* Latency = FindSubsystem(World, TEXT("A1H.Latency.Reset")))
+            {
+                Latency->ResetHistograms();
+            }
+        }));
+}
+#endif
+
+#pragma endregion
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/Queue.h"
+#include "Assignment1Hinged.h"      // For A1H_WITH_PROFILING
+#include "A1H_InputLatencySubsystem.generated.h"
+
+class AA1H_MarionetteController;
+class AA1H_MarionetteCharacter;
+
+// Input kinds we time
+enum class EA1H_LatencyInput : uint8
+{
+	Move,
+	Look,
+	Jump,
+
+	Count
+};
+
+// Where along the path a latency was measured to
+enum class EA1H_LatencyStage : uint8
+{
+	Motion,     // Velocity (move/jump) or control rotation (look) changed, seen at the end of the game thread frame
+	Render,     // The render thread picked up the frame containing that change
+
+	Count
+};
+
+/**
+ * Input-to-motion latency tracing.
+ * The controller's HandleMove/HandleLook/HandleJumpStarted timestamp an input (A1H_MARK_INPUT_LATENCY). Once a
+ * frame later shows the marionette's velocity or control rotation has reacted, the input-to-motion time is
+ * recorded, and a marker is sent to the render thread to time when that frame gets rendered.
+ * Only the first input after the last reaction is timed, and moves only when the stick actually changes.
+ * Every step also emits a CPU trace event ("A1H Latency ...") so the path shows up in Insights.
+ * Console: A1H.Latency.Report, A1H.Latency.Dump [Name], A1H.Latency.Reset. Not created in Shipping.
+ */
+UCLASS()
+class ASSIGNMENT1HINGED_API UA1H_InputLatencySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Subsystem Lifetime
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+#pragma endregion
+
+public:
+#pragma region Markers And Queries
+	// Timestamps an input as it reaches the controller (use A1H_MARK_INPUT_LATENCY)
+	static void MarkInput(AA1H_MarionetteController* Controller, EA1H_LatencyInput Input, const FVector2D& Value);
+
+	// Latency percentile (0..100) in milliseconds, or -1 if nothing has been recorded yet
+	float GetPercentileMs(EA1H_LatencyInput Input, EA1H_LatencyStage Stage, float Percentile) const;
+
+	// Number of samples recorded
+	uint64 GetSampleCount(EA1H_LatencyInput Input, EA1H_LatencyStage Stage) const;
+
+	// Logs p50/p95/p99 of every histogram
+	void LogReport() const;
+
+	// Writes a summary and the raw histograms to Saved/Profiling/A1H/Latency-<Name>-*.csv
+	void DumpToCsv(const FString& Name) const;
+
+	// Forgets every sample (pending ones included)
+	void ResetHistograms();
+
+#pragma endregion
+
+private:
+	// 0.1 ms buckets up to 250 ms, everything slower lands in the last one
+	struct FHistogram
+	{
+		static constexpr float BucketMs = 0.1f;
+		static constexpr int32 NumBuckets = 2500;
+
+		TArray<uint32> Buckets;
+		uint64 Count = 0;
+		double SumMs = 0.0;
+		float MinMs = 0.0f;
+		float MaxMs = 0.0f;
+
+		void Add(float Ms);
+		float Percentile(float Percent) const;
+		void Reset();
+	};
+
+	// An input waiting for the marionette to react
+	struct FPendingSample
+	{
+		TWeakObjectPtr<AA1H_MarionetteController> Controller;
+		EA1H_LatencyInput Input = EA1H_LatencyInput::Move;
+		uint64 InputCycles = 0;
+
+		// State when the input arrived, to spot the change against
+		FVector Velocity = FVector::ZeroVector;
+		FRotator ControlRotation = FRotator::ZeroRotator;
+	};
+
+	// Filled by the render thread, drained on the game thread
+	struct FRenderedSample
+	{
+		EA1H_LatencyInput Input = EA1H_LatencyInput::Move;
+		uint64 InputCycles = 0;
+		uint64 RenderCycles = 0;
+	};
+	using FRenderedQueue = TQueue<FRenderedSample, EQueueMode::Spsc>;
+
+	void AddInput(AA1H_MarionetteController* Controller, EA1H_LatencyInput Input, const FVector2D& Value);
+
+	// True once the marionette shows a reaction to Sample
+	static bool HasReacted(const FPendingSample& Sample, const AA1H_MarionetteCharacter& Character);
+
+	FHistogram& GetHistogram(EA1H_LatencyInput Input, EA1H_LatencyStage Stage);
+	const FHistogram& GetHistogram(EA1H_LatencyInput Input, EA1H_LatencyStage Stage) const;
+
+	FHistogram Histograms[static_cast<int32>(EA1H_LatencyInput::Count)][static_cast<int32>(EA1H_LatencyStage::Count)];
+
+	TArray<FPendingSample> PendingSamples;
+
+	// Last move value per controller, so holding the stick still doesn't start a sample every frame
+	TMap<TWeakObjectPtr<AA1H_MarionetteController>, FVector2D> LastMoveValues;
+
+	// Shared with in-flight render commands, which may outlive us
+	TSharedPtr<FRenderedQueue, ESPMode::ThreadSafe> RenderedQueue;
+
+	// Inputs that never showed a reaction in time (e.g. walking into a wall)
+	uint64 TimedOutSamples = 0;
+};
+
+#if A1H_WITH_PROFILING
+#define A1H_MARK_INPUT_LATENCY(Controller, Input, Value) UA1H_InputLatencySubsystem::MarkInput(Controller, Input, Value)
+#else
+#define A1H_MARK_INPUT_LATENCY(Controller, Input, Value)
+#endif
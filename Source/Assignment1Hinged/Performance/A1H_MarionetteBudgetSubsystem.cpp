@@ -0,0 +1,290 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_MarionetteBudgetSubsystem.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "Camera/PlayerCameraManager.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Player/A1H_MarionetteCharacter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Marionette Budget"), STAT_A1H_MarionetteBudget, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Budgeted Marionettes"), STAT_A1H_BudgetedMarionettes, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Full Rate Marionettes"), STAT_A1H_FullRateMarionettes, STATGROUP_A1H);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Marionette Budget Estimate (ms)"), STAT_A1H_MarionetteBudgetEstimateMs, STATGROUP_A1H);
+
+namespace A1HMarionetteBudget
+{
+    // Where a local player is looking from
+    struct FView
+    {
+        FVector Location;
+        float InvTanHalfFOV;
+    };
+}
+
+#pragma region Subsystem Lifetime
+void UA1H_MarionetteBudgetSubsystem::Deinitialize()
+{
+    Entries.Reset();
+    EntryLookup.Reset();
+    SortedIndices.Reset();
+    SET_DWORD_STAT(STAT_A1H_BudgetedMarionettes, 0);
+    SET_DWORD_STAT(STAT_A1H_FullRateMarionettes, 0);
+    SET_FLOAT_STAT(STAT_A1H_MarionetteBudgetEstimateMs, 0.0f);
+
+    Super::Deinitialize();
+}
+
+void UA1H_MarionetteBudgetSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_MarionetteBudget);
+
+    // Drop anything that went away without unregistering (e.g. world teardown order)
+    for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Entries[Index].Marionette.IsValid())
+        {
+            RemoveEntry(Index);
+        }
+    }
+    if (Entries.IsEmpty())
+    {
+        return;
+    }
+
+    UpdateSignificance();
+    AssignTiers(DeltaTime);
+}
+
+TStatId UA1H_MarionetteBudgetSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UA1H_MarionetteBudgetSubsystem, STATGROUP_Tickables);
+}
+
+bool UA1H_MarionetteBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    // Same as the interactable index - only worlds that actually play
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+#pragma endregion
+
+#pragma region Registration
+void UA1H_MarionetteBudgetSubsystem::RegisterMarionette(AA1H_MarionetteCharacter* Marionette)
+{
+    if (!Marionette || EntryLookup.Contains(Marionette))
+    {
+        return;
+    }
+
+    EntryLookup.Add(Marionette, Entries.Num());
+    FMarionetteEntry& Entry = Entries.AddDefaulted_GetRef();
+    Entry.Marionette = Marionette;
+    Entry.Key = Marionette;
+
+    // Remember what the Blueprint asked for so tier 0 can hand it back
+    if (const USkeletalMeshComponent* Mesh = Marionette->GetMesh())
+    {
+        Entry.DefaultTickOption = Mesh->VisibilityBasedAnimTickOption;
+        Entry.bDefaultUpdateRateOptimizations = Mesh->bEnableUpdateRateOptimizations;
+    }
+
+    SET_DWORD_STAT(STAT_A1H_BudgetedMarionettes, Entries.Num());
+}
+
+void UA1H_MarionetteBudgetSubsystem::UnregisterMarionette(AA1H_MarionetteCharacter* Marionette)
+{
+    if (const int32* EntryIndex = EntryLookup.Find(Marionette))
+    {
+        RemoveEntry(*EntryIndex);
+    }
+}
+
+int32 UA1H_MarionetteBudgetSubsystem::GetMarionetteTier(const AA1H_MarionetteCharacter* Marionette) const
+{
+    const int32* EntryIndex = EntryLookup.Find(Marionette);
+    return EntryIndex ? FMath::Max(Entries[*EntryIndex].Tier, 0) : INDEX_NONE;
+}
+
+void UA1H_MarionetteBudgetSubsystem::RemoveEntry(int32 EntryIndex)
+{
+    EntryLookup.Remove(Entries[EntryIndex].Key);
+
+    // Swap the last entry into the hole so the array stays packed
+    const int32 LastIndex = Entries.Num() - 1;
+    if (EntryIndex != LastIndex)
+    {
+        EntryLookup.Add(Entries[LastIndex].Key, EntryIndex);
+    }
+
+    Entries.RemoveAtSwap(EntryIndex, 1, EAllowShrinking::No);
+    SET_DWORD_STAT(STAT_A1H_BudgetedMarionettes, Entries.Num());
+}
+
+float UA1H_MarionetteBudgetSubsystem::GetTierTickInterval(int32 Tier) const
+{
+    return TierTickIntervals.IsValidIndex(Tier) ? FMath::Max(TierTickIntervals[Tier], 0.0f) : 0.0f;
+}
+
+#pragma endregion
+
+#pragma region Budgeting
+void UA1H_MarionetteBudgetSubsystem::UpdateSignificance()
+{
+    using namespace A1HMarionetteBudget;
+
+    // Every local player's camera counts, so split screen works
+    TArray<FView, TInlineAllocator<4>> Views;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (PlayerController && PlayerController->GetLocalPlayer() && PlayerController->PlayerCameraManager)
+        {
+            const float HalfFOVRadians = FMath::DegreesToRadians(FMath::Clamp(PlayerController->PlayerCameraManager->GetFOVAngle(), 1.0f, 170.0f) * 0.5f);
+            Views.Add({ PlayerController->PlayerCameraManager->GetCameraLocation(), 1.0f / FMath::Tan(HalfFOVRadians) });
+        }
+    }
+
+    const int32 LastTier = FMath::Max(TierTickIntervals.Num() - 1, 0);
+
+    for (FMarionetteEntry& Entry : Entries)
+    {
+        const AA1H_MarionetteCharacter* Marionette = Entry.Marionette.Get();
+
+        // Whoever a player is driving is never throttled. Not just local ones: on a server, remote players'
+        // movement is simulated here too and has to keep up with what their clients send.
+        Entry.bPlayerControlled = Marionette->IsPlayerControlled();
+        if (Entry.bPlayerControlled)
+        {
+            Entry.Significance = MAX_flt;
+            Entry.MinTier = 0;
+            continue;
+        }
+
+        // No local views (dedicated server, headless runs): nothing to rank by, so it's budget only
+        if (Views.IsEmpty())
+        {
+            Entry.Significance = 0.0f;
+            Entry.MinTier = 0;
+            continue;
+        }
+
+        // Off screen marionettes can't be seen animating, so they go straight to the bottom
+        if (!Marionette->WasRecentlyRendered(OffscreenTolerance))
+        {
+            Entry.Significance = 0.0f;
+            Entry.MinTier = LastTier;
+            continue;
+        }
+
+        // Screen size = bounds radius over the half width of the view at that distance, biggest view wins
+        const FVector Location = Marionette->GetActorLocation();
+        const float BoundsRadius = Marionette->GetMesh() ? Marionette->GetMesh()->Bounds.SphereRadius : 100.0f;
+        float ScreenSize = 0.0f;
+        for (const FView& View : Views)
+        {
+            const float Distance = FMath::Max(FVector::Dist(View.Location, Location), 1.0f);
+            ScreenSize = FMath::Max(ScreenSize, BoundsRadius * View.InvTanHalfFOV / Distance);
+        }
+
+        Entry.Significance = ScreenSize;
+        Entry.MinTier = LastTier;
+        for (int32 Tier = 0; Tier < TierMinScreenSizes.Num() && Tier < LastTier; ++Tier)
+        {
+            if (ScreenSize >= TierMinScreenSizes[Tier])
+            {
+                Entry.MinTier = Tier;
+                break;
+            }
+        }
+    }
+}
+
+void UA1H_MarionetteBudgetSubsystem::AssignTiers(float DeltaTime)
+{
+    const int32 LastTier = FMath::Max(TierTickIntervals.Num() - 1, 0);
+
+    // Cost of a tier as a fraction of a full rate update - a 1/15s interval at 60fps only ticks every 4th frame
+    auto TierCost = [this, DeltaTime](int32 Tier)
+    {
+        const float Interval = GetTierTickInterval(Tier);
+        return Interval > DeltaTime ? DeltaTime / Interval : 1.0f;
+    };
+    const float LastTierCost = TierCost(LastTier);
+
+    // Most significant first
+    SortedIndices.Reset(Entries.Num());
+    for (int32 Index = 0; Index < Entries.Num(); ++Index)
+    {
+        SortedIndices.Add(Index);
+    }
+    SortedIndices.Sort([this](int32 A, int32 B) { return Entries[A].Significance > Entries[B].Significance; });
+
+    // The budget in full rate updates. Everyone after the current marionette gets at least the last tier's
+    // share held back for them, so the budget is spent on the most significant ones first.
+    float RemainingUpdates = EstimatedFullRateCostMs > 0.0f ? BudgetMs / EstimatedFullRateCostMs : MAX_flt;
+    float EstimatedCost = 0.0f;
+    int32 NumFullRate = 0;
+
+    for (int32 Rank = 0; Rank < SortedIndices.Num(); ++Rank)
+    {
+        FMarionetteEntry& Entry = Entries[SortedIndices[Rank]];
+        const float Reserved = (SortedIndices.Num() - Rank - 1) * LastTierCost;
+
+        int32 Tier = Entry.MinTier;
+        if (!Entry.bPlayerControlled)
+        {
+            while (Tier < LastTier && TierCost(Tier) > RemainingUpdates - Reserved)
+            {
+                ++Tier;
+            }
+        }
+
+        RemainingUpdates -= TierCost(Tier);
+        EstimatedCost += TierCost(Tier);
+        NumFullRate += (Tier == 0);
+
+        if (Tier != Entry.Tier)
+        {
+            ApplyTier(Entry, Tier);
+        }
+    }
+
+    SET_DWORD_STAT(STAT_A1H_FullRateMarionettes, NumFullRate);
+    SET_FLOAT_STAT(STAT_A1H_MarionetteBudgetEstimateMs, EstimatedCost * EstimatedFullRateCostMs);
+    CSV_CUSTOM_STAT(A1H, FullRateMarionettes, NumFullRate, ECsvCustomStatOp::Set);
+    CSV_CUSTOM_STAT(A1H, MarionetteBudgetEstimateMs, EstimatedCost * EstimatedFullRateCostMs, ECsvCustomStatOp::Set);
+}
+
+void UA1H_MarionetteBudgetSubsystem::ApplyTier(FMarionetteEntry& Entry, int32 NewTier) const
+{
+    AA1H_MarionetteCharacter* Marionette = Entry.Marionette.Get();
+    const float Interval = GetTierTickInterval(NewTier);
+    const int32 LastTier = FMath::Max(TierTickIntervals.Num() - 1, 0);
+
+    if (USkeletalMeshComponent* Mesh = Marionette->GetMesh())
+    {
+        // Anim update and evaluation both run from the mesh tick, so this throttles them too
+        Mesh->SetComponentTickInterval(Interval);
+
+        // Let the engine skip and interpolate frames on top of that once we're throttling anyway
+        Mesh->bEnableUpdateRateOptimizations = NewTier > 0 ? true : Entry.bDefaultUpdateRateOptimizations;
+
+        // The bottom tier stops posing entirely while nobody can see it
+        Mesh->VisibilityBasedAnimTickOption = (NewTier > 0 && NewTier == LastTier) ? EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered : Entry.DefaultTickOption;
+    }
+
+    if (UCharacterMovementComponent* Movement = Marionette->GetCharacterMovement())
+    {
+        Movement->SetComponentTickInterval(Interval);
+    }
+
+    Entry.Tier = NewTier;
+}
+
+#pragma endregion
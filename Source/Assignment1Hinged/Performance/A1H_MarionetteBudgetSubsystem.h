@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "A1H_MarionetteBudgetSubsystem.generated.h"
+
+class AA1H_MarionetteCharacter;
+enum class EVisibilityBasedAnimTickOption : uint8;
+
+/**
+ * Significance-driven budgeting for marionette ticking.
+ * Every frame each registered marionette is scored by how big it is on screen for the nearest local view.
+ * The most significant ones get full-rate mesh, anim and movement updates, and the rest are pushed down
+ * a ladder of slower tick intervals until the estimated total cost fits inside BudgetMs.
+ * Player controlled marionettes (local or, on a server, remote) always run at full rate.
+ * Tuned from DefaultGame.ini.
+ */
+UCLASS(Config = Game)
+class ASSIGNMENT1HINGED_API UA1H_MarionetteBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Subsystem Lifetime
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+#pragma endregion
+
+public:
+#pragma region Registration
+	// Called by marionettes from BeginPlay/EndPlay
+	void RegisterMarionette(AA1H_MarionetteCharacter* Marionette);
+	void UnregisterMarionette(AA1H_MarionetteCharacter* Marionette);
+
+	// Tier the marionette was given last frame (0 = full rate), or INDEX_NONE if it isn't registered
+	int32 GetMarionetteTier(const AA1H_MarionetteCharacter* Marionette) const;
+
+	// Tick interval (in seconds) for a tier
+	float GetTierTickInterval(int32 Tier) const;
+
+#pragma endregion
+
+#pragma region Budget Settings
+	// Game thread time all marionettes together are allowed, in milliseconds
+	UPROPERTY(Config, EditAnywhere, Category = "Budget")
+	float BudgetMs = 2.0f;
+
+	// Rough cost of one marionette updating at full rate (mesh + anim + movement), in milliseconds
+	UPROPERTY(Config, EditAnywhere, Category = "Budget")
+	float EstimatedFullRateCostMs = 0.05f;
+
+	// Tick interval per tier, tier 0 first. Every tier is assumed to cost FullRate * (FrameTime / Interval).
+	UPROPERTY(Config, EditAnywhere, Category = "Budget")
+	TArray<float> TierTickIntervals = { 0.0f, 1.0f / 30.0f, 1.0f / 15.0f, 1.0f / 7.5f };
+
+	// Minimum screen size (bounds radius over half the view width) to be allowed into each tier, tier 0 first.
+	// Anything smaller than all of these lands in the last tier regardless of budget.
+	UPROPERTY(Config, EditAnywhere, Category = "Budget")
+	TArray<float> TierMinScreenSizes = { 0.08f, 0.03f, 0.01f };
+
+	// Marionettes not rendered for this long are treated as off screen and go straight to the last tier
+	UPROPERTY(Config, EditAnywhere, Category = "Budget")
+	float OffscreenTolerance = 0.25f;
+
+#pragma endregion
+
+private:
+	struct FMarionetteEntry
+	{
+		TWeakObjectPtr<AA1H_MarionetteCharacter> Marionette;
+		TObjectKey<AA1H_MarionetteCharacter> Key;  // Still valid after the marionette is gone, so its lookup can be removed
+		float Significance = 0.0f;
+		int32 MinTier = 0;
+		int32 Tier = INDEX_NONE;
+		bool bPlayerControlled = false;
+
+		// Mesh settings from the Blueprint, restored when the marionette is back at full rate
+		EVisibilityBasedAnimTickOption DefaultTickOption{};
+		bool bDefaultUpdateRateOptimizations = false;
+	};
+
+	// Scores every marionette against the local views
+	void UpdateSignificance();
+
+	// Hands out tiers in significance order until the budget runs out
+	void AssignTiers(float DeltaTime);
+
+	// Pushes a tier's settings onto a marionette's components
+	void ApplyTier(FMarionetteEntry& Entry, int32 NewTier) const;
+
+	// Swaps the last entry into the hole and fixes up its lookup
+	void RemoveEntry(int32 EntryIndex);
+
+	TArray<FMarionetteEntry> Entries;
+
+	// Marionette -> entry index, so registration and tier lookups don't scan Entries
+	TMap<TObjectKey<AA1H_MarionetteCharacter>, int32> EntryLookup;
+
+	// Scratch buffer for the significance sort
+	TArray<int32> SortedIndices;
+};
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Performance/A1H_FrameGovernor.h"
+
+namespace A1HFrameGovernorTest
+{
+    constexpr float FrameSeconds = 1.0f / 60.0f;
+    constexpr int32 NumLevels = 4;
+
+    // Over the 60 fps target, with the GPU taking longest
+    static FA1H_FrameTimings GpuBound()
+    {
+        return { 25.0f, 10.0f, 8.0f, 24.0f };
+    }
+
+    // Just as far over, but the game thread is the slow one
+    static FA1H_FrameTimings GameThreadBound()
+    {
+        return { 25.0f, 24.0f, 8.0f, 10.0f };
+    }
+
+    // Under target, but not by enough to step back up
+    static FA1H_FrameTimings NearTarget()
+    {
+        return { 15.0f, 12.0f, 10.0f, 14.0f };
+    }
+
+    // Plenty of headroom everywhere
+    static FA1H_FrameTimings Headroom()
+    {
+        return { 10.0f, 8.0f, 6.0f, 9.0f };
+    }
+
+    // Feeds the same timings at 60 fps for Seconds and returns the level it ends on
+    static int32 RunFor(FA1H_FrameGovernor& Governor, const FA1H_FrameTimings& Timings, float Seconds)
+    {
+        const int32 Frames = FMath::RoundToInt32(Seconds / FrameSeconds);
+        for (int32 Frame = 0; Frame < Frames; ++Frame)
+        {
+            Governor.Tick(Timings, FrameSeconds);
+        }
+        return Governor.GetLevel();
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FA1H_FrameGovernorDownshiftTest, "A1H.Performance.FrameGovernor.DownshiftAfterDelay",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FA1H_FrameGovernorDownshiftTest::RunTest(const FString& Parameters)
+{
+    using namespace A1HFrameGovernorTest;
+
+    const FA1H_FrameGovernorSettings Settings;
+    FA1H_FrameGovernor Governor;
+    Governor.Reset(Settings, NumLevels);
+
+    TestEqual(TEXT("Level just before DownshiftDelay"), RunFor(Governor, GpuBound(), Settings.DownshiftDelay - 0.1f), 0);
+    TestEqual(TEXT("Bound"), Governor.GetBound(), EA1H_FrameBound::Gpu);
+    TestEqual(TEXT("Level just after DownshiftDelay"), RunFor(Governor, GpuBound(), 0.2f), 1);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FA1H_FrameGovernorGameThreadTest, "A1H.Performance.FrameGovernor.NoDownshiftWhenGameThreadBound",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FA1H_FrameGovernorGameThreadTest::RunTest(const FString& Parameters)
+{
+    using namespace A1HFrameGovernorTest;
+
+    const FA1H_FrameGovernorSettings Settings;
+    FA1H_FrameGovernor Governor;
+    Governor.Reset(Settings, NumLevels);
+
+    // Cheaper rendering wouldn't help, so it has to stay put however long it lasts
+    TestEqual(TEXT("Level after a long game thread bound stretch"), RunFor(Governor, GameThreadBound(), Settings.DownshiftDelay * 5.0f), 0);
+    TestEqual(TEXT("Bound"), Governor.GetBound(), EA1H_FrameBound::GameThread);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FA1H_FrameGovernorUpshiftTest, "A1H.Performance.FrameGovernor.UpshiftHysteresis",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FA1H_FrameGovernorUpshiftTest::RunTest(const FString& Parameters)
+{
+    using namespace A1HFrameGovernorTest;
+
+    const FA1H_FrameGovernorSettings Settings;
+    FA1H_FrameGovernor Governor;
+    Governor.Reset(Settings, NumLevels, 2);
+
+    // Between the two thresholds nothing happens in either direction
+    TestEqual(TEXT("Level inside the dead band"), RunFor(Governor, NearTarget(), Settings.UpshiftDelay * 2.0f), 2);
+    TestEqual(TEXT("Bound inside the dead band"), Governor.GetBound(), EA1H_FrameBound::None);
+
+    // With headroom it still waits out UpshiftDelay (plus the moment the average takes to drop below the threshold)
+    TestEqual(TEXT("Level before UpshiftDelay"), RunFor(Governor, Headroom(), Settings.UpshiftDelay - 0.5f), 2);
+    TestEqual(TEXT("Level after UpshiftDelay"), RunFor(Governor, Headroom(), 1.0f), 1);
+
+    // And the next step up needs a whole new UpshiftDelay of headroom
+    TestEqual(TEXT("Level right after stepping up"), RunFor(Governor, Headroom(), Settings.UpshiftDelay - 0.5f), 1);
+    TestEqual(TEXT("Level after a second UpshiftDelay"), RunFor(Governor, Headroom(), 1.0f), 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FA1H_FrameGovernorCooldownTest, "A1H.Performance.FrameGovernor.Cooldown",
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FA1H_FrameGovernorCooldownTest::RunTest(const FString& Parameters)
+{
+    using namespace A1HFrameGovernorTest;
+
+    // Delay well under the cooldown, so the cooldown is what holds the second step back
+    FA1H_FrameGovernorSettings Settings;
+    Settings.DownshiftDelay = 0.25f;
+    Settings.Cooldown = 2.0f;
+
+    FA1H_FrameGovernor Governor;
+    Governor.Reset(Settings, NumLevels);
+
+    // Step to the first change
+    int32 Frames = 0;
+    while (Governor.GetLevel() == 0 && Frames++ < 600)
+    {
+        Governor.Tick(GpuBound(), FrameSeconds);
+    }
+    if (!TestEqual(TEXT("First step down"), Governor.GetLevel(), 1))
+    {
+        return false;
+    }
+
+    TestEqual(TEXT("Level during the cooldown"), RunFor(Governor, GpuBound(), Settings.Cooldown - 0.1f), 1);
+    TestEqual(TEXT("Level after the cooldown"), RunFor(Governor, GpuBound(), 0.2f), 2);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "EnhancedInputSubsystems.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "InputAction.h"
+#include "InputActionValue.h"
+#include "Performance/A1H_InputLatencySubsystem.h"
+#include "Player/A1H_MarionetteController.h"
+#include "Tests/AutomationCommon.h"
+
+namespace A1HInputLatencyTest
+{
+    // How long to wait for the input assets to load and bind before giving up
+    constexpr int32 MaxBindFrames = 600;
+
+    // Frames to let the marionette settle once input is bound, then frames of input, then frames for the last reactions to land
+    constexpr int32 SettleFrames = 30;
+    constexpr int32 DriveFrames = 600;
+    constexpr int32 DrainFrames = 30;
+
+    // How often each kind of input changes, so every change starts a new sample
+    constexpr int32 MoveChangeFrames = 20;
+    constexpr int32 LookChangeFrames = 10;
+    constexpr int32 JumpFrames = 60;
+    constexpr int32 JumpHoldFrames = 10;
+
+    static TAutoConsoleVariable<float> CVarMaxMotionP95Ms(
+        TEXT("A1H.Latency.Test.MaxMotionP95Ms"),
+        50.0f,
+        TEXT("Highest p95 input-to-motion latency, in milliseconds, the A1H.Performance.InputLatency test accepts for move, look and jump."),
+        ECVF_Default);
+
+    static const TCHAR* InputNames[] = { TEXT("Move"), TEXT("Look"), TEXT("Jump") };
+    static_assert(UE_ARRAY_COUNT(InputNames) == static_cast<int32>(EA1H_LatencyInput::Count), "One name per latency input");
+}
+
+/**
+ * Feeds move, look and jump to the local player's controller through Enhanced Input's injection, so each value goes the
+ * whole way a key press does: PlayerInput's processing in TickPlayerInput, the bound handlers, per-frame coalescing and
+ * ApplyFrameInput, all in the controller's own tick. Then checks the Motion stage p95 the latency subsystem recorded
+ * against A1H.Latency.Test.MaxMotionP95Ms.
+ */
+class FA1H_InputLatencyTestCommand : public IAutomationLatentCommand
+{
+public:
+    explicit FA1H_InputLatencyTestCommand(FAutomationTestBase* InTest)
+        : Test(InTest)
+    {
+    }
+
+    virtual bool Update() override
+    {
+        using namespace A1HInputLatencyTest;
+
+        UWorld* World = AutomationCommon::GetAnyGameWorld();
+        UA1H_InputLatencySubsystem* Latency = World ? World->GetSubsystem<UA1H_InputLatencySubsystem>() : nullptr;
+        if (!Latency)
+        {
+            Test->AddError(TEXT("No game world with input latency tracking, run this from a -game client of a non-Shipping build."));
+            return true;
+        }
+
+        // The controller streams its input assets in and binds them a few frames after BeginPlay
+        AA1H_MarionetteController* Controller = World->GetFirstPlayerController<AA1H_MarionetteController>();
+        if (!Controller || !Controller->bInputBound || !Controller->InputSubsystem || !Controller->GetPawn())
+        {
+            if (++BindFrames < MaxBindFrames)
+            {
+                return false;
+            }
+
+            Test->AddError(TEXT("The local player's marionette controller never bound its input."));
+            return true;
+        }
+
+        if (Frame == SettleFrames)
+        {
+            // Only our own inputs from here on
+            Latency->ResetHistograms();
+        }
+
+        if (Frame >= SettleFrames && Frame < SettleFrames + DriveFrames)
+        {
+            InjectInput(*Controller, Frame - SettleFrames);
+        }
+
+        if (++Frame < SettleFrames + DriveFrames + DrainFrames)
+        {
+            return false;
+        }
+
+        Report(*Latency);
+        return true;
+    }
+
+private:
+    void InjectInput(AA1H_MarionetteController& Controller, int32 DriveFrame) const
+    {
+        using namespace A1HInputLatencyTest;
+
+        // Injected values only last one frame, so held inputs are injected again every frame, and a jump ends
+        // (Completed) on the first frame it isn't injected any more
+        UEnhancedInputLocalPlayerSubsystem* InputSubsystem = Controller.InputSubsystem;
+
+        if (const UInputAction* Move = Controller.ActionMove.Get())
+        {
+            const float MoveAngle = (DriveFrame / MoveChangeFrames) * UE_HALF_PI;
+            InputSubsystem->InjectInputForAction(Move, FInputActionValue(FVector2D(FMath::Cos(MoveAngle), FMath::Sin(MoveAngle))));
+        }
+
+        if (const UInputAction* Look = Controller.ActionLook.Get())
+        {
+            const float LookSign = ((DriveFrame / LookChangeFrames) % 2) ? 1.0f : -1.0f;
+            InputSubsystem->InjectInputForAction(Look, FInputActionValue(FVector2D(LookSign, 0.0f)));
+        }
+
+        if (const UInputAction* Jump = Controller.ActionJump.Get())
+        {
+            if (DriveFrame % JumpFrames < JumpHoldFrames)
+            {
+                InputSubsystem->InjectInputForAction(Jump, FInputActionValue(true));
+            }
+        }
+    }
+
+    void Report(const UA1H_InputLatencySubsystem& Latency) const
+    {
+        using namespace A1HInputLatencyTest;
+
+        const float MaxP95Ms = CVarMaxMotionP95Ms.GetValueOnGameThread();
+        for (int32 Input = 0; Input < static_cast<int32>(EA1H_LatencyInput::Count); ++Input)
+        {
+            const EA1H_LatencyInput LatencyInput = static_cast<EA1H_LatencyInput>(Input);
+            const uint64 Samples = Latency.GetSampleCount(LatencyInput, EA1H_LatencyStage::Motion);
+            const float P95Ms = Latency.GetPercentileMs(LatencyInput, EA1H_LatencyStage::Motion, 95.0f);
+            Test->AddInfo(FString::Printf(TEXT("%s: %llu samples, input-to-motion p95 %.2f ms"), InputNames[Input], Samples, P95Ms));
+
+            if (Samples == 0)
+            {
+                // Move always changes velocity, so no samples there means the input never made it through
+                if (LatencyInput == EA1H_LatencyInput::Move)
+                {
+                    Test->AddError(TEXT("No move latency samples were recorded."));
+                }
+                continue;
+            }
+
+            Test->TestTrue(FString::Printf(TEXT("%s input-to-motion p95 (%.2f ms) within %.2f ms"), InputNames[Input], P95Ms, MaxP95Ms), P95Ms <= MaxP95Ms);
+        }
+    }
+
+    FAutomationTestBase* Test;
+    int32 BindFrames = 0;
+    int32 Frame = 0;
+};
+
+// Injects into the local player's Enhanced Input, so it needs a real -game client with a player in TestingMap, not a
+// -nullrhi server (e.g. -game -ExecCmds="Automation RunTests A1H.Performance.InputLatency")
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FA1H_InputLatencyTest, "A1H.Performance.InputLatency",
+    EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FA1H_InputLatencyTest::RunTest(const FString& Parameters)
+{
+    AutomationOpenMap(TEXT("/Game/TestingMap"));
+    ADD_LATENT_AUTOMATION_COMMAND(FA1H_InputLatencyTestCommand(this));
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
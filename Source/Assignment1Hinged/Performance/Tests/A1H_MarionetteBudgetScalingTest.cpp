@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Debug/A1H_HeadlessHarness.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Performance/A1H_MarionetteBudgetSubsystem.h"
+#include "RenderCore.h"                         // For GGameThreadTime
+#include "Tests/AutomationCommon.h"
+
+namespace A1HBudgetScalingTest
+{
+    // Marionettes in the world for each pass
+    static const int32 Counts[] = { 100, 400, 1000 };
+
+    // Frames after a change before measuring, long enough for the slowest tier to come round a few times
+    constexpr int32 WarmupFrames = 30;
+    constexpr int32 MeasureFrames = 120;
+
+    // With the budget on, each extra marionette may cost at most this fraction of what it costs at full rate
+    constexpr double MaxSlopeRatio = 0.5;
+
+    // Least squares slope of game thread ms against marionette count
+    static double GetSlope(const TArray<int32>& Xs, const TArray<double>& Ys)
+    {
+        double MeanX = 0.0;
+        double MeanY = 0.0;
+        for (int32 Index = 0; Index < Xs.Num(); ++Index)
+        {
+            MeanX += Xs[Index];
+            MeanY += Ys[Index];
+        }
+        MeanX /= Xs.Num();
+        MeanY /= Ys.Num();
+
+        double Covariance = 0.0;
+        double Variance = 0.0;
+        for (int32 Index = 0; Index < Xs.Num(); ++Index)
+        {
+            Covariance += (Xs[Index] - MeanX) * (Ys[Index] - MeanY);
+            Variance += FMath::Square(Xs[Index] - MeanX);
+        }
+        return Variance > 0.0 ? Covariance / Variance : 0.0;
+    }
+
+    /**
+     * Spawns up to each count and measures the average game thread time twice: once with every marionette forced
+     * to full rate (a single tier at interval 0) and once with the configured tiers and budget.
+     */
+    class FBudgetScalingCommand : public IAutomationLatentCommand
+    {
+    public:
+        explicit FBudgetScalingCommand(FAutomationTestBase* InTest)
+            : Test(InTest)
+        {
+        }
+
+        virtual bool Update() override
+        {
+            UWorld* World = AutomationCommon::GetAnyGameWorld();
+            UA1H_MarionetteBudgetSubsystem* Budget = World ? World->GetSubsystem<UA1H_MarionetteBudgetSubsystem>() : nullptr;
+            if (!Budget)
+            {
+                Test->AddError(TEXT("No game world with a marionette budget subsystem, run this from a -game client."));
+                return true;
+            }
+
+            if (!bStarted)
+            {
+                ConfiguredIntervals = Budget->TierTickIntervals;
+                bStarted = true;
+            }
+
+            if (FrameInStep == 0)
+            {
+                // Full rate first, then budgeted, at each count
+                Marionettes.Spawn(World, Counts[CountIndex] - Marionettes.Num());
+                if (bBudgeted)
+                {
+                    Budget->TierTickIntervals = ConfiguredIntervals;
+                }
+                else
+                {
+                    Budget->TierTickIntervals = { 0.0f };
+                }
+                TotalGameThreadMs = 0.0;
+            }
+            else if (FrameInStep > WarmupFrames)
+            {
+                TotalGameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+            }
+
+            if (++FrameInStep <= WarmupFrames + MeasureFrames)
+            {
+                return false;
+            }
+
+            const double AverageMs = TotalGameThreadMs / MeasureFrames;
+            (bBudgeted ? BudgetedMs : FullRateMs).Add(AverageMs);
+            Test->AddInfo(FString::Printf(TEXT("%5d marionettes, %s: %.2f ms game thread"), Marionettes.Num(), bBudgeted ? TEXT("budgeted ") : TEXT("full rate"), AverageMs));
+
+            FrameInStep = 0;
+            bBudgeted = !bBudgeted;
+            if (bBudgeted || ++CountIndex < UE_ARRAY_COUNT(Counts))
+            {
+                return false;
+            }
+
+            Budget->TierTickIntervals = ConfiguredIntervals;
+            Marionettes.DespawnAll();
+            Report();
+            return true;
+        }
+
+    private:
+        void Report()
+        {
+            TArray<int32> SpawnedCounts(Counts, UE_ARRAY_COUNT(Counts));
+            const double FullRateSlope = GetSlope(SpawnedCounts, FullRateMs);
+            const double BudgetedSlope = GetSlope(SpawnedCounts, BudgetedMs);
+            Test->AddInfo(FString::Printf(TEXT("Cost per extra marionette: full rate %.4f ms, budgeted %.4f ms"), FullRateSlope, BudgetedSlope));
+
+            if (FullRateSlope <= 0.0)
+            {
+                Test->AddWarning(TEXT("Full rate cost didn't grow with the count, nothing to compare the budget against."));
+                return;
+            }
+
+            Test->TestTrue(FString::Printf(TEXT("Budgeted slope is at most %.0f%% of the full rate slope"), MaxSlopeRatio * 100.0),
+                BudgetedSlope <= FullRateSlope * MaxSlopeRatio);
+        }
+
+        FAutomationTestBase* Test;
+        FA1H_SpawnedMarionettes Marionettes;
+        TArray<float> ConfiguredIntervals;
+        TArray<double> FullRateMs;
+        TArray<double> BudgetedMs;
+        double TotalGameThreadMs = 0.0;
+        int32 CountIndex = 0;
+        int32 FrameInStep = 0;
+        bool bBudgeted = false;
+        bool bStarted = false;
+    };
+}
+
+// Needs a game world with the game mode's marionettes, so it's client only (e.g. -game -ExecCmds="Automation RunTests A1H.Performance")
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FA1H_MarionetteBudgetScalingTest, "A1H.Performance.MarionetteBudgetScaling",
+    EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FA1H_MarionetteBudgetScalingTest::RunTest(const FString& Parameters)
+{
+    AutomationOpenMap(TEXT("/Game/TestingMap"));
+    ADD_LATENT_AUTOMATION_COMMAND(A1HBudgetScalingTest::FBudgetScalingCommand(this));
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_InputRecording.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace A1HInputRecording
+{
+    // "A1HI" - lets us reject files that aren't recordings at all
+    constexpr uint32 Magic = 0x49483141;
+
+    // Bump when the layout changes
+    constexpr uint16 Version = 1;
+}
+
+bool FA1H_InputRecording::SaveToFile(const FString& FilePath) const
+{
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes);
+    const_cast<FA1H_InputRecording*>(this)->Serialize(Writer);
+
+    return !Writer.IsError() && FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+bool FA1H_InputRecording::LoadFromFile(const FString& FilePath)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+    {
+        return false;
+    }
+
+    FMemoryReader Reader(Bytes);
+    Serialize(Reader);
+    return !Reader.IsError();
+}
+
+FString FA1H_InputRecording::GetRecordingPath(const FString& Name)
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("InputRecordings"), Name + TEXT(".a1hinput"));
+}
+
+void FA1H_InputRecording::Serialize(FArchive& Ar)
+{
+    uint32 Magic = A1HInputRecording::Magic;
+    uint16 Version = A1HInputRecording::Version;
+    Ar << Magic << Version;
+
+    if (Magic != A1HInputRecording::Magic || Version != A1HInputRecording::Version)
+    {
+        Ar.SetError();
+        return;
+    }
+
+    uint32 NumEvents = Events.Num();
+    Ar << FixedDeltaTime << NumFrames;
+    Ar.SerializeIntPacked(NumEvents);
+
+    if (Ar.IsLoading())
+    {
+        // Every event takes at least a byte, so a bigger count means a truncated or corrupt file. Check before allocating for it.
+        if (Ar.IsError() || static_cast<int64>(NumEvents) > Ar.TotalSize() - Ar.Tell())
+        {
+            Ar.SetError();
+            return;
+        }
+        Events.SetNum(NumEvents);
+    }
+
+    // Frames are stored as deltas from the previous event, which is almost always 0 or 1 and packs into a single byte
+    uint32 PreviousFrame = 0;
+    for (FA1H_RecordedInputEvent& Event : Events)
+    {
+        uint32 FrameDelta = Event.Frame - PreviousFrame;
+        Ar.SerializeIntPacked(FrameDelta);
+        Event.Frame = PreviousFrame + FrameDelta;
+        PreviousFrame = Event.Frame;
+
+        uint8 Action = static_cast<uint8>(Event.Action);
+        Ar << Action;
+        if (Action >= static_cast<uint8>(EA1H_RecordedInput::Count))
+        {
+            Ar.SetError();
+            return;
+        }
+        Event.Action = static_cast<EA1H_RecordedInput>(Action);
+
+        if (IsAxisAction(Event.Action))
+        {
+            Ar << Event.Value.X << Event.Value.Y;
+        }
+
+        if (Ar.IsError())
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Which controller handler a recorded event goes back into
+enum class EA1H_RecordedInput : uint8
+{
+	Move,
+	Look,
+	JumpStarted,
+	JumpCompleted,
+	Interact,
+	InteractArea,   // Appended so recordings made before area interaction still load
+
+	Count
+};
+
+// One input event as it reached AA1H_MarionetteController
+struct FA1H_RecordedInputEvent
+{
+	// Frame offset from the start of the recording (the timestamp - replay runs at a fixed step)
+	uint32 Frame = 0;
+
+	EA1H_RecordedInput Action = EA1H_RecordedInput::Move;
+
+	// Axis value for Move/Look, unused (and not stored on disk) for the button actions
+	FVector2f Value = FVector2f::ZeroVector;
+};
+
+/**
+ * A recorded stream of marionette input, plus the compact binary format it's saved in.
+ * Layout: header (magic, version, fixed step, frame count, event count), then per event a
+ * packed frame delta, the action byte and - only for axis actions - two floats.
+ */
+struct ASSIGNMENT1HINGED_API FA1H_InputRecording
+{
+	// Step the replay should run at. Set to the average frame time of the recorded session.
+	float FixedDeltaTime = 1.0f / 60.0f;
+
+	// Length of the recording in frames (events can stop before the end)
+	uint32 NumFrames = 0;
+
+	// Events, sorted by frame
+	TArray<FA1H_RecordedInputEvent> Events;
+
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+
+	// Where a recording called Name lives (Saved/InputRecordings/<Name>.a1hinput)
+	static FString GetRecordingPath(const FString& Name);
+
+	static bool IsAxisAction(EA1H_RecordedInput Action)
+	{
+		return Action == EA1H_RecordedInput::Move || Action == EA1H_RecordedInput::Look;
+	}
+
+private:
+	void Serialize(FArchive& Ar);
+};
@@ -2,5 +2,220 @@
 
 
 #include "A1H_InteractionInterface.h"
+#include "Assignment1Hinged.h"                  // For the LLM tags
+#include "GameFramework/Actor.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/Reload.h"                     // For EReloadCompleteReason
+#include "UObject/UObjectGlobals.h"             // For FCoreUObjectDelegates
+#include "UObject/WeakObjectPtr.h"
+
+#if WITH_EDITOR
+#include "Editor.h"                             // For GEditor, to hear about Blueprint compiles
+#endif
 
 // Add default functionality here for any IA1H_InteractionInterface functions that are not pure virtual.
+void IA1H_InteractionInterface::Interact_Implementation(AActor* InteractorActor)
+{
+    // Nothing by default, interactables override this (or Interact in Blueprint)
+}
+
+void IA1H_InteractionInterface::InteractInstance_Implementation(AActor* InteractorActor, int32 InstanceIndex)
+{
+    // Not instance aware, so the whole actor gets the interaction
+    DispatchInteract(Cast<AActor>(_getUObject()), InteractorActor);
+}
+
+namespace A1HInteractionDispatch
+{
+    // How a class wants Interact to be called
+    enum class ERoute : uint8
+    {
+        NotInteractable,   // Doesn't implement the interface at all
+        Native,            // C++ override, call Interact_Implementation directly
+        Script             // Blueprint override, ProcessEvent on the cached function
+    };
+
+    struct FRoute
+    {
+        ERoute Route = ERoute::NotInteractable;
+
+        // Same for InteractInstance. NotInteractable here means nobody implements it, so fall back to Interact.
+        ERoute InstanceRoute = ERoute::NotInteractable;
+
+        // Native: byte offset from the UObject to its IA1H_InteractionInterface sub-object
+        int32 InterfaceOffset = 0;
+
+        // Script: the Blueprint's Interact function. Weak in case it goes away before the cache is cleared.
+        TWeakObjectPtr<UFunction> Function;
+    };
+
+    // Must match the parameter block the Interact UFunction expects
+    struct FInteractParms
+    {
+        AActor* InteractorActor;
+    };
+
+    // One entry per class we've ever dispatched to. TObjectKey keeps unloaded classes from matching.
+    static TMap<TObjectKey<UClass>, FRoute> RouteCache;
+
+    // A recompiled Blueprint or a Live Coding patch keeps its class (so the key still matches) but can change
+    // which route is right and replace the function we cached, so start over whenever that happens
+    static void ClearRouteCache()
+    {
+        RouteCache.Reset();
+    }
+
+    static void ClearRouteCacheOnReload(EReloadCompleteReason Reason)
+    {
+        ClearRouteCache();
+    }
+
+    static void BindCacheInvalidation()
+    {
+        static bool bBoundReload = false;
+        if (!bBoundReload)
+        {
+            FCoreUObjectDelegates::ReloadCompleteDelegate.AddStatic(&ClearRouteCacheOnReload);
+            bBoundReload = true;
+        }
+
+#if WITH_EDITOR
+        // GEditor may not exist yet the first time we get here, so keep trying until it does
+        static bool bBoundBlueprintCompiled = false;
+        if (!bBoundBlueprintCompiled && GEditor)
+        {
+            GEditor->OnBlueprintCompiled().AddStatic(&ClearRouteCache);
+            bBoundBlueprintCompiled = true;
+        }
+#endif
+    }
+
+    static FRoute ResolveRoute(AActor* Target)
+    {
+        FRoute Result;
+
+        UClass* TargetClass = Target->GetClass();
+        if (!TargetClass->ImplementsInterface(UA1H_InteractionInterface::StaticClass()))
+        {
+            return Result;
+        }
+
+        UFunction* Function = Target->FindFunction(GET_FUNCTION_NAME_CHECKED(IA1H_InteractionInterface, Interact));
+        IA1H_InteractionInterface* NativeInterface = Cast<IA1H_InteractionInterface>(Target);
+        if (NativeInterface)
+        {
+            Result.InterfaceOffset = static_cast<int32>(reinterpret_cast<uint8*>(NativeInterface) - reinterpret_cast<uint8*>(Target));
+        }
+
+        // Blueprint overrides of InteractInstance go through the script VM. Without one, native classes get their
+        // InteractInstance_Implementation (which may just be the default), Blueprint-only ones fall back to Interact.
+        UFunction* InstanceFunction = Target->FindFunction(GET_FUNCTION_NAME_CHECKED(IA1H_InteractionInterface, InteractInstance));
+        if (InstanceFunction && InstanceFunction->GetOuterUClass() != UA1H_InteractionInterface::StaticClass())
+        {
+            Result.InstanceRoute = ERoute::Script;
+        }
+        else if (NativeInterface)
+        {
+            Result.InstanceRoute = ERoute::Native;
+        }
+
+        // If the function we found still belongs to the interface itself nobody overrode it in Blueprint,
+        // so the native Interact_Implementation is what ProcessEvent would end up calling anyway.
+        if (NativeInterface && (!Function || Function->GetOuterUClass() == UA1H_InteractionInterface::StaticClass()))
+        {
+            Result.Route = ERoute::Native;
+            return Result;
+        }
+
+        if (Function && Function->ParmsSize == sizeof(FInteractParms))
+        {
+            Result.Route = ERoute::Script;
+            Result.Function = Function;
+            return Result;
+        }
+
+        // Something unexpected (e.g. a signature mismatch after a reload) - let the generated thunk deal with it
+        Result.Route = ERoute::Script;
+        return Result;
+    }
+
+    static const FRoute& GetRoute(AActor* Target)
+    {
+        check(IsInGameThread());
+
+        const TObjectKey<UClass> ClassKey(Target->GetClass());
+        if (const FRoute* Cached = RouteCache.Find(ClassKey))
+        {
+            return *Cached;
+        }
+
+        BindCacheInvalidation();
+
+        LLM_SCOPE_BYTAG(A1H_Interaction);
+        return RouteCache.Add(ClassKey, ResolveRoute(Target));
+    }
+}
+
+bool IA1H_InteractionInterface::DispatchInteract(AActor* Target, AActor* InteractorActor, int32 InstanceIndex)
+{
+    using namespace A1HInteractionDispatch;
+
+    if (!IsValid(Target))
+    {
+        return false;
+    }
+
+    const FRoute& Route = GetRoute(Target);
+    if (InstanceIndex != INDEX_NONE && Route.Route != ERoute::NotInteractable)
+    {
+        switch (Route.InstanceRoute)
+        {
+        case ERoute::Native:
+        {
+            IA1H_InteractionInterface* NativeInterface = reinterpret_cast<IA1H_InteractionInterface*>(reinterpret_cast<uint8*>(Target) + Route.InterfaceOffset);
+            NativeInterface->InteractInstance_Implementation(InteractorActor, InstanceIndex);
+            return true;
+        }
+
+        case ERoute::Script:
+            Execute_InteractInstance(Target, InteractorActor, InstanceIndex);
+            return true;
+
+        default:
+            // Nobody wants the instance, plain Interact below
+            break;
+        }
+    }
+
+    switch (Route.Route)
+    {
+    case ERoute::Native:
+    {
+        // Straight C++ virtual call, no reflection and no script VM
+        IA1H_InteractionInterface* NativeInterface = reinterpret_cast<IA1H_InteractionInterface*>(reinterpret_cast<uint8*>(Target) + Route.InterfaceOffset);
+        NativeInterface->Interact_Implementation(InteractorActor);
+        return true;
+    }
+
+    case ERoute::Script:
+        if (UFunction* Function = Route.Function.Get())
+        {
+            // Same thing Execute_Interact does, minus the per-call interface check and function lookup
+            FInteractParms Parms{ InteractorActor };
+            Target->ProcessEvent(Function, &Parms);
+        }
+        else
+        {
+            Execute_Interact(Target, InteractorActor);
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool IA1H_InteractionInterface::IsInteractable(const AActor* Target)
+{
+    return IsValid(Target) && A1HInteractionDispatch::GetRoute(const_cast<AActor*>(Target)).Route != A1HInteractionDispatch::ERoute::NotInteractable;
+}
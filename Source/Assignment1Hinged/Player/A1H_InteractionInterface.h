@@ -26,9 +26,37 @@ public:
     /**
 	* Function called when an actor interacts with an object implementing this interface.
 	* Needs to be implemented in the Actor that *has* this interface (e.g., the item).
-	* BlueprintImplementableEvent means the logic *must* be implemented in Blueprint.
+	* BlueprintNativeEvent means Blueprints can implement it as before, but C++ interactables
+	* can override Interact_Implementation instead and skip the script VM entirely.
 	* @param InteractorActor The Actor that initiated the interaction (e.g., the player character).
 	*/
-    UFUNCTION(BlueprintCallable, BlueprintImplementableEvent, Category = "Interaction")
+    UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Interaction")
 	void Interact(AActor* InteractorActor);
+	virtual void Interact_Implementation(AActor* InteractorActor);
+
+	/**
+	* Called instead of Interact when the hit landed on one instance of an instanced mesh
+	* (e.g. AA1H_InstancedInteractableManager), so one actor can stand in for thousands of props.
+	* By default this just calls Interact, so actors that don't care about instances don't need to implement it.
+	* @param InteractorActor The Actor that initiated the interaction.
+	* @param InstanceIndex The instance that was hit (FHitResult::Item).
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Interaction")
+	void InteractInstance(AActor* InteractorActor, int32 InstanceIndex);
+	virtual void InteractInstance_Implementation(AActor* InteractorActor, int32 InstanceIndex);
+
+	/**
+	* Calls Interact on Target through the cheapest route its class allows.
+	* The route is worked out once per class and cached: native overrides are called directly,
+	* Blueprint overrides go straight to ProcessEvent with the function we already looked up.
+	* Game thread only.
+	* @param Target The actor to interact with.
+	* @param InteractorActor The Actor that initiated the interaction.
+	* @param InstanceIndex Instance of an instanced mesh that was hit, goes to InteractInstance. INDEX_NONE calls plain Interact.
+	* @return False if Target doesn't implement this interface (nothing was called).
+	*/
+	static bool DispatchInteract(AActor* Target, AActor* InteractorActor, int32 InstanceIndex = INDEX_NONE);
+
+	// Cached version of Target->Implements<UA1H_InteractionInterface>(). Game thread only.
+	static bool IsInteractable(const AActor* Target);
 };
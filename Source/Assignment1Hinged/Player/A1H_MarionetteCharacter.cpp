@@ -2,17 +2,59 @@
 
 
 #include "A1H_MarionetteCharacter.h"
+#include "Assignment1Hinged.h" // For STATGROUP_A1H and the profiling macros
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "Camera/A1H_CachedSpringArmComponent.h" // Spring arm that reuses its collision probe
+#include "Animation/A1H_MarionetteStringComponent.h" // Control bar strings
 #include "GameFramework/CharacterMovementComponent.h" // Needed for movement settings
 #include "Components/CapsuleComponent.h" // Might be needed for interaction trace ignore
 #include "Kismet/KismetSystemLibrary.h" // For LineTrace
 #include "A1H_InteractionInterface.h" // Include the interface header
-#include "DrawDebugHelpers.h" // Optional: For visualizing the trace
+#include "Interaction/A1H_InteractableSubsystem.h" // Spatial index of interactables
+#include "Performance/A1H_MarionetteBudgetSubsystem.h" // Throttles mesh/movement ticking of distant marionettes
+#include "Debug/A1H_DebugDraw.h" // A1H.Debug.DrawInteraction
+#include "Debug/A1H_EventJournal.h" // Interaction results go to the journal instead of the log
+#include "Async/ParallelFor.h" // Area interaction scores its candidates on worker threads
+#include "WorldPartition/WorldPartitionSubsystem.h" // To register the predictive streaming source
+#include "GameFramework/PlayerController.h"
+#include "Loading/A1H_AssetPreloadSubsystem.h" // Streams the soft mesh and anim class in
+#include "Engine/GameInstance.h"
+#include "Engine/SkeletalMesh.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h" // Hits on instances carry the instance in FHitResult::Item
+#include "Net/UnrealNetwork.h" // For DOREPLIFETIME
+#include "Net/Core/PushModel/PushModel.h" // For MARK_PROPERTY_DIRTY_FROM_NAME
+
+DECLARE_CYCLE_STAT(TEXT("MoveForward"), STAT_A1H_MoveForward, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("MoveRight"), STAT_A1H_MoveRight, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("ApplyMovementInput"), STAT_A1H_ApplyMovementInput, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("LookUp"), STAT_A1H_LookUp, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("LookRight"), STAT_A1H_LookRight, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("PerformInteractionCheck"), STAT_A1H_PerformInteractionCheck, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Interaction Trace"), STAT_A1H_InteractionTrace, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Interaction Dispatch"), STAT_A1H_InteractionDispatch, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("ServerRequestInteract"), STAT_A1H_ServerRequestInteract, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Area Interaction"), STAT_A1H_AreaInteraction, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Area Interaction Scoring"), STAT_A1H_AreaInteractionScoring, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Area Interaction Dispatch"), STAT_A1H_AreaInteractionDispatch, STATGROUP_A1H);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Interaction Candidates"), STAT_A1H_AreaInteractionCandidates, STATGROUP_A1H);
+
+namespace A1HAreaInteraction
+{
+    // Candidates per worker task. Each one may cost a line trace, so keep batches small enough to spread out.
+    constexpr int32 ScoringBatchSize = 32;
+
+    // Score given to candidates that fail the filter
+    constexpr float Rejected = -1.0f;
+}
 
 // Sets default values
 AA1H_MarionetteCharacter::AA1H_MarionetteCharacter()
 {
+    // Runs for every spawned marionette too, and every component below is allocated per marionette
+    LLM_SCOPE_BYTAG(A1H_Marionette);
+
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	// Chris: I wanna turn it off and find out ok...
 	PrimaryActorTick.bCanEverTick = false;
@@ -28,9 +70,18 @@ AA1H_MarionetteCharacter::AA1H_MarionetteCharacter()
 
 #pragma endregion
 
+#pragma region Configure Replication
+    // Marionettes only need to look right to players reasonably close by, and the movement
+    // component's smoothing hides a lower send rate. Drops to the minimum when nothing changes.
+    SetNetUpdateFrequency(30.0f);
+    SetMinNetUpdateFrequency(5.0f);
+    SetNetCullDistanceSquared(FMath::Square(10000.0f));
+
+#pragma endregion
+
 #pragma region Create And Setup Components
-    // Create Spring Arm
-    SpringArmComp = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArmComp"));
+    // Create Spring Arm (our cached version only sweeps for collision when someone's looking through it)
+    SpringArmComp = CreateDefaultSubobject<UA1H_CachedSpringArmComponent>(TEXT("SpringArmComp"));
     // Attach to the character's root
     SpringArmComp->SetupAttachment(RootComponent); 
     // How far back the camera sits
@@ -47,6 +98,12 @@ AA1H_MarionetteCharacter::AA1H_MarionetteCharacter()
     // Camera should NOT rotate relative to the spring arm (the arm already follows controller rotation)
     CameraComp->bUsePawnControlRotation = false;
 
+#pragma endregion
+
+#pragma region Create Strings
+    // No strings by default - they're tied to bones, so the Blueprint (which knows the skeleton) sets them up
+    StringComp = CreateDefaultSubobject<UA1H_MarionetteStringComponent>(TEXT("StringComp"));
+
 #pragma endregion
 
     /* Note: Assigning Skeletal Mesh and Animation Blueprint is best done in a
@@ -57,6 +114,8 @@ AA1H_MarionetteCharacter::AA1H_MarionetteCharacter()
 #pragma region Movement
 void AA1H_MarionetteCharacter::MoveForward(float Value)
 {
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_MoveForward);
+
     // Check if we have a controller and the input value is significant
     if ((Controller != nullptr) && (Value != 0.0f))
     {
@@ -74,6 +133,8 @@ void AA1H_MarionetteCharacter::MoveForward(float Value)
 
 void AA1H_MarionetteCharacter::MoveRight(float Value)
 {
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_MoveRight);
+
     if ((Controller != nullptr) && (Value != 0.0f))
     {
         // Find out which way is "right" based on the controller's rotation (yaw only)
@@ -88,8 +149,31 @@ void AA1H_MarionetteCharacter::MoveRight(float Value)
     }
 }
 
+void AA1H_MarionetteCharacter::ApplyMovementInput(const FVector2D& MovementVector)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_ApplyMovementInput);
+
+    if ((Controller != nullptr) && !MovementVector.IsZero())
+    {
+        // Same yaw-only basis as MoveForward/MoveRight, but built once for both axes
+        const FRotator YawRotation(0, Controller->GetControlRotation().Yaw, 0);
+        const FRotationMatrix YawBasis(YawRotation);
+
+        if (MovementVector.Y != 0.0f)
+        {
+            AddMovementInput(YawBasis.GetUnitAxis(EAxis::X), MovementVector.Y);
+        }
+        if (MovementVector.X != 0.0f)
+        {
+            AddMovementInput(YawBasis.GetUnitAxis(EAxis::Y), MovementVector.X);
+        }
+    }
+}
+
 void AA1H_MarionetteCharacter::LookUp(float Value)
 {
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_LookUp);
+
     if (Value != 0.0f)
     {
         // Add Pitch input (up/down look) - Unreal negates this internally usually for mouse, so I negated it back ffs.
@@ -99,6 +183,8 @@ void AA1H_MarionetteCharacter::LookUp(float Value)
 
 void AA1H_MarionetteCharacter::LookRight(float Value)
 {
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_LookRight);
+
     if (Value != 0.0f)
     {
         // Add Yaw input (left/right look)
@@ -111,52 +197,415 @@ void AA1H_MarionetteCharacter::LookRight(float Value)
 #pragma region Interaction
 void AA1H_MarionetteCharacter::PerformInteractionCheck()
 {
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_PerformInteractionCheck);
+
     if (!CameraComp)
     {
-        UE_LOG(LogTemp, Warning, TEXT("AA1H_MarionetteCharacter::PerformInteractionCheck - CameraComp is null!"));
+        UE_LOG(LogA1H, Warning, TEXT("AA1H_MarionetteCharacter::PerformInteractionCheck - CameraComp is null!"));
         return;
     }
 
     // Get character's location and camera's and forward direction
-    FVector TraceStart = RootComponent->GetComponentLocation();
-    FVector TraceEnd = TraceStart + (CameraComp->GetForwardVector() * InteractionDistance);
+    const FVector TraceStart = RootComponent->GetComponentLocation();
+    const FVector TraceDirection = CameraComp->GetForwardVector();
+
+    // Networked clients don't get to decide what they hit - they ask, and the server replicates the result back
+    if (!HasAuthority())
+    {
+        ServerRequestInteract(TraceDirection);
+        return;
+    }
+
+    RunInteractionQuery(TraceStart, TraceDirection);
+}
+
+void AA1H_MarionetteCharacter::RunInteractionQuery(const FVector& TraceStart, const FVector& TraceDirection)
+{
+    FVector TraceEnd = TraceStart + (TraceDirection * InteractionDistance);
+
+    // Ask the spatial index first - it only looks at interactables in the cells around us
+    if (bUseInteractableIndex)
+    {
+        if (const UA1H_InteractableSubsystem* InteractableIndex = GetWorld()->GetSubsystem<UA1H_InteractableSubsystem>())
+        {
+            float DistanceToCandidate = InteractionDistance;
+            if (!InteractableIndex->FindInteractableAlongRay(TraceStart, TraceDirection, InteractionDistance, this, DistanceToCandidate))
+            {
+                // Nothing interactable anywhere near the ray, so don't bother physics at all
+                A1H_DRAW_INTERACTION_TRACE(GetWorld(), TraceStart, TraceEnd, false);
+#if !UE_BUILD_SHIPPING
+                LastInteractionTrace = { TraceStart, TraceEnd, false, true };
+#endif
+                SetInteractionResult(nullptr, false);
+                return;
+            }
+
+            // Only trace as far as the last candidate's bounds, but still along the aim. Stopping at the closest one would
+            // miss anything behind it when the ray passes through its bounds without touching the mesh.
+            TraceEnd = TraceStart + TraceDirection * DistanceToCandidate;
+        }
+    }
 
-    FHitResult HitResult;
     FCollisionQueryParams QueryParams;
     // Make sure the trace ignores the character itself
     QueryParams.AddIgnoredActor(this);
 
-    // Perform the line trace (AKA raycast)
-    bool bHit = GetWorld()->LineTraceSingleByChannel(
-        HitResult,        // Output hit result
-        TraceStart,       // Start location
-        TraceEnd,         // End location
-        ECC_Visibility,   // Trace channel (things that block visibility)
-        QueryParams       // Additional parameters (like ignoring self)
-    );
+    // Async mode: queue the trace and let OnInteractionTraceCompleted pick up the result next frame
+    if (bUseAsyncInteractionTrace)
+    {
+        if (!InteractionTraceDelegate.IsBound())
+        {
+            InteractionTraceDelegate.BindUObject(this, &AA1H_MarionetteCharacter::OnInteractionTraceCompleted);
+        }
+
+        A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InteractionTrace);
+        GetWorld()->AsyncLineTraceByChannel(
+            EAsyncTraceType::Single,                       // We only care about the first blocking hit
+            TraceStart,
+            TraceEnd,
+            ECC_Visibility,
+            QueryParams,
+            FCollisionResponseParams::DefaultResponseParam,
+            &InteractionTraceDelegate                      // Called on the game thread once the trace is done
+        );
+        return;
+    }
+
+    FHitResult HitResult;
+    bool bHit = false;
+
+    {
+        A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InteractionTrace);
+
+        // Perform the line trace (AKA raycast)
+        bHit = GetWorld()->LineTraceSingleByChannel(
+            HitResult,        // Output hit result
+            TraceStart,       // Start location
+            TraceEnd,         // End location
+            ECC_Visibility,   // Trace channel (things that block visibility)
+            QueryParams       // Additional parameters (like ignoring self)
+        );
+    }
+
+    HandleInteractionTraceResult(TraceStart, TraceEnd, bHit, HitResult);
+}
 
-    // Optional: Draw a debug line to see the trace in the game world
-    DrawDebugLine(GetWorld(), TraceStart, TraceEnd, bHit ? FColor::Green : FColor::Red, false, 2.0f, 0, 1.0f);
+void AA1H_MarionetteCharacter::OnInteractionTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+    // Single traces only ever hand back the blocking hit (if there was one)
+    const FHitResult* BlockingHit = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+    HandleInteractionTraceResult(TraceDatum.Start, TraceDatum.End, BlockingHit != nullptr, BlockingHit ? *BlockingHit : FHitResult());
+}
+
+void AA1H_MarionetteCharacter::HandleInteractionTraceResult(const FVector& TraceStart, const FVector& TraceEnd, bool bHit, const FHitResult& HitResult)
+{
+    // Only drawn with A1H.Debug.DrawInteraction 1, and not at all in Shipping
+    A1H_DRAW_INTERACTION_TRACE(GetWorld(), TraceStart, TraceEnd, bHit);
+#if !UE_BUILD_SHIPPING
+    LastInteractionTrace = { TraceStart, TraceEnd, bHit, true };
+#endif
+
+    A1H_RECORD_INTERACTION_TRACE(bHit && HitResult.GetActor());
 
     // Check if we hit something
     if (bHit && HitResult.GetActor()) // Also check if the hit actor is valid
     {
+        A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_InteractionDispatch);
+
         AActor* HitActor = HitResult.GetActor();
-        // Check if the hit actor *implements* our InteractionInterface
-        if (HitActor->Implements<UA1H_InteractionInterface>())
+        // Instanced props (AA1H_InstancedInteractableManager) are one actor, so they need to know which instance it was
+        const int32 InstanceIndex = Cast<UInstancedStaticMeshComponent>(HitResult.GetComponent()) ? HitResult.Item : INDEX_NONE;
+
+        // Call the interface function on the HitActor if it *implements* our InteractionInterface.
+        // DispatchInteract caches how to call it per class, so native interactables skip the script VM.
+        // We pass 'this' (the character) as the InteractorActor.
+        const bool bDispatched = IA1H_InteractionInterface::DispatchInteract(HitActor, this, InstanceIndex);
+        A1H_RECORD_INTERACTION_DISPATCH(bDispatched);
+
+        if (bDispatched)
         {
-            // Call the interface function on the HitActor.
-            // The 'Execute_' prefix is required for calling interface functions from C++.
-            // We pass 'this' (the character) as the InteractorActor.
-            IA1H_InteractionInterface::Execute_Interact(HitActor, this);
+            FA1H_EventJournal::Record(EA1H_JournalEvent::InteractionDispatched, HitActor, InstanceIndex);
 
-            UE_LOG(LogTemp, Log, TEXT("Interacted with: %s"), *HitActor->GetName());
+            // Interactables replicate slowly while idle, so push whatever the interaction changed out now
+            HitActor->ForceNetUpdate();
         }
         else
         {
-            UE_LOG(LogTemp, Log, TEXT("Hit actor %s does not implement InteractionInterface."), *HitActor->GetName());
+            FA1H_EventJournal::Record(EA1H_JournalEvent::InteractionNotInteractable, HitActor);
         }
+
+        SetInteractionResult(HitActor, bDispatched);
+        return;
+    }
+
+    SetInteractionResult(nullptr, false);
+}
+
+bool AA1H_MarionetteCharacter::ServerRequestInteract_Validate(FVector_NetQuantizeNormal TraceDirection)
+{
+    // Only garbage gets a client kicked. Spamming and bad aim are rejected softly in the implementation.
+    return !TraceDirection.ContainsNaN() && FMath::IsNearlyEqual(TraceDirection.SizeSquared(), 1.0f, 0.1f);
+}
+
+void AA1H_MarionetteCharacter::ServerRequestInteract_Implementation(FVector_NetQuantizeNormal TraceDirection)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_ServerRequestInteract);
+
+    if (!AcceptInteractRequest(TraceDirection))
+    {
+        SetInteractionResult(nullptr, false);
+        return;
+    }
+
+    // Always trace from where the server has us, never from a client supplied location
+    RunInteractionQuery(RootComponent->GetComponentLocation(), TraceDirection);
+}
+
+bool AA1H_MarionetteCharacter::AcceptInteractRequest(const FVector& TraceDirection)
+{
+    // Rate limit, measured in server time so the client can't speed it up
+    const double Now = GetWorld()->GetTimeSeconds();
+    const bool bTooSoon = (Now - LastInteractRequestTime) < MinInteractInterval;
+
+    // The direction has to roughly match where the server thinks we're aiming (control rotation arrives with every move)
+    const float AimCos = FVector::DotProduct(TraceDirection, GetBaseAimRotation().Vector());
+    const bool bBadAim = AimCos < FMath::Cos(FMath::DegreesToRadians(MaxInteractAimErrorDegrees));
+
+    A1H_RECORD_INTERACT_REQUEST(!bTooSoon && !bBadAim);
+    if (bTooSoon || bBadAim)
+    {
+        FA1H_EventJournal::Record(EA1H_JournalEvent::InteractRequestRejected, this, bTooSoon ? 0.0f : 1.0f);
+        return false;
     }
+
+    LastInteractRequestTime = Now;
+    return true;
+}
+
+void AA1H_MarionetteCharacter::SetInteractionResult(AActor* Target, bool bSucceeded)
+{
+    if (!HasAuthority())
+    {
+        return;
+    }
+
+    LastInteractionResult.Target = Target;
+    LastInteractionResult.bSucceeded = bSucceeded;
+    ++LastInteractionResult.Sequence;
+    MARK_PROPERTY_DIRTY_FROM_NAME(AA1H_MarionetteCharacter, LastInteractionResult, this);
+
+    // RepNotifies don't fire on the server, so listen servers and standalone call it themselves
+    OnRep_LastInteractionResult();
+}
+
+void AA1H_MarionetteCharacter::OnRep_LastInteractionResult()
+{
+    OnInteractionResult.Broadcast(LastInteractionResult);
+}
+
+#pragma endregion
+
+#pragma region Area Interaction
+void AA1H_MarionetteCharacter::PerformAreaInteraction()
+{
+    if (!CameraComp)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("AA1H_MarionetteCharacter::PerformAreaInteraction - CameraComp is null!"));
+        return;
+    }
+
+    const FVector QueryDirection = CameraComp->GetForwardVector();
+
+    // Same deal as single interaction: clients ask, the server decides
+    if (!HasAuthority())
+    {
+        ServerRequestAreaInteract(QueryDirection);
+        return;
+    }
+
+    RunAreaInteractionQuery(RootComponent->GetComponentLocation(), QueryDirection);
+}
+
+bool AA1H_MarionetteCharacter::ServerRequestAreaInteract_Validate(FVector_NetQuantizeNormal QueryDirection)
+{
+    return !QueryDirection.ContainsNaN() && FMath::IsNearlyEqual(QueryDirection.SizeSquared(), 1.0f, 0.1f);
+}
+
+void AA1H_MarionetteCharacter::ServerRequestAreaInteract_Implementation(FVector_NetQuantizeNormal QueryDirection)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_ServerRequestInteract);
+
+    if (!AcceptInteractRequest(QueryDirection))
+    {
+        SetInteractionResult(nullptr, false);
+        return;
+    }
+
+    RunAreaInteractionQuery(RootComponent->GetComponentLocation(), QueryDirection);
+}
+
+void AA1H_MarionetteCharacter::RunAreaInteractionQuery(const FVector& QueryOrigin, const FVector& QueryDirection)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_AreaInteraction);
+
+    // Broad phase: everything in the sphere, straight out of the spatial index
+    const UA1H_InteractableSubsystem* InteractableIndex = GetWorld()->GetSubsystem<UA1H_InteractableSubsystem>();
+    if (!InteractableIndex)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("Area interaction needs the interactable index, which this world doesn't have."));
+        return;
+    }
+
+    TArray<AActor*> Candidates;
+    TArray<FVector> CandidateLocations;
+    TArray<int32> CandidateInstances;
+    InteractableIndex->GatherInteractablesInSphere(QueryOrigin, AreaInteractionRadius, this, Candidates, CandidateLocations, &CandidateInstances);
+    INC_DWORD_STAT_BY(STAT_A1H_AreaInteractionCandidates, Candidates.Num());
+
+    if (Candidates.IsEmpty())
+    {
+        SetInteractionResult(nullptr, false);
+        return;
+    }
+
+    // Narrow phase on worker threads. Each candidate only writes its own score, and the line of sight
+    // traces are read-only scene queries, so the batches don't need to know about each other.
+    TArray<float> Scores;
+    Scores.SetNumUninitialized(Candidates.Num());
+    {
+        A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_AreaInteractionScoring);
+
+        const UWorld* World = GetWorld();
+        const float MinCos = FMath::Cos(FMath::DegreesToRadians(AreaInteractionHalfAngle));
+        const float InvRadius = AreaInteractionRadius > 0.0f ? 1.0f / AreaInteractionRadius : 0.0f;
+
+        FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(A1H_AreaInteractionLineOfSight));
+        QueryParams.AddIgnoredActor(this);
+
+        const int32 NumBatches = FMath::DivideAndRoundUp(Candidates.Num(), A1HAreaInteraction::ScoringBatchSize);
+        ParallelFor(NumBatches, [&](int32 BatchIndex)
+        {
+            const int32 First = BatchIndex * A1HAreaInteraction::ScoringBatchSize;
+            const int32 Last = FMath::Min(First + A1HAreaInteraction::ScoringBatchSize, Candidates.Num());
+
+            for (int32 Index = First; Index < Last; ++Index)
+            {
+                const FVector ToCandidate = CandidateLocations[Index] - QueryOrigin;
+                const float Distance = ToCandidate.Size();
+                const float AngleCos = Distance > UE_KINDA_SMALL_NUMBER ? FVector::DotProduct(ToCandidate / Distance, QueryDirection) : 1.0f;
+
+                if (AngleCos < MinCos)
+                {
+                    Scores[Index] = A1HAreaInteraction::Rejected;
+                    continue;
+                }
+
+                // Hitting the candidate itself (or nothing at all) counts as a clear line. For instances it has to be the same instance.
+                if (bAreaInteractionRequiresLineOfSight)
+                {
+                    FHitResult HitResult;
+                    if (World->LineTraceSingleByChannel(HitResult, QueryOrigin, CandidateLocations[Index], ECC_Visibility, QueryParams)
+                        && (HitResult.GetActor() != Candidates[Index] || (CandidateInstances[Index] != INDEX_NONE && HitResult.Item != CandidateInstances[Index])))
+                    {
+                        Scores[Index] = A1HAreaInteraction::Rejected;
+                        continue;
+                    }
+                }
+
+                // Closer and more central both score higher, 0..1
+                const float Closeness = 1.0f - FMath::Clamp(Distance * InvRadius, 0.0f, 1.0f);
+                const float Centrality = FMath::Clamp(AngleCos, 0.0f, 1.0f);
+                Scores[Index] = FMath::Lerp(Closeness, Centrality, AreaInteractionAngleWeight);
+            }
+        });
+    }
+
+    // Back on the game thread: keep the survivors, best first
+    TArray<int32> Winners;
+    Winners.Reserve(Candidates.Num());
+    for (int32 Index = 0; Index < Candidates.Num(); ++Index)
+    {
+        if (Scores[Index] >= 0.0f)
+        {
+            Winners.Add(Index);
+        }
+    }
+    Winners.Sort([&Scores](int32 A, int32 B) { return Scores[A] > Scores[B]; });
+    if (AreaInteractionMaxTargets > 0 && Winners.Num() > AreaInteractionMaxTargets)
+    {
+        Winners.SetNum(AreaInteractionMaxTargets);
+    }
+
+    // Interact has to run on the game thread - Blueprint implementations aren't thread safe
+    AActor* BestTarget = nullptr;
+    int32 NumDispatched = 0;
+    {
+        A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_AreaInteractionDispatch);
+
+        for (const int32 Index : Winners)
+        {
+            AActor* Target = Candidates[Index];
+            if (!IsValid(Target))
+            {
+                continue;
+            }
+
+            const bool bDispatched = IA1H_InteractionInterface::DispatchInteract(Target, this, CandidateInstances[Index]);
+            A1H_RECORD_INTERACTION_DISPATCH(bDispatched);
+            if (bDispatched)
+            {
+                Target->ForceNetUpdate();
+                BestTarget = BestTarget ? BestTarget : Target;
+                ++NumDispatched;
+            }
+        }
+    }
+
+    FA1H_EventJournal::Record(EA1H_JournalEvent::AreaInteraction, this, NumDispatched);
+
+    // The replicated result carries the best target, that's enough for feedback on the client
+    SetInteractionResult(BestTarget, NumDispatched > 0);
+}
+
+#pragma endregion
+
+#pragma region World Partition Streaming
+bool AA1H_MarionetteCharacter::GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const
+{
+    // Only real players stream the world: a local player, or a remote one on the server.
+    // Benchmark and crowd marionettes have controllers without a player and would just add noise.
+    const APlayerController* PlayerController = GetController<APlayerController>();
+    if (!bUsePredictiveStreamingSource || !PlayerController || !PlayerController->Player)
+    {
+        return false;
+    }
+
+    // The player controller already streams around where we are. This one only loads (never activates)
+    // cells ahead of us, at low priority, so it can't get in the way of what's needed right now.
+    FWorldPartitionStreamingSource& StreamingSource = OutStreamingSources.AddDefaulted_GetRef();
+    StreamingSource.Name = PredictiveStreamingSourceName;
+    StreamingSource.Location = GetPredictedStreamingLocation();
+    StreamingSource.Rotation = GetActorRotation();
+    StreamingSource.TargetState = EStreamingSourceTargetState::Loaded;
+    StreamingSource.bBlockOnSlowLoading = false;
+    StreamingSource.Priority = EStreamingSourcePriority::Low;
+
+    FStreamingSourceShape& Shape = StreamingSource.Shapes.AddDefaulted_GetRef();
+    Shape.bUseGridLoadingRange = true;
+    Shape.LoadingRangeScale = StreamingLoadingRangeScale;
+
+    return true;
+}
+
+FVector AA1H_MarionetteCharacter::GetPredictedStreamingLocation() const
+{
+    FVector PredictedLocation = GetActorLocation() + GetVelocity() * StreamingVelocityLookahead;
+
+    // Flattened so looking up or down doesn't send the source into the sky or the ground
+    const FVector ViewForward = GetControlRotation().Vector().GetSafeNormal2D();
+    PredictedLocation += ViewForward * StreamingCameraLookahead;
+
+    return PredictedLocation;
 }
 
 #pragma endregion
@@ -164,8 +613,76 @@ void AA1H_MarionetteCharacter::PerformInteractionCheck()
 // Called when the game starts or when spawned
 void AA1H_MarionetteCharacter::BeginPlay()
 {
+    // Includes our components' BeginPlay
+    LLM_SCOPE_BYTAG(A1H_Marionette);
+
 	Super::BeginPlay();
-	
+
+    // Let the budget decide how often our mesh, anim and movement get to update
+    if (UA1H_MarionetteBudgetSubsystem* Budget = GetWorld()->GetSubsystem<UA1H_MarionetteBudgetSubsystem>())
+    {
+        Budget->RegisterMarionette(this);
+    }
+
+    // Only partitioned worlds have this subsystem. GetStreamingSources decides per frame whether we actually provide anything.
+    if (UWorldPartitionSubsystem* WorldPartition = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>())
+    {
+        PredictiveStreamingSourceName = FName(*FString::Printf(TEXT("%s_Predictive"), *GetName()));
+        WorldPartition->RegisterStreamingSourceProvider(this);
+    }
+
+    // Mesh and anim class are soft, so they come in asynchronously (usually already preloaded during the map load)
+    if (!MarionetteMesh.IsNull() || !MarionetteAnimClass.IsNull())
+    {
+        const TArray<FSoftObjectPath> MarionetteAssets = { MarionetteMesh.ToSoftObjectPath(), MarionetteAnimClass.ToSoftObjectPath() };
+        if (UA1H_AssetPreloadSubsystem* Preload = GetGameInstance() ? GetGameInstance()->GetSubsystem<UA1H_AssetPreloadSubsystem>() : nullptr)
+        {
+            Preload->RequestAssets(MarionetteAssets, GetClass()->GetName(), FSimpleDelegate::CreateUObject(this, &AA1H_MarionetteCharacter::OnMarionetteAssetsLoaded));
+        }
+        else
+        {
+            MarionetteMesh.LoadSynchronous();
+            MarionetteAnimClass.LoadSynchronous();
+            OnMarionetteAssetsLoaded();
+        }
+    }
+}
+
+void AA1H_MarionetteCharacter::OnMarionetteAssetsLoaded()
+{
+    // The mesh instance's bone buffers and the anim instance are created in here
+    LLM_SCOPE_BYTAG(A1H_Marionette);
+
+    USkeletalMeshComponent* MeshComponent = GetMesh();
+    if (!MeshComponent || !IsValid(this))
+    {
+        return;
+    }
+
+    // Anim class last, it needs the skeleton from the mesh
+    if (USkeletalMesh* LoadedMesh = MarionetteMesh.Get())
+    {
+        MeshComponent->SetSkeletalMesh(LoadedMesh);
+    }
+    if (UClass* LoadedAnimClass = MarionetteAnimClass.Get())
+    {
+        MeshComponent->SetAnimInstanceClass(LoadedAnimClass);
+    }
+}
+
+void AA1H_MarionetteCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UA1H_MarionetteBudgetSubsystem* Budget = GetWorld()->GetSubsystem<UA1H_MarionetteBudgetSubsystem>())
+    {
+        Budget->UnregisterMarionette(this);
+    }
+
+    if (UWorldPartitionSubsystem* WorldPartition = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>())
+    {
+        WorldPartition->UnregisterStreamingSourceProvider(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -175,6 +692,16 @@ void AA1H_MarionetteCharacter::Tick(float DeltaTime)
 
 }
 
+void AA1H_MarionetteCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    // Push based: only compared when SetInteractionResult marks it dirty, not every net update
+    FDoRepLifetimeParams Params;
+    Params.bIsPushBased = true;
+    DOREPLIFETIME_WITH_PARAMS_FAST(AA1H_MarionetteCharacter, LastInteractionResult, Params);
+}
+
 // Called to bind functionality to input
 void AA1H_MarionetteCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
@@ -4,6 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "WorldCollision.h" // For FTraceDelegate used by the async interaction trace
+#include "Engine/NetSerialization.h" // For the quantized vectors in the interaction RPC
+#include "WorldPartition/WorldPartitionStreamingSource.h" // For the predictive streaming source
 #include "A1H_MarionetteCharacter.generated.h"
 
 // Forward declarations - Tells the compiler these classes exist without needing the full header yet
@@ -11,9 +14,36 @@ class UCameraComponent;
 class USpringArmComponent;
 class UInputMappingContext; // We need this later for the Controller, but good practice to declare types needed by functions
 class UInputAction;
+class USkeletalMesh;
+class UAnimInstance;
+class UA1H_MarionetteStringComponent;
 
-UCLASS()
-class ASSIGNMENT1HINGED_API AA1H_MarionetteCharacter : public ACharacter
+/**
+ * What the server decided about the last interaction request. Replicated so the
+ * requesting client (and anyone watching) finds out what actually happened.
+ */
+USTRUCT(BlueprintType)
+struct FA1H_InteractionResult
+{
+	GENERATED_BODY()
+
+	// What got interacted with, null if the trace found nothing or the request was rejected
+	UPROPERTY(BlueprintReadOnly, Category = "Interaction")
+	TObjectPtr<AActor> Target = nullptr;
+
+	// Bumped for every result so the same outcome twice in a row still replicates
+	UPROPERTY()
+	uint8 Sequence = 0;
+
+	// True if Target took the interaction
+	UPROPERTY(BlueprintReadOnly, Category = "Interaction")
+	bool bSucceeded = false;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FA1H_OnInteractionResult, const FA1H_InteractionResult&, Result);
+
+UCLASS(Config = Game)
+class ASSIGNMENT1HINGED_API AA1H_MarionetteCharacter : public ACharacter, public IWorldPartitionStreamingSourceProvider
 {
 	GENERATED_BODY()
 
@@ -25,6 +55,9 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the character is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 #pragma region Components
 	// Spring Arm: Attaches camera to character but keeps it at a distance, handling collisions
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
@@ -34,6 +67,25 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UCameraComponent* CameraComp;
 
+	// Strings: Control bar strings and limb hinges, solved together with every other marionette's
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UA1H_MarionetteStringComponent* StringComp;
+
+#pragma endregion
+
+#pragma region Soft Assets
+	// Optional: leave the mesh and anim class empty on the Mesh component and set these instead, so the
+	// character Blueprint doesn't drag them in synchronously. Streamed in at BeginPlay and applied when ready.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Assets")
+	TSoftObjectPtr<USkeletalMesh> MarionetteMesh;
+
+	// Anim Blueprint (which carries the control rig) to use with MarionetteMesh
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Assets")
+	TSoftClassPtr<UAnimInstance> MarionetteAnimClass;
+
+	// Applies MarionetteMesh/MarionetteAnimClass once the preload subsystem has them
+	void OnMarionetteAssetsLoaded();
+
 #pragma endregion
 
 #pragma region Interaction
@@ -41,10 +93,132 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction")
 	float InteractionDistance = 350.0f;
 
+	// Use the interactable spatial index to find candidates before tracing (falls back to a plain trace without it)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction")
+	bool bUseInteractableIndex = true;
+
+
+	// Queue the interaction trace through the async trace API and handle the result next frame,
+	// instead of blocking the input callback on a physics query. Set in DefaultGame.ini.
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = "Interaction")
+	bool bUseAsyncInteractionTrace = false;
+
+	// Minimum time between two interaction requests the server accepts from this character
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = "Interaction|Network")
+	float MinInteractInterval = 0.2f;
+
+	// How far (in degrees) a requested interaction direction may be from the aim the server knows about
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = "Interaction|Network")
+	float MaxInteractAimErrorDegrees = 30.0f;
 
-	// Performs a trace to find interactable objects in front of the camera 
+	// Performs a trace to find interactable objects in front of the camera.
+	// On clients this only sends the request, the server runs the trace and replicates the result back.
 	void PerformInteractionCheck();
 
+	// Runs the index lookup and trace from the character along Direction (authority only when networked)
+	void RunInteractionQuery(const FVector& TraceStart, const FVector& TraceDirection);
+
+	// Client -> server: "I pressed interact, looking this way"
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerRequestInteract(FVector_NetQuantizeNormal TraceDirection);
+
+	// Server side record of the last interaction, pushed to clients
+	UPROPERTY(ReplicatedUsing = OnRep_LastInteractionResult, BlueprintReadOnly, Category = "Interaction")
+	FA1H_InteractionResult LastInteractionResult;
+
+	UFUNCTION()
+	void OnRep_LastInteractionResult();
+
+	// Stores the result for replication (authority only)
+	void SetInteractionResult(AActor* Target, bool bSucceeded);
+
+	// Server time the last accepted request came in, for rate limiting
+	double LastInteractRequestTime = -UE_BIG_NUMBER;
+
+	// Rate limit and aim check shared by both interaction RPCs. Records the request either way.
+	bool AcceptInteractRequest(const FVector& TraceDirection);
+
+	// Called by the async trace system once a queued interaction trace is done
+	void OnInteractionTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	// Shared by the sync and async paths: draws the trace and calls Interact on whatever we hit
+	void HandleInteractionTraceResult(const FVector& TraceStart, const FVector& TraceEnd, bool bHit, const FHitResult& HitResult);
+
+	// Bound once and reused for every async interaction trace
+	FTraceDelegate InteractionTraceDelegate;
+
+#if !UE_BUILD_SHIPPING
+	// The last interaction trace (or index early-out), kept for the gameplay debugger
+	struct FInteractionTraceDebug
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		bool bHit = false;
+		bool bValid = false;
+	};
+	FInteractionTraceDebug LastInteractionTrace;
+#endif
+
+#pragma endregion
+
+#pragma region Area Interaction
+	// How far the area interaction reaches from the character
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction|Area", meta = (ClampMin = "0.0"))
+	float AreaInteractionRadius = 1500.0f;
+
+	// Half angle of the cone around the camera forward. 180 turns it into a full sphere.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction|Area", meta = (ClampMin = "0.0", ClampMax = "180.0"))
+	float AreaInteractionHalfAngle = 45.0f;
+
+	// Only the best scoring targets get the interaction. 0 means everything that passes the filter.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction|Area", meta = (ClampMin = "0"))
+	int32 AreaInteractionMaxTargets = 0;
+
+	// Skip targets with something blocking visibility in between
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction|Area")
+	bool bAreaInteractionRequiresLineOfSight = true;
+
+	// How much being near the centre of the cone counts towards the score, versus being close (0..1)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction|Area", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float AreaInteractionAngleWeight = 0.5f;
+
+	// Interacts with every interactable in a cone around the camera forward ("pull every string at once").
+	// Like PerformInteractionCheck, clients only send the request.
+	void PerformAreaInteraction();
+
+	// Gathers, scores and dispatches the area interaction (authority only when networked)
+	void RunAreaInteractionQuery(const FVector& QueryOrigin, const FVector& QueryDirection);
+
+	// Client -> server: "I pressed area interact, looking this way"
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerRequestAreaInteract(FVector_NetQuantizeNormal QueryDirection);
+
+#pragma endregion
+
+#pragma region World Partition Streaming
+	// Adds a second streaming source ahead of the player (along velocity and camera forward) so cells
+	// we're heading into are already loaded by the time we get there. Set in DefaultGame.ini.
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = "Streaming")
+	bool bUsePredictiveStreamingSource = true;
+
+	// How many seconds of current velocity the predictive source runs ahead
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = "Streaming", meta = (ClampMin = "0.0"))
+	float StreamingVelocityLookahead = 2.0f;
+
+	// Extra distance along the (flattened) camera forward, so looking somewhere starts loading it
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = "Streaming", meta = (ClampMin = "0.0"))
+	float StreamingCameraLookahead = 2000.0f;
+
+	// Loading range of the predictive source relative to the grid's own loading range
+	UPROPERTY(EditDefaultsOnly, Config, BlueprintReadOnly, Category = "Streaming", meta = (ClampMin = "0.0"))
+	float StreamingLoadingRangeScale = 0.5f;
+
+	// Where the predictive source sits right now
+	FVector GetPredictedStreamingLocation() const;
+
+	// Built once in BeginPlay, World Partition wants a stable name per source
+	FName PredictiveStreamingSourceName;
+
 #pragma endregion
 
 #pragma region Movement Callbacks (Called BY the PlayerController)
@@ -54,6 +228,9 @@ protected:
 	// Handles moving right/left. Value is -1.0 to +1.0
 	void MoveRight(float Value);
 
+	// Handles both move axes at once (X = right, Y = forward) with a single yaw basis
+	void ApplyMovementInput(const FVector2D& MovementVector);
+
 	// Handles looking up/down. Value is mouse delta or joystick input
 	void LookUp(float Value);
 
@@ -70,6 +247,17 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//~ Begin IWorldPartitionStreamingSourceProvider
+	virtual bool GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const override;
+	virtual const UObject* GetStreamingSourceOwner() override { return this; }
+	//~ End IWorldPartitionStreamingSourceProvider
+
+	// Fires on every machine that learns about a new interaction result (including the server for its own players)
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FA1H_OnInteractionResult OnInteractionResult;
+
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -77,6 +265,12 @@ public:
 	// In this case, I made the movement functions protected, so the controller needs access.
 	friend class AA1H_MarionetteController;
 
+	// The gameplay debugger shows the interaction state and the last trace
+	friend class FA1H_GameplayDebuggerCategory;
+
 	// A helper function to get the Camera Component (useful for the controller or other classes)
 	UCameraComponent* GetCameraComponent() const { return CameraComp; }
+
+	// Strings solved for this marionette (used by the anim instance)
+	UA1H_MarionetteStringComponent* GetStringComponent() const { return StringComp; }
 };
@@ -2,11 +2,37 @@
 
 
 #include "A1H_MarionetteController.h"
+#include "Assignment1Hinged.h"                // For STATGROUP_A1H and the profiling macros
 #include "EnhancedInputComponent.h"         // For UEnhancedInputComponent
 #include "EnhancedInputSubsystems.h"        // For UEnhancedInputLocalPlayerSubsystem
 #include "A1H_MarionetteCharacter.h"        // Include our character class header
 #include "GameFramework/Character.h"        // For ACharacter base class functions
 #include "Engine/LocalPlayer.h"             // For ULocalPlayer
+#include "Misc/App.h"                       // For the fixed timestep used during replay
+#include "Misc/CommandLine.h"               // For -A1HQuitAfterReplay and the soak bot switches
+#include "Misc/Parse.h"
+#include "InputMappingContext.h"            // The soft input assets need their full types to bind
+#include "InputAction.h"
+#include "Loading/A1H_AssetPreloadSubsystem.h" // Streams the input assets in
+#include "Engine/GameInstance.h"
+#include "Performance/A1H_InputLatencySubsystem.h" // For A1H_MARK_INPUT_LATENCY
+#include "Debug/A1H_EventJournal.h"        // Button presses go to the journal instead of the log
+
+DECLARE_CYCLE_STAT(TEXT("Controller BeginPlay"), STAT_A1H_ControllerBeginPlay, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("HandleMove"), STAT_A1H_HandleMove, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("HandleLook"), STAT_A1H_HandleLook, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("HandleJumpStarted"), STAT_A1H_HandleJumpStarted, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("HandleJumpCompleted"), STAT_A1H_HandleJumpCompleted, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("HandleInteract"), STAT_A1H_HandleInteract, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("HandleInteractArea"), STAT_A1H_HandleInteractArea, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("ApplyFrameInput"), STAT_A1H_ApplyFrameInput, STATGROUP_A1H);
+
+#if A1H_WITH_PROFILING
+// Per-controller handler cost for the gameplay debugger, next to the global stat for the same scope
+#define A1H_SCOPE_HANDLER_COST(Handler) FScopedHandlerCost PREPROCESSOR_JOIN(HandlerCost_, __LINE__)(HandlerCosts, EA1H_InputHandler::Handler)
+#else
+#define A1H_SCOPE_HANDLER_COST(Handler)
+#endif
 
 AA1H_MarionetteController::AA1H_MarionetteController()
 {
@@ -15,36 +41,59 @@ AA1H_MarionetteController::AA1H_MarionetteController()
 
 void AA1H_MarionetteController::BeginPlay()
 {
+    LLM_SCOPE_BYTAG(A1H_Marionette);
+
     Super::BeginPlay();
 
+    // Covers kicking off the input asset loads below
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_ControllerBeginPlay);
+
     // Get the Enhanced Input subsystem for the local player
     ULocalPlayer* LocalPlayer = GetLocalPlayer();
-    if (LocalPlayer)
+    if (!LocalPlayer)
     {
-        InputSubsystem = LocalPlayer->GetSubsystem<UEnhancedInputLocalPlayerSubsystem>();
-        if (InputSubsystem)
-        {
-            // Add the default mapping context. Priority 0 is standard.
-            // Make sure DefaultMappingContext is assigned in the Blueprint version of this controller!
-            if (DefaultMappingContext)
-            {
-                InputSubsystem->AddMappingContext(DefaultMappingContext, 0);
-                UE_LOG(LogTemp, Log, TEXT("DefaultMappingContext added successfully."));
-            }
-            else
-            {
-                UE_LOG(LogTemp, Warning, TEXT("DefaultMappingContext is not set in the Player Controller Blueprint!"));
-            }
-        }
-        else
+        // Remote players' controllers on the server (and benchmark controllers) have no input to set up
+        return;
+    }
+
+    InputSubsystem = LocalPlayer->GetSubsystem<UEnhancedInputLocalPlayerSubsystem>();
+    if (!InputSubsystem)
+    {
+        UE_LOG(LogA1H, Error, TEXT("Failed to get Enhanced Input Subsystem!"));
+        return;
+    }
+
+    // Stream the input assets in (most are usually already in flight from the map load preload)
+    // and only bind once they're all there
+    const TArray<FSoftObjectPath> InputAssets = {
+        DefaultMappingContext.ToSoftObjectPath(),
+        ActionMove.ToSoftObjectPath(),
+        ActionLook.ToSoftObjectPath(),
+        ActionJump.ToSoftObjectPath(),
+        ActionInteract.ToSoftObjectPath(),
+        ActionInteractArea.ToSoftObjectPath()
+    };
+
+    if (UA1H_AssetPreloadSubsystem* Preload = GetGameInstance() ? GetGameInstance()->GetSubsystem<UA1H_AssetPreloadSubsystem>() : nullptr)
+    {
+        Preload->RequestAssets(InputAssets, GetClass()->GetName(), FSimpleDelegate::CreateUObject(this, &AA1H_MarionetteController::OnInputAssetsLoaded));
+    }
+    else
+    {
+        // No game instance subsystems (shouldn't happen in a real game) - just load them here and now
+        for (const FSoftObjectPath& InputAsset : InputAssets)
         {
-            UE_LOG(LogTemp, Error, TEXT("Failed to get Enhanced Input Subsystem!"));
+            InputAsset.TryLoad();
         }
+        OnInputAssetsLoaded();
     }
 }
 
 void AA1H_MarionetteController::SetupInputComponent()
 {
+    // The input component and its bindings are per controller
+    LLM_SCOPE_BYTAG(A1H_Marionette);
+
     Super::SetupInputComponent();
 
     // Ensure InputComponent is valid and is the correct type
@@ -53,134 +102,507 @@ void AA1H_MarionetteController::SetupInputComponent()
     EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent);
     if (!EnhancedInputComponent)
     {
-        UE_LOG(LogTemp, Fatal, TEXT("Ensure Enhanced Player Input Component is set in Project Settings."));
+        UE_LOG(LogA1H, Fatal, TEXT("Ensure Enhanced Player Input Component is set in Project Settings."));
         return; // Stop if we don't have the right input component
     }
 
+    // The input assets usually arrive after this, in which case OnInputAssetsLoaded binds instead
+    BindInputActions();
+}
+
+#pragma region Deferred Input Setup
+void AA1H_MarionetteController::OnInputAssetsLoaded()
+{
+    bInputAssetsLoaded = true;
+    BindInputActions();
+}
+
+void AA1H_MarionetteController::BindInputActions()
+{
+    if (bInputBound || !bInputAssetsLoaded || !EnhancedInputComponent)
+    {
+        return;
+    }
+
+    bInputBound = true;
+
+    // Add the default mapping context. Priority 0 is standard.
+    // Make sure DefaultMappingContext is assigned in the Blueprint version of this controller!
+    if (InputSubsystem)
+    {
+        if (UInputMappingContext* MappingContext = DefaultMappingContext.Get())
+        {
+            InputSubsystem->AddMappingContext(MappingContext, 0);
+            UE_LOG(LogA1H, Log, TEXT("DefaultMappingContext added successfully."));
+        }
+        else
+        {
+            UE_LOG(LogA1H, Warning, TEXT("DefaultMappingContext is not set in the Player Controller Blueprint!"));
+        }
+    }
+
 #pragma region Bind Input Actions
     // Make sure the Action assets are assigned in the Blueprint version of this controller!
 
     // Move Action
-    if (ActionMove)
+    if (const UInputAction* Action = ActionMove.Get())
     {
         // ETriggerEvent::Triggered fires every frame the input is active (good for movement)
-        EnhancedInputComponent->BindAction(ActionMove, ETriggerEvent::Triggered, this, &AA1H_MarionetteController::HandleMove);
+        EnhancedInputComponent->BindAction(Action, ETriggerEvent::Triggered, this, &AA1H_MarionetteController::HandleMove);
     }
-    else UE_LOG(LogTemp, Warning, TEXT("ActionMove is not set!"));
+    else UE_LOG(LogA1H, Warning, TEXT("ActionMove is not set!"));
 
     // Look Action
-    if (ActionLook)
+    if (const UInputAction* Action = ActionLook.Get())
     {
         // ETriggerEvent::Triggered fires every frame the input is active (good for looking)
-        EnhancedInputComponent->BindAction(ActionLook, ETriggerEvent::Triggered, this, &AA1H_MarionetteController::HandleLook);
+        EnhancedInputComponent->BindAction(Action, ETriggerEvent::Triggered, this, &AA1H_MarionetteController::HandleLook);
     }
-    else UE_LOG(LogTemp, Warning, TEXT("ActionLook is not set!"));
+    else UE_LOG(LogA1H, Warning, TEXT("ActionLook is not set!"));
 
     // Jump Action
-    if (ActionJump)
+    if (const UInputAction* Action = ActionJump.Get())
     {
         // ETriggerEvent::Started fires once when the input begins (button pressed)
-        EnhancedInputComponent->BindAction(ActionJump, ETriggerEvent::Started, this, &AA1H_MarionetteController::HandleJumpStarted);
+        EnhancedInputComponent->BindAction(Action, ETriggerEvent::Started, this, &AA1H_MarionetteController::HandleJumpStarted);
         // ETriggerEvent::Completed fires once when the input ends (button released)
-        EnhancedInputComponent->BindAction(ActionJump, ETriggerEvent::Completed, this, &AA1H_MarionetteController::HandleJumpCompleted);
+        EnhancedInputComponent->BindAction(Action, ETriggerEvent::Completed, this, &AA1H_MarionetteController::HandleJumpCompleted);
     }
-    else UE_LOG(LogTemp, Warning, TEXT("ActionJump is not set!"));
+    else UE_LOG(LogA1H, Warning, TEXT("ActionJump is not set!"));
 
     // Interact Action
-    if (ActionInteract)
+    if (const UInputAction* Action = ActionInteract.Get())
     {
         // ETriggerEvent::Started fires once when the input begins (usually what you want for interaction)
-        EnhancedInputComponent->BindAction(ActionInteract, ETriggerEvent::Started, this, &AA1H_MarionetteController::HandleInteract);
+        EnhancedInputComponent->BindAction(Action, ETriggerEvent::Started, this, &AA1H_MarionetteController::HandleInteract);
+    }
+    else UE_LOG(LogA1H, Warning, TEXT("ActionInteract is not set!"));
+
+    // Area Interact Action (optional - not every setup wants the multi-target mechanic)
+    if (const UInputAction* Action = ActionInteractArea.Get())
+    {
+        EnhancedInputComponent->BindAction(Action, ETriggerEvent::Started, this, &AA1H_MarionetteController::HandleInteractArea);
     }
-    else UE_LOG(LogTemp, Warning, TEXT("ActionInteract is not set!"));
 
-    UE_LOG(LogTemp, Log, TEXT("Input bindings set up."));
+    UE_LOG(LogA1H, Log, TEXT("Input bindings set up."));
 
 #pragma endregion
 
+    ReportControllable();
+}
+
+void AA1H_MarionetteController::ReportControllable()
+{
+    // Controllable = input is bound and there's a marionette to drive
+    if (!bInputBound || !ControlledCharacter || !IsLocalController())
+    {
+        return;
+    }
+
+    if (UA1H_AssetPreloadSubsystem* Preload = GetGameInstance() ? GetGameInstance()->GetSubsystem<UA1H_AssetPreloadSubsystem>() : nullptr)
+    {
+        Preload->MarkControllable();
+    }
 }
 
+#pragma endregion
+
 #pragma region Input Handler Implementation
 AA1H_MarionetteCharacter* AA1H_MarionetteController::GetControlledCharacter() const
 {
-    // GetPawn() returns the generic APawn the controller possesses.
+    // Cached in SetPawn, so no Cast of GetPawn() every time an input event fires
+    return ControlledCharacter;
+}
+
+void AA1H_MarionetteController::SetPawn(APawn* InPawn)
+{
+    Super::SetPawn(InPawn);
+
+    // SetPawn runs on possess, unpossess and pawn replication, so this is the one place the cache needs refreshing.
     // We need to cast it to our specific character class to access its functions.
-    return Cast<AA1H_MarionetteCharacter>(GetPawn());
+    ControlledCharacter = Cast<AA1H_MarionetteCharacter>(InPawn);
+
+    // Possession can be the last thing missing for the startup report
+    ReportControllable();
+
+    // Soak test bots: -A1HReplayOnPossess=Name starts replaying as soon as there's a marionette to drive.
+    // Has to wait for possession because ExecCmds run before a client has even connected.
+    FString BotRecording;
+    if (ControlledCharacter && IsLocalController() && !IsReplayingInput()
+        && FParse::Value(FCommandLine::Get(), TEXT("A1HReplayOnPossess="), BotRecording))
+    {
+        A1HReplayInput(BotRecording);
+    }
 }
 
 void AA1H_MarionetteController::HandleMove(const FInputActionValue& Value)
 {
-    AA1H_MarionetteCharacter* MyCharacter = GetControlledCharacter();
-    if (!MyCharacter)
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_HandleMove);
+    A1H_SCOPE_HANDLER_COST(Move);
+
+    if (!FilterAndRecordInput(EA1H_RecordedInput::Move, Value))
     {
-        UE_LOG(LogTemp, Warning, TEXT("HandleMove: Controlled character is null or not AA1H_MarionetteCharacter"));
         return;
     }
 
-    // Value is a FVector2D (because IA_Move is Axis2D)
-    const FVector2D MovementVector = Value.Get<FVector2D>();
-
-    // Tell the character to move forward/backward based on the Y component
-    MyCharacter->MoveForward(MovementVector.Y);
+    A1H_MARK_INPUT_LATENCY(this, EA1H_LatencyInput::Move, Value.Get<FVector2D>());
 
-    // Tell the character to move right/left based on the X component
-    MyCharacter->MoveRight(MovementVector.X);
+    // Value is a FVector2D (because IA_Move is Axis2D). Applied once per frame in ApplyFrameInput.
+    PendingFrameInput.Move += Value.Get<FVector2D>();
+    PendingFrameInput.bHasMove = true;
 }
 
 void AA1H_MarionetteController::HandleLook(const FInputActionValue& Value)
 {
-    AA1H_MarionetteCharacter* MyCharacter = GetControlledCharacter();
-    if (!MyCharacter)
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_HandleLook);
+    A1H_SCOPE_HANDLER_COST(Look);
+
+    if (!FilterAndRecordInput(EA1H_RecordedInput::Look, Value))
     {
-        UE_LOG(LogTemp, Warning, TEXT("HandleLook: Controlled character is null or not AA1H_MarionetteCharacter"));
         return;
     }
 
-    // Value is FVector2D (because IA_Look is Axis2D)
-    const FVector2D LookAxisVector = Value.Get<FVector2D>();
-
-    // Tell the character to look right/left based on X component
-    MyCharacter->LookRight(LookAxisVector.X);
+    A1H_MARK_INPUT_LATENCY(this, EA1H_LatencyInput::Look, Value.Get<FVector2D>());
 
-    // Tell the character to look up/down based on Y component
-    MyCharacter->LookUp(LookAxisVector.Y);
+    // Value is FVector2D (because IA_Look is Axis2D). Look deltas just add up over the frame.
+    PendingFrameInput.Look += Value.Get<FVector2D>();
+    PendingFrameInput.bHasLook = true;
 }
 
 void AA1H_MarionetteController::HandleJumpStarted(const FInputActionValue& Value)
 {
-    AA1H_MarionetteCharacter* MyCharacter = GetControlledCharacter();
-    if (!MyCharacter) return;
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_HandleJumpStarted);
+    A1H_SCOPE_HANDLER_COST(Jump);
 
-    // ACharacter has built-in Jump functionality
-    MyCharacter->Jump();
-    UE_LOG(LogTemp, Log, TEXT("Jump Started"));
+    if (!FilterAndRecordInput(EA1H_RecordedInput::JumpStarted, Value))
+    {
+        return;
+    }
+
+    A1H_MARK_INPUT_LATENCY(this, EA1H_LatencyInput::Jump, FVector2D::UnitX());
+
+    PendingFrameInput.ButtonEvents.Add(EA1H_RecordedInput::JumpStarted);
 }
 
 void AA1H_MarionetteController::HandleJumpCompleted(const FInputActionValue& Value)
 {
-    AA1H_MarionetteCharacter* MyCharacter = GetControlledCharacter();
-    if (!MyCharacter) return;
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_HandleJumpCompleted);
+    A1H_SCOPE_HANDLER_COST(Jump);
 
-    // ACharacter has built-in Jump functionality
-    MyCharacter->StopJumping();
-    UE_LOG(LogTemp, Log, TEXT("Jump Completed"));
+    if (!FilterAndRecordInput(EA1H_RecordedInput::JumpCompleted, Value))
+    {
+        return;
+    }
+
+    PendingFrameInput.ButtonEvents.Add(EA1H_RecordedInput::JumpCompleted);
 }
 
 void AA1H_MarionetteController::HandleInteract(const FInputActionValue& Value)
 {
-    AA1H_MarionetteCharacter* MyCharacter = GetControlledCharacter();
-    if (!MyCharacter)
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_HandleInteract);
+    A1H_SCOPE_HANDLER_COST(Interact);
+
+    if (!FilterAndRecordInput(EA1H_RecordedInput::Interact, Value))
     {
-        UE_LOG(LogTemp, Warning, TEXT("HandleInteract: Controlled character is null or not AA1H_MarionetteCharacter"));
         return;
     }
 
     // Value is a bool (because IA_Interact is Digital)
     // We already check ETriggerEvent::Started, but could add if (Value.Get<bool>()) for safety
-    UE_LOG(LogTemp, Log, TEXT("Interact Action Triggered"));
+    PendingFrameInput.ButtonEvents.Add(EA1H_RecordedInput::Interact);
+}
+
+void AA1H_MarionetteController::HandleInteractArea(const FInputActionValue& Value)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_HandleInteractArea);
+    A1H_SCOPE_HANDLER_COST(InteractArea);
+
+    if (!FilterAndRecordInput(EA1H_RecordedInput::InteractArea, Value))
+    {
+        return;
+    }
+
+    PendingFrameInput.ButtonEvents.Add(EA1H_RecordedInput::InteractArea);
+}
+
+void AA1H_MarionetteController::TickPlayerInput(const float DeltaSeconds, const bool bGamePaused)
+{
+    // Replayed input has to go in before Super processes this frame's input, exactly where live input would
+    TickInputReplay();
+
+    Super::TickPlayerInput(DeltaSeconds, bGamePaused);
+
+    // Everything for this frame has been gathered now. Apply it before PlayerTick runs UpdateRotation,
+    // so look input still lands on the same frame it arrived.
+    ApplyFrameInput();
+
+#if A1H_WITH_PROFILING
+    HandlerCosts.EndFrame();
+#endif
+}
+
+void AA1H_MarionetteController::ApplyFrameInput()
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_ApplyFrameInput);
+    A1H_SCOPE_HANDLER_COST(ApplyFrameInput);
+
+#if A1H_WITH_PROFILING
+    HandlerCosts.LastAppliedEvents = PendingFrameInput.ButtonEvents.Num() + (PendingFrameInput.bHasMove ? 1 : 0) + (PendingFrameInput.bHasLook ? 1 : 0);
+    HandlerCosts.PeakAppliedEvents = FMath::Max(HandlerCosts.PeakAppliedEvents, HandlerCosts.LastAppliedEvents);
+#endif
+
+    if (PendingFrameInput.IsEmpty())
+    {
+        return;
+    }
+
+    AA1H_MarionetteCharacter* MyCharacter = GetControlledCharacter();
+    if (!MyCharacter)
+    {
+        // Happens every frame input arrives while unpossessed, so it goes to the journal and only Verbose to the log
+        FA1H_EventJournal::Record(EA1H_JournalEvent::MissingCharacter, this);
+        UE_LOG(LogA1H, Verbose, TEXT("ApplyFrameInput: Controlled character is null or not AA1H_MarionetteCharacter"));
+        PendingFrameInput.Reset();
+        return;
+    }
+
+    if (PendingFrameInput.bHasMove)
+    {
+        // One yaw basis for both axes instead of one per MoveForward/MoveRight call
+        MyCharacter->ApplyMovementInput(PendingFrameInput.Move);
+    }
+
+    if (PendingFrameInput.bHasLook)
+    {
+        // Tell the character to look right/left based on X component
+        MyCharacter->LookRight(PendingFrameInput.Look.X);
+
+        // Tell the character to look up/down based on Y component
+        MyCharacter->LookUp(PendingFrameInput.Look.Y);
+    }
+
+    // Buttons go through in the order they were pressed, so press+release in one frame still behaves
+    for (const EA1H_RecordedInput ButtonEvent : PendingFrameInput.ButtonEvents)
+    {
+        switch (ButtonEvent)
+        {
+        case EA1H_RecordedInput::JumpStarted:
+            // ACharacter has built-in Jump functionality
+            MyCharacter->Jump();
+            FA1H_EventJournal::Record(EA1H_JournalEvent::JumpStarted, MyCharacter);
+            break;
+
+        case EA1H_RecordedInput::JumpCompleted:
+            MyCharacter->StopJumping();
+            FA1H_EventJournal::Record(EA1H_JournalEvent::JumpCompleted, MyCharacter);
+            break;
+
+        case EA1H_RecordedInput::Interact:
+            FA1H_EventJournal::Record(EA1H_JournalEvent::Interact, MyCharacter);
+
+            // Tell the character to perform its interaction check logic
+            MyCharacter->PerformInteractionCheck();
+            break;
+
+        case EA1H_RecordedInput::InteractArea:
+            FA1H_EventJournal::Record(EA1H_JournalEvent::InteractArea, MyCharacter);
+            MyCharacter->PerformAreaInteraction();
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    PendingFrameInput.Reset();
+}
+
+#pragma endregion
+
+#pragma region Input Recording And Replay
+void AA1H_MarionetteController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (ActiveReplay)
+    {
+        FinishInputReplay(false);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
 
-    // Tell the character to perform its interaction check logic
-    MyCharacter->PerformInteractionCheck();
+bool AA1H_MarionetteController::FilterAndRecordInput(EA1H_RecordedInput Action, const FInputActionValue& Value)
+{
+    // While replaying, only the replay gets to drive the marionette
+    if (ActiveReplay && !bDispatchingReplay)
+    {
+        return false;
+    }
+
+    if (ActiveRecording)
+    {
+        FA1H_RecordedInputEvent& Event = ActiveRecording->Events.AddDefaulted_GetRef();
+        Event.Frame = static_cast<uint32>(GFrameCounter - RecordingStartFrame);
+        Event.Action = Action;
+        if (FA1H_InputRecording::IsAxisAction(Action))
+        {
+            Event.Value = FVector2f(Value.Get<FVector2D>());
+        }
+    }
+
+    return true;
+}
+
+void AA1H_MarionetteController::A1HRecordInput()
+{
+    if (ActiveReplay)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1HRecordInput: can't record while a replay is running."));
+        return;
+    }
+
+    ActiveRecording = MakeUnique<FA1H_InputRecording>();
+    RecordingStartFrame = GFrameCounter;
+    RecordingStartTime = FPlatformTime::Seconds();
+    UE_LOG(LogA1H, Log, TEXT("Input recording started."));
 }
 
-#pragma endregion
\ No newline at end of file
+void AA1H_MarionetteController::A1HStopRecordInput(const FString& Name)
+{
+    if (!ActiveRecording)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1HStopRecordInput: not recording."));
+        return;
+    }
+
+    // Replay at the average frame time of the real session so it covers the same amount of game time
+    const uint32 NumFrames = static_cast<uint32>(FMath::Max<uint64>(GFrameCounter - RecordingStartFrame, 1));
+    ActiveRecording->NumFrames = NumFrames;
+    ActiveRecording->FixedDeltaTime = static_cast<float>((FPlatformTime::Seconds() - RecordingStartTime) / NumFrames);
+
+    const FString FilePath = FA1H_InputRecording::GetRecordingPath(Name.IsEmpty() ? TEXT("Default") : Name);
+    if (ActiveRecording->SaveToFile(FilePath))
+    {
+        UE_LOG(LogA1H, Log, TEXT("Saved %d input events over %u frames to %s"), ActiveRecording->Events.Num(), NumFrames, *FilePath);
+    }
+    else
+    {
+        UE_LOG(LogA1H, Error, TEXT("Failed to save input recording to %s"), *FilePath);
+    }
+
+    ActiveRecording.Reset();
+}
+
+void AA1H_MarionetteController::A1HReplayInput(const FString& Name)
+{
+    if (ActiveRecording || ActiveReplay)
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1HReplayInput: already recording or replaying."));
+        return;
+    }
+
+    TUniquePtr<FA1H_InputRecording> Recording = MakeUnique<FA1H_InputRecording>();
+    const FString FilePath = FA1H_InputRecording::GetRecordingPath(Name.IsEmpty() ? TEXT("Default") : Name);
+    if (!Recording->LoadFromFile(FilePath))
+    {
+        UE_LOG(LogA1H, Error, TEXT("Failed to load input recording %s"), *FilePath);
+        return;
+    }
+
+    // It goes straight into FApp's fixed step, so anything that isn't a real step length would stall or break the engine tick
+    if (!FMath::IsFinite(Recording->FixedDeltaTime) || Recording->FixedDeltaTime <= 0.0f)
+    {
+        UE_LOG(LogA1H, Error, TEXT("Input recording %s has an invalid frame time (%f), not replaying it"), *FilePath, Recording->FixedDeltaTime);
+        return;
+    }
+
+    ActiveReplay = MoveTemp(Recording);
+    ActiveReplayName = Name;
+    ReplayCursor = 0;
+    ReplayFrame = 0;
+    ReplayStartTime = FPlatformTime::Seconds();
+
+    // Fixed step so the same recording always produces the same simulation, whatever the machine
+    bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+    PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+    FApp::SetUseFixedTimeStep(true);
+    FApp::SetFixedDeltaTime(ActiveReplay->FixedDeltaTime);
+
+    UE_LOG(LogA1H, Log, TEXT("Replaying %d input events over %u frames at %.4fs per frame from %s"),
+        ActiveReplay->Events.Num(), ActiveReplay->NumFrames, ActiveReplay->FixedDeltaTime, *FilePath);
+}
+
+void AA1H_MarionetteController::TickInputReplay()
+{
+    if (!ActiveReplay)
+    {
+        return;
+    }
+
+    TGuardValue<bool> DispatchGuard(bDispatchingReplay, true);
+
+    const TArray<FA1H_RecordedInputEvent>& Events = ActiveReplay->Events;
+    while (Events.IsValidIndex(ReplayCursor) && Events[ReplayCursor].Frame <= ReplayFrame)
+    {
+        const FA1H_RecordedInputEvent& Event = Events[ReplayCursor++];
+        switch (Event.Action)
+        {
+        case EA1H_RecordedInput::Move:
+            HandleMove(FInputActionValue(FVector2D(Event.Value)));
+            break;
+        case EA1H_RecordedInput::Look:
+            HandleLook(FInputActionValue(FVector2D(Event.Value)));
+            break;
+        case EA1H_RecordedInput::JumpStarted:
+            HandleJumpStarted(FInputActionValue(true));
+            break;
+        case EA1H_RecordedInput::JumpCompleted:
+            HandleJumpCompleted(FInputActionValue(false));
+            break;
+        case EA1H_RecordedInput::Interact:
+            HandleInteract(FInputActionValue(true));
+            break;
+        case EA1H_RecordedInput::InteractArea:
+            HandleInteractArea(FInputActionValue(true));
+            break;
+        default:
+            break;
+        }
+    }
+
+    ++ReplayFrame;
+    if (ReplayFrame >= ActiveReplay->NumFrames && !Events.IsValidIndex(ReplayCursor))
+    {
+        FinishInputReplay(true);
+    }
+}
+
+void AA1H_MarionetteController::FinishInputReplay(bool bReachedEnd)
+{
+    const double WallSeconds = FPlatformTime::Seconds() - ReplayStartTime;
+    UE_LOG(LogA1H, Log, TEXT("Input replay finished: %u frames in %.2fs (%.2f ms/frame)"),
+        ReplayFrame, WallSeconds, ReplayFrame > 0 ? WallSeconds * 1000.0 / ReplayFrame : 0.0);
+
+    FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+    FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+    ActiveReplay.Reset();
+
+    if (!bReachedEnd)
+    {
+        return;
+    }
+
+    // Soak test bots keep going until the harness shuts them down
+    if (FParse::Param(FCommandLine::Get(), TEXT("A1HLoopReplay")))
+    {
+        A1HReplayInput(ActiveReplayName);
+        return;
+    }
+
+    // Handy for unattended perf runs: -ExecCmds="A1HReplayInput Session" -A1HQuitAfterReplay
+    if (FParse::Param(FCommandLine::Get(), TEXT("A1HQuitAfterReplay")))
+    {
+        FPlatformMisc::RequestExit(false, TEXT("A1H input replay finished"));
+    }
+}
+
+#pragma endregion
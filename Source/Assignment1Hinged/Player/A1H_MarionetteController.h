@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
 #include "InputActionValue.h" // Required for Enhanced Input action handler parameters
+#include "A1H_InputRecording.h" // For recording/replaying the input stream
+#include "Assignment1Hinged.h" // For A1H_WITH_PROFILING
 #include "A1H_MarionetteController.generated.h"
 
 
@@ -15,6 +17,64 @@ class AA1H_MarionetteCharacter; // Forward declare the character class
 class UEnhancedInputLocalPlayerSubsystem; // Forward declare subsystem
 class UEnhancedInputComponent; // Forward declare input component type
 
+/**
+ * Everything the input handlers received during one frame. The handlers only fill this in,
+ * the controller pushes it to the character once per frame.
+ */
+struct FA1H_FrameInput
+{
+    FVector2D Move = FVector2D::ZeroVector;
+    FVector2D Look = FVector2D::ZeroVector;
+    bool bHasMove = false;
+    bool bHasLook = false;
+
+    // Jump/interact presses in arrival order
+    TArray<EA1H_RecordedInput, TInlineAllocator<4>> ButtonEvents;
+
+    bool IsEmpty() const { return !bHasMove && !bHasLook && ButtonEvents.IsEmpty(); }
+    void Reset() { *this = FA1H_FrameInput(); }
+};
+
+#if A1H_WITH_PROFILING
+// The input handlers timed per controller, for the gameplay debugger
+enum class EA1H_InputHandler : uint8
+{
+    Move,
+    Look,
+    Jump,               // Started and completed
+    Interact,
+    InteractArea,
+    ApplyFrameInput,
+
+    Count
+};
+
+/**
+ * What one controller's input handlers cost, per frame. Unlike the A1H stats these are per controller,
+ * so the gameplay debugger can show them for whichever marionette it's looking at.
+ */
+struct FA1H_HandlerCosts
+{
+    static constexpr int32 NumHandlers = static_cast<int32>(EA1H_InputHandler::Count);
+
+    // Cycles spent in each handler during the last finished frame
+    uint64 LastFrameCycles[NumHandlers] = {};
+
+    // ...and during this one so far
+    uint64 FrameCycles[NumHandlers] = {};
+
+    // Input events (move, look, buttons) the last ApplyFrameInput had queued up, and the most it's ever had
+    int32 LastAppliedEvents = 0;
+    int32 PeakAppliedEvents = 0;
+
+    void EndFrame()
+    {
+        FMemory::Memcpy(LastFrameCycles, FrameCycles, sizeof(FrameCycles));
+        FMemory::Memzero(FrameCycles);
+    }
+};
+#endif
+
 /**
  * 
  */
@@ -34,29 +94,60 @@ protected:
 	//Called to bind functionality to input.
 	virtual void SetupInputComponent() override;
 
+	//Called every frame for local players to process input. Replay and the per-frame input apply hook in here.
+	virtual void TickPlayerInput(const float DeltaSeconds, const bool bGamePaused) override;
+
+	//Keeps the cached character pointer in sync with possession.
+	virtual void SetPawn(APawn* InPawn) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 #pragma region Input Assets
-    // These properties will allow us to assign our IA and IMC assets in the Blueprint subclass
+    // These properties will allow us to assign our IA and IMC assets in the Blueprint subclass.
+    // They're soft so they don't load with the controller Blueprint - BeginPlay streams them in
+    // and binds the input once they're ready.
 
     // The Input Mapping Context to use for default controls.
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player Input|Character Movement")
-    TObjectPtr<UInputMappingContext> DefaultMappingContext; // TObjectPtr is safer than raw pointers
+    TSoftObjectPtr<UInputMappingContext> DefaultMappingContext;
 
     // Input Action for moving forward/backward/left/right.
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player Input|Character Movement")
-    TObjectPtr<UInputAction> ActionMove;
+    TSoftObjectPtr<UInputAction> ActionMove;
 
     // Input Action for looking around.
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player Input|Character Movement")
-    TObjectPtr<UInputAction> ActionLook;
+    TSoftObjectPtr<UInputAction> ActionLook;
 
     // Input Action for jumping.
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player Input|Character Movement")
-    TObjectPtr<UInputAction> ActionJump;
+    TSoftObjectPtr<UInputAction> ActionJump;
 
     // Input Action for interacting.
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player Input|Character Movement")
-    TObjectPtr<UInputAction> ActionInteract;
+    TSoftObjectPtr<UInputAction> ActionInteract;
+
+    // Input Action for interacting with everything in front of us at once.
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player Input|Character Movement")
+    TSoftObjectPtr<UInputAction> ActionInteractArea;
+
+#pragma endregion
+
+public:
+#pragma region Input Recording And Replay
+    // Console: starts recording every input event that reaches the handlers below.
+    UFUNCTION(Exec)
+    void A1HRecordInput();
+
+    // Console: stops recording and saves it to Saved/InputRecordings/<Name>.a1hinput
+    UFUNCTION(Exec)
+    void A1HStopRecordInput(const FString& Name);
 
+    // Console: replays a saved recording through the same handlers at a fixed timestep. Live input is ignored meanwhile.
+    UFUNCTION(Exec)
+    void A1HReplayInput(const FString& Name);
+
+    bool IsReplayingInput() const { return ActiveReplay.IsValid(); }
 
 #pragma endregion
 
@@ -79,12 +170,65 @@ private:
     // Called when the Interact input action is triggered (usually on start).
     void HandleInteract(const FInputActionValue& Value);
 
+    // Called when the area Interact input action is started.
+    void HandleInteractArea(const FInputActionValue& Value);
+
 #pragma endregion
 
+#pragma region Deferred Input Setup
+    // Called by the preload subsystem once every input asset above is in memory
+    void OnInputAssetsLoaded();
+
+    // Adds the mapping context and binds the actions. Needs both the assets and the input component.
+    void BindInputActions();
+
+    // Tells the preload subsystem we're controllable, if we are
+    void ReportControllable();
+
+    bool bInputAssetsLoaded = false;
+    bool bInputBound = false;
+
+#pragma endregion
+
+#pragma region Input Coalescing
+    // Applies the gathered frame input to the character and clears it.
+    void ApplyFrameInput();
+
+    FA1H_FrameInput PendingFrameInput;
+
+#pragma endregion
+
+#if A1H_WITH_PROFILING
+public:
+    const FA1H_HandlerCosts& GetHandlerCosts() const { return HandlerCosts; }
+
+private:
+    // Adds the time until the end of the scope to one handler's cost this frame
+    struct FScopedHandlerCost
+    {
+        FScopedHandlerCost(FA1H_HandlerCosts& InCosts, EA1H_InputHandler InHandler)
+            : Cycles(InCosts.FrameCycles[static_cast<int32>(InHandler)])
+            , StartCycles(FPlatformTime::Cycles64())
+        {
+        }
+
+        ~FScopedHandlerCost() { Cycles += FPlatformTime::Cycles64() - StartCycles; }
+
+        uint64& Cycles;
+        uint64 StartCycles;
+    };
+
+    FA1H_HandlerCosts HandlerCosts;
+#endif
+
 #pragma region Helper Functions
     // Utility function to get the controlled character cast to our specific class.
     AA1H_MarionetteCharacter* GetControlledCharacter() const;
 
+    // The possessed pawn as a marionette (null if we don't have one, or it's something else)
+    UPROPERTY()
+    TObjectPtr<AA1H_MarionetteCharacter> ControlledCharacter = nullptr;
+
     // Cached pointers to avoid frequent casting or lookups
     UPROPERTY() // UPROPERTY prevents garbage collection
         TObjectPtr<UEnhancedInputComponent> EnhancedInputComponent = nullptr;
@@ -94,4 +238,45 @@ private:
 
 #pragma endregion
 
+#pragma region Input Recording And Replay State
+    // Records the event if we're recording. Returns false if the event should be dropped (live input during a replay).
+    bool FilterAndRecordInput(EA1H_RecordedInput Action, const FInputActionValue& Value);
+
+    // Feeds this frame's recorded events back into the handlers
+    void TickInputReplay();
+
+    // Stops the replay and restores the time step. Only a replay that reached its end (bReachedEnd) loops or quits
+    // for -A1HLoopReplay/-A1HQuitAfterReplay, one cut short by EndPlay just stops.
+    void FinishInputReplay(bool bReachedEnd);
+
+    TUniquePtr<FA1H_InputRecording> ActiveRecording;
+    uint64 RecordingStartFrame = 0;
+    double RecordingStartTime = 0.0;
+
+    TUniquePtr<FA1H_InputRecording> ActiveReplay;
+    FString ActiveReplayName;
+    int32 ReplayCursor = 0;
+    uint32 ReplayFrame = 0;
+    double ReplayStartTime = 0.0;
+
+    // True while TickInputReplay is calling the handlers, so they know the input isn't live
+    bool bDispatchingReplay = false;
+
+    // Timestep settings to put back once the replay is done
+    bool bPreviousUseFixedTimeStep = false;
+    double PreviousFixedDeltaTime = 0.0;
+
+#pragma endregion
+
+    // The headless benchmark drives the Handle* functions directly with synthetic input values
+    friend class FA1H_MarionetteBenchmark;
+
+    // So does the fast-forward soak mode, with seeded input
+    friend class FA1H_FastForward;
+
+    // And the actor pool benchmark, with interaction spam
+    friend class FA1H_ActorPoolBenchmark;
+
+    // The input latency test injects into the bound input actions and waits for the binding
+    friend class FA1H_InputLatencyTestCommand;
 };
@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_ActorPoolSubsystem.h"
+#include "Assignment1Hinged.h"                  // For STATGROUP_A1H and the profiling macros
+#include "A1H_PooledActorInterface.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Actor Pool Acquire"), STAT_A1H_ActorPoolAcquire, STATGROUP_A1H);
+DECLARE_CYCLE_STAT(TEXT("Actor Pool Release"), STAT_A1H_ActorPoolRelease, STATGROUP_A1H);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Pool Hits"), STAT_A1H_ActorPoolHits, STATGROUP_A1H);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Pool Misses"), STAT_A1H_ActorPoolMisses, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Actor Pool Idle"), STAT_A1H_ActorPoolIdle, STATGROUP_A1H);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Actor Pool In Use"), STAT_A1H_ActorPoolInUse, STATGROUP_A1H);
+
+#pragma region Subsystem Lifetime
+void UA1H_ActorPoolSubsystem::Deinitialize()
+{
+    // The world is going away and takes every actor with it
+    Pools.Reset();
+    InUseActors.Reset();
+    SET_DWORD_STAT(STAT_A1H_ActorPoolIdle, 0);
+    SET_DWORD_STAT(STAT_A1H_ActorPoolInUse, 0);
+
+    Super::Deinitialize();
+}
+
+void UA1H_ActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // The map is loading anyway, so a synchronous load here is the cheapest it'll ever be
+    for (const FA1H_ActorPoolPrewarm& Entry : PrewarmPools)
+    {
+        if (UClass* ActorClass = Entry.ActorClass.LoadSynchronous())
+        {
+            Prewarm(ActorClass, Entry.Count);
+        }
+        else
+        {
+            UE_LOG(LogA1H, Warning, TEXT("A1H actor pool: couldn't load %s to prewarm"), *Entry.ActorClass.ToString());
+        }
+    }
+}
+
+bool UA1H_ActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+#pragma endregion
+
+#pragma region Pooling
+AActor* UA1H_ActorPoolSubsystem::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_ActorPoolAcquire);
+    LLM_SCOPE_BYTAG(A1H_Pooling);
+
+    if (!ActorClass)
+    {
+        return nullptr;
+    }
+
+    FPool& Pool = Pools.FindOrAdd(ActorClass.Get());
+    ++Pool.Stats.Acquires;
+
+    // Newest first, it's the most likely to still be in cache. Skip anything that got destroyed behind our back.
+    AActor* Actor = nullptr;
+    while (!Actor && !Pool.Idle.IsEmpty())
+    {
+        Actor = Pool.Idle.Pop(EAllowShrinking::No).Get();
+    }
+
+    if (Actor)
+    {
+        ++Pool.Stats.Hits;
+        DEC_DWORD_STAT(STAT_A1H_ActorPoolIdle);
+        INC_DWORD_STAT(STAT_A1H_ActorPoolHits);
+        CSV_CUSTOM_STAT(A1H, ActorPoolHits, 1, ECsvCustomStatOp::Accumulate);
+        Activate(Actor, Transform, Owner, Instigator);
+    }
+    else
+    {
+        INC_DWORD_STAT(STAT_A1H_ActorPoolMisses);
+        CSV_CUSTOM_STAT(A1H, ActorPoolMisses, 1, ECsvCustomStatOp::Accumulate);
+        Actor = SpawnForPool(ActorClass, Transform, Owner, Instigator);
+        if (!Actor)
+        {
+            return nullptr;
+        }
+    }
+
+    Pool.Stats.Idle = Pool.Idle.Num();
+    ++Pool.Stats.InUse;
+    UpdatePeak(Pool);
+    InUseActors.Add(Actor);
+    INC_DWORD_STAT(STAT_A1H_ActorPoolInUse);
+
+    if (Actor->Implements<UA1H_PooledActorInterface>())
+    {
+        IA1H_PooledActorInterface::Execute_OnAcquiredFromPool(Actor);
+    }
+    return Actor;
+}
+
+void UA1H_ActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+    A1H_SCOPE_CYCLE_COUNTER(STAT_A1H_ActorPoolRelease);
+
+    if (!IsValid(Actor) || Actor->GetWorld() != GetWorld())
+    {
+        return;
+    }
+
+    FPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+    if (InUseActors.Remove(Actor) > 0)
+    {
+        --Pool.Stats.InUse;
+        DEC_DWORD_STAT(STAT_A1H_ActorPoolInUse);
+    }
+    else if (Pool.Idle.Contains(Actor))
+    {
+        UE_LOG(LogA1H, Warning, TEXT("A1H actor pool: %s was released twice"), *Actor->GetName());
+        return;
+    }
+    else
+    {
+        // Spawned by someone else, but it can be reused all the same
+        Actor->OnDestroyed.AddUniqueDynamic(this, &UA1H_ActorPoolSubsystem::HandlePooledActorDestroyed);
+    }
+
+    ++Pool.Stats.Releases;
+    if (Pool.Idle.Num() >= MaxIdlePerClass)
+    {
+        ++Pool.Stats.Overflows;
+        Actor->Destroy();
+        return;
+    }
+
+    if (Actor->Implements<UA1H_PooledActorInterface>())
+    {
+        IA1H_PooledActorInterface::Execute_OnReleasedToPool(Actor);
+    }
+
+    Park(Actor);
+    Pool.Idle.Add(Actor);
+    Pool.Stats.Idle = Pool.Idle.Num();
+    UpdatePeak(Pool);
+    INC_DWORD_STAT(STAT_A1H_ActorPoolIdle);
+}
+
+void UA1H_ActorPoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+    if (!ActorClass)
+    {
+        return;
+    }
+
+    LLM_SCOPE_BYTAG(A1H_Pooling);
+
+    FPool& Pool = Pools.FindOrAdd(ActorClass.Get());
+    const int32 Target = FMath::Min(Count, MaxIdlePerClass);
+    while (Pool.Idle.Num() < Target)
+    {
+        AActor* Actor = SpawnForPool(ActorClass, FTransform::Identity, nullptr, nullptr);
+        if (!Actor)
+        {
+            break;
+        }
+
+        Park(Actor);
+        Pool.Idle.Add(Actor);
+        INC_DWORD_STAT(STAT_A1H_ActorPoolIdle);
+    }
+
+    Pool.Stats.Idle = Pool.Idle.Num();
+    UpdatePeak(Pool);
+}
+
+FA1H_ActorPoolStats UA1H_ActorPoolSubsystem::GetPoolStats(TSubclassOf<AActor> ActorClass) const
+{
+    const FPool* Pool = ActorClass ? Pools.Find(ActorClass.Get()) : nullptr;
+    return Pool ? Pool->Stats : FA1H_ActorPoolStats();
+}
+
+FA1H_ActorPoolStats UA1H_ActorPoolSubsystem::GetTotalStats() const
+{
+    FA1H_ActorPoolStats Total;
+    for (const TPair<TObjectKey<UClass>, FPool>& Pair : Pools)
+    {
+        const FA1H_ActorPoolStats& Stats = Pair.Value.Stats;
+        Total.Acquires += Stats.Acquires;
+        Total.Hits += Stats.Hits;
+        Total.Releases += Stats.Releases;
+        Total.Overflows += Stats.Overflows;
+        Total.Idle += Stats.Idle;
+        Total.InUse += Stats.InUse;
+        Total.PeakSize += Stats.PeakSize;
+    }
+    return Total;
+}
+
+void UA1H_ActorPoolSubsystem::LogReport() const
+{
+    const FA1H_ActorPoolStats Total = GetTotalStats();
+    UE_LOG(LogA1H, Log, TEXT("A1H actor pools: %d acquires, %.1f%% hit rate, %d idle, %d in use"),
+        Total.Acquires, Total.GetHitRate() * 100.0f, Total.Idle, Total.InUse);
+
+    for (const TPair<TObjectKey<UClass>, FPool>& Pair : Pools)
+    {
+        const UClass* ActorClass = Pair.Key.ResolveObjectPtr();
+        const FA1H_ActorPoolStats& Stats = Pair.Value.Stats;
+        UE_LOG(LogA1H, Log, TEXT("  %-40s acquires=%-6d hit=%5.1f%% releases=%-6d overflows=%-4d idle=%-4d in use=%-4d peak=%d"),
+            ActorClass ? *ActorClass->GetName() : TEXT("<unloaded>"), Stats.Acquires, Stats.GetHitRate() * 100.0f,
+            Stats.Releases, Stats.Overflows, Stats.Idle, Stats.InUse, Stats.PeakSize);
+    }
+}
+
+#pragma endregion
+
+#pragma region Parking
+void UA1H_ActorPoolSubsystem::Park(AActor* Actor)
+{
+    Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+    Actor->SetActorHiddenInGame(true);
+    Actor->SetActorEnableCollision(false);
+    Actor->SetActorTickEnabled(false);
+    Actor->ForEachComponent(false, [](UActorComponent* Component)
+    {
+        Component->SetComponentTickEnabled(false);
+
+        // Nothing should still be flying around once it comes back out
+        if (UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component); Primitive && Primitive->IsSimulatingPhysics())
+        {
+            Primitive->SetPhysicsLinearVelocity(FVector::ZeroVector);
+            Primitive->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+        }
+    });
+    GetWorld()->GetTimerManager().ClearAllTimersForObject(Actor);
+    Actor->SetOwner(nullptr);
+    Actor->SetInstigator(nullptr);
+}
+
+void UA1H_ActorPoolSubsystem::Activate(AActor* Actor, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+    Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+    Actor->SetOwner(Owner);
+    Actor->SetInstigator(Instigator);
+    Actor->ForEachComponent(false, [](UActorComponent* Component)
+    {
+        Component->SetComponentTickEnabled(Component->PrimaryComponentTick.bStartWithTickEnabled);
+    });
+    Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+    // Come back out the way a fresh spawn would, which isn't always visible and colliding (triggers, hidden helpers)
+    const AActor* Defaults = Actor->GetClass()->GetDefaultObject<AActor>();
+    Actor->SetActorEnableCollision(Defaults->GetActorEnableCollision());
+    Actor->SetActorHiddenInGame(Defaults->IsHidden());
+}
+
+AActor* UA1H_ActorPoolSubsystem::SpawnForPool(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.Owner = Owner;
+    SpawnParams.Instigator = Instigator;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+    if (Actor)
+    {
+        Actor->OnDestroyed.AddUniqueDynamic(this, &UA1H_ActorPoolSubsystem::HandlePooledActorDestroyed);
+    }
+    return Actor;
+}
+
+void UA1H_ActorPoolSubsystem::UpdatePeak(FPool& Pool)
+{
+    Pool.Stats.PeakSize = FMath::Max(Pool.Stats.PeakSize, Pool.Idle.Num() + Pool.Stats.InUse);
+}
+
+void UA1H_ActorPoolSubsystem::HandlePooledActorDestroyed(AActor* DestroyedActor)
+{
+    FPool* Pool = Pools.Find(DestroyedActor->GetClass());
+    if (!Pool)
+    {
+        return;
+    }
+
+    if (InUseActors.Remove(DestroyedActor) > 0)
+    {
+        --Pool->Stats.InUse;
+        DEC_DWORD_STAT(STAT_A1H_ActorPoolInUse);
+    }
+    else if (Pool->Idle.RemoveSingleSwap(DestroyedActor, EAllowShrinking::No) > 0)
+    {
+        Pool->Stats.Idle = Pool->Idle.Num();
+        DEC_DWORD_STAT(STAT_A1H_ActorPoolIdle);
+    }
+}
+
+#pragma endregion
+
+#pragma region Console
+#if !UE_BUILD_SHIPPING
+namespace A1HActorPool
+{
+    static FAutoConsoleCommandWithWorldAndArgs ReportCommand(
+        TEXT("A1H.ActorPool.Report"),
+        TEXT("Logs hit rate, idle/in-use counts and peak size of every actor pool."),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (const UA1H_ActorPoolSubsystem* Pool = World ? World->GetSubsystem<UA1H_ActorPoolSubsystem>() : nullptr)
+            {
+                Pool->LogReport();
+            }
+        }));
+}
+#endif
+
+#pragma endregion
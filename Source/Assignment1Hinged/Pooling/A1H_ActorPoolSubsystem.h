@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "A1H_ActorPoolSubsystem.generated.h"
+
+// A class to have ready in the pool as soon as the map starts
+USTRUCT()
+struct FA1H_ActorPoolPrewarm
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Pooling")
+	TSoftClassPtr<AActor> ActorClass;
+
+	UPROPERTY(EditAnywhere, Category = "Pooling", meta = (ClampMin = "0"))
+	int32 Count = 8;
+};
+
+// Counters for one pooled class (or all of them together)
+USTRUCT(BlueprintType)
+struct FA1H_ActorPoolStats
+{
+	GENERATED_BODY()
+
+	// Actors handed out
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 Acquires = 0;
+
+	// ...of which came out of the pool instead of being spawned
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 Hits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 Releases = 0;
+
+	// Released actors destroyed because the pool was already full
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 Overflows = 0;
+
+	// Waiting in the pool right now
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 Idle = 0;
+
+	// Handed out and not released yet
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 InUse = 0;
+
+	// Most actors (idle + in use) the pool has had at once
+	UPROPERTY(BlueprintReadOnly, Category = "Pooling")
+	int32 PeakSize = 0;
+
+	float GetHitRate() const { return Acquires > 0 ? static_cast<float>(Hits) / Acquires : 0.0f; }
+};
+
+/**
+ * World-level pool of actors that would otherwise be spawned and destroyed over and over
+ * (pickups, effects, replacement props spawned by interactions).
+ * AcquireActor hands out a parked actor of the class if there is one and spawns otherwise. ReleaseActor
+ * parks it again: hidden, no collision, no ticking, timers cleared. Actors can implement
+ * IA1H_PooledActorInterface to reset themselves. Classes listed in PrewarmPools (DefaultGame.ini) are
+ * spawned when the world begins play, so the first interactions don't pay for spawning either.
+ * A1H.ActorPool.Report logs the hit rate and peak size of every pool.
+ */
+UCLASS(Config = Game)
+class ASSIGNMENT1HINGED_API UA1H_ActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+#pragma region Subsystem Lifetime
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+#pragma endregion
+
+public:
+#pragma region Pooling
+	/**
+	 * Hands out an actor of ActorClass, reusing a parked one if there is one.
+	 * @param ActorClass   What to hand out.
+	 * @param Transform    Where to put it.
+	 * @param Owner        Owner to give it (optional).
+	 * @param Instigator   Instigator to give it (optional).
+	 * @return The actor, or nullptr if ActorClass is empty or it couldn't be spawned.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pooling", meta = (DeterminesOutputType = "ActorClass"))
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+
+	// Typed AcquireActor for C++
+	template<typename T>
+	T* Acquire(TSubclassOf<T> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr)
+	{
+		return Cast<T>(AcquireActor(ActorClass, Transform, Owner, Instigator));
+	}
+
+	// Parks Actor for reuse (or destroys it, if its pool is full). Actors that didn't come from the pool are adopted.
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void ReleaseActor(AActor* Actor);
+
+	// Spawns and parks actors until ActorClass has Count idle ones
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	UFUNCTION(BlueprintPure, Category = "Pooling")
+	FA1H_ActorPoolStats GetPoolStats(TSubclassOf<AActor> ActorClass) const;
+
+	// Every pool added together (PeakSize is the sum of the per-class peaks)
+	UFUNCTION(BlueprintPure, Category = "Pooling")
+	FA1H_ActorPoolStats GetTotalStats() const;
+
+	// Logs the stats of every pool
+	void LogReport() const;
+
+#pragma endregion
+
+#pragma region Pool Settings
+	// Spawned and parked when the world begins play
+	UPROPERTY(Config, EditAnywhere, Category = "Pooling")
+	TArray<FA1H_ActorPoolPrewarm> PrewarmPools;
+
+	// Idle actors kept per class. Anything released on top of that is destroyed.
+	UPROPERTY(Config, EditAnywhere, Category = "Pooling", meta = (ClampMin = "0"))
+	int32 MaxIdlePerClass = 64;
+
+#pragma endregion
+
+private:
+	struct FPool
+	{
+		TArray<TWeakObjectPtr<AActor>> Idle;
+		FA1H_ActorPoolStats Stats;
+	};
+
+	// Hides the actor and switches everything off
+	void Park(AActor* Actor);
+
+	// Undoes Park at a new location
+	void Activate(AActor* Actor, const FTransform& Transform, AActor* Owner, APawn* Instigator);
+
+	// Spawns a (not yet parked) actor for the pool
+	AActor* SpawnForPool(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator);
+
+	void UpdatePeak(FPool& Pool);
+
+	// Actors destroyed by someone else while pooled or handed out
+	UFUNCTION()
+	void HandlePooledActorDestroyed(AActor* DestroyedActor);
+
+	TMap<TObjectKey<UClass>, FPool> Pools;
+
+	// Everything currently handed out, so releases can be told apart from adoptions and double releases
+	TSet<TObjectKey<AActor>> InUseActors;
+};
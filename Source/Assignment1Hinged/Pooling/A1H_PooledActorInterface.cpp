@@ -0,0 +1,6 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "A1H_PooledActorInterface.h"
+
+// Add default functionality here for any IA1H_PooledActorInterface functions that are not pure virtual.
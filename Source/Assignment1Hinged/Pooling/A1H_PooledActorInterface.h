@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "A1H_PooledActorInterface.generated.h"
+
+// This class does not need to be modified.
+UINTERFACE(MinimalAPI, Blueprintable)
+class UA1H_PooledActorInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Optional reset hooks for actors recycled by UA1H_ActorPoolSubsystem.
+ * Pooled actors don't get BeginPlay/EndPlay again when they're reused, so anything that would normally
+ * happen there (restarting effects, resetting health, clearing state) goes here instead.
+ * The pool already hides the actor, turns off its collision and ticking and clears its timers.
+ */
+class ASSIGNMENT1HINGED_API IA1H_PooledActorInterface
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	* Called every time the actor is handed out, freshly spawned or reused, after it has been moved into place and shown.
+	*/
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pooling")
+	void OnAcquiredFromPool();
+
+	/**
+	* Called when the actor goes back into the pool, before it's hidden. Stop anything that would keep running.
+	*/
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pooling")
+	void OnReleasedToPool();
+};